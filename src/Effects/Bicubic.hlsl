@@ -39,6 +39,7 @@ SamplerState sam;
 //!STYLE PS
 //!IN INPUT
 //!OUT OUTPUT
+//!RADIUS 2
 
 float weight(float x) {
 	const float B = paramB;
@@ -0,0 +1,133 @@
+#include "pch.h"
+#include "BenchmarkRecorder.h"
+#include "Logger.h"
+#include "StrHelper.h"
+#include "CommonSharedConstants.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+void BenchmarkRecorder::Initialize(
+	std::string_view frameSource,
+	uint32_t inputWidth,
+	uint32_t inputHeight,
+	uint32_t outputWidth,
+	uint32_t outputHeight,
+	std::span<const std::pair<std::string, std::vector<std::string>>> effects,
+	uint32_t frameCount
+) noexcept {
+	_report.frameSource = frameSource;
+	_report.inputWidth = inputWidth;
+	_report.inputHeight = inputHeight;
+	_report.outputWidth = outputWidth;
+	_report.outputHeight = outputHeight;
+	_effects.assign(effects.begin(), effects.end());
+	_frameCount = frameCount;
+
+	_passCount = 0;
+	for (const auto& [_, passNames] : _effects) {
+		_passCount += (uint32_t)passNames.size();
+	}
+
+	_submitTimes.reserve(frameCount);
+	_frameIntervals.reserve(frameCount);
+	_passTimings.reserve(size_t(_passCount) * frameCount);
+
+	Logger::Get().Info(fmt::format("开始性能测试，预热 {} 帧后记录 {} 帧", WARMUP_FRAMES, frameCount));
+}
+
+void BenchmarkRecorder::OnFrameRendered(steady_clock::duration submitTime) noexcept {
+	if (!IsRunning()) {
+		return;
+	}
+
+	const steady_clock::time_point now = steady_clock::now();
+
+	++_renderedFrames;
+	if (_renderedFrames > WARMUP_FRAMES && _submitTimes.size() < _frameCount) {
+		_submitTimes.push_back(duration<float, std::milli>(submitTime).count());
+		_frameIntervals.push_back(duration<float, std::milli>(now - _lastRenderTime).count());
+	}
+
+	_lastRenderTime = now;
+}
+
+bool BenchmarkRecorder::OnGpuTimings(std::span<const float> passTimings) noexcept {
+	if (!IsRunning() || passTimings.size() != _passCount) {
+		return false;
+	}
+
+	++_gpuFrames;
+	if (_gpuFrames <= WARMUP_FRAMES) {
+		return false;
+	}
+
+	_passTimings.insert(_passTimings.end(), passTimings.begin(), passTimings.end());
+
+	// GPU 用时要在数帧后才能取回，因此以它为准判断是否完成
+	if (_gpuFrames - WARMUP_FRAMES == _frameCount) {
+		_isComplete = true;
+	}
+	return _isComplete;
+}
+
+bool BenchmarkRecorder::WriteReport() noexcept {
+	_report.frameCount = _gpuFrames > WARMUP_FRAMES ? _gpuFrames - WARMUP_FRAMES : 0;
+	_report.cpuSubmitTime = BenchmarkStatistics::Compute(_submitTimes);
+	_report.frameInterval = BenchmarkStatistics::Compute(_frameIntervals);
+
+	std::vector<float> totalTimes(_report.frameCount);
+	std::vector<float> effectTimes(_report.frameCount);
+	std::vector<float> passTimes(_report.frameCount);
+
+	_report.effects.clear();
+	size_t passIdx = 0;
+	for (const auto& [name, passNames] : _effects) {
+		BenchmarkEffectResult& effect = _report.effects.emplace_back();
+		effect.name = name;
+
+		std::fill(effectTimes.begin(), effectTimes.end(), 0.0f);
+		for (const std::string& passName : passNames) {
+			for (uint32_t i = 0; i < _report.frameCount; ++i) {
+				passTimes[i] = _passTimings[size_t(i) * _passCount + passIdx];
+				effectTimes[i] += passTimes[i];
+			}
+			++passIdx;
+
+			effect.passes.push_back({ passName, BenchmarkStatistics::Compute(passTimes) });
+		}
+
+		for (uint32_t i = 0; i < _report.frameCount; ++i) {
+			totalTimes[i] += effectTimes[i];
+		}
+		effect.gpuTime = BenchmarkStatistics::Compute(effectTimes);
+	}
+
+	_report.gpuTime = BenchmarkStatistics::Compute(totalTimes);
+
+	try {
+		const std::string json = _report.ToJson();
+
+		wil::unique_file file;
+		if (_wfopen_s(file.put(), CommonSharedConstants::BENCHMARK_REPORT_PATH, L"wb") || !file) {
+			Logger::Get().Error(StrHelper::Concat("打开文件 ",
+				StrHelper::UTF16ToUTF8(CommonSharedConstants::BENCHMARK_REPORT_PATH), " 失败"));
+			return false;
+		}
+
+		if (fwrite(json.data(), 1, json.size(), file.get()) != json.size()) {
+			Logger::Get().Error("写入性能测试报告失败");
+			return false;
+		}
+	} catch (const std::bad_alloc&) {
+		Logger::Get().Error("内存不足");
+		return false;
+	}
+
+	Logger::Get().Info(fmt::format("性能测试完成，GPU 平均用时 {:.3f} ms，报告已写入 {}",
+		_report.gpuTime.mean, StrHelper::UTF16ToUTF8(CommonSharedConstants::BENCHMARK_REPORT_PATH)));
+	return true;
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "BenchmarkReport.h"
+
+namespace Magpie {
+
+// 测试模式下收集固定帧数的 GPU 和 CPU 用时，完成后生成 BenchmarkReport。只能由后端线程调用。
+class BenchmarkRecorder {
+public:
+	BenchmarkRecorder() = default;
+	BenchmarkRecorder(const BenchmarkRecorder&) = delete;
+	BenchmarkRecorder(BenchmarkRecorder&&) = delete;
+
+	// effects 为每个效果的名字和通道名
+	void Initialize(
+		std::string_view frameSource,
+		uint32_t inputWidth,
+		uint32_t inputHeight,
+		uint32_t outputWidth,
+		uint32_t outputHeight,
+		std::span<const std::pair<std::string, std::vector<std::string>>> effects,
+		uint32_t frameCount
+	) noexcept;
+
+	bool IsRunning() const noexcept {
+		return _frameCount != 0 && !_isComplete;
+	}
+
+	// 每渲染一帧调用一次，submitTime 为提交渲染命令的 CPU 用时
+	void OnFrameRendered(std::chrono::steady_clock::duration submitTime) noexcept;
+
+	// 由 EffectsProfiler 的回调调用。收集到足够的帧时返回 true，只返回一次，之后的调用被忽略
+	bool OnGpuTimings(std::span<const float> passTimings) noexcept;
+
+	// 将报告写入 CommonSharedConstants::BENCHMARK_REPORT_PATH
+	bool WriteReport() noexcept;
+
+private:
+	// 跳过开始的若干帧，此时驱动可能仍在编译着色器或调整频率
+	static constexpr uint32_t WARMUP_FRAMES = 30;
+
+	BenchmarkReport _report;
+	std::vector<std::pair<std::string, std::vector<std::string>>> _effects;
+	uint32_t _frameCount = 0;
+	uint32_t _passCount = 0;
+
+	uint32_t _renderedFrames = 0;
+	std::chrono::steady_clock::time_point _lastRenderTime;
+	std::vector<float> _submitTimes;
+	std::vector<float> _frameIntervals;
+
+	uint32_t _gpuFrames = 0;
+	// 每个通道的 GPU 用时，按帧依次排列
+	std::vector<float> _passTimings;
+	bool _isComplete = false;
+};
+
+}
@@ -0,0 +1,563 @@
+// 不使用预编译头，只能使用标准库
+#include "BenchmarkReport.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace Magpie {
+
+// 最近秩法，values 必须已排序
+static double Percentile(std::span<const float> values, double p) noexcept {
+	const size_t rank = (size_t)std::max(1.0, std::ceil(p * values.size()));
+	return values[std::min(rank, values.size()) - 1];
+}
+
+BenchmarkStatistics BenchmarkStatistics::Compute(std::span<float> samples) {
+	BenchmarkStatistics result;
+	if (samples.empty()) {
+		return result;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0.0;
+	for (float sample : samples) {
+		sum += sample;
+	}
+	result.mean = sum / samples.size();
+
+	double variance = 0.0;
+	for (float sample : samples) {
+		variance += (sample - result.mean) * (sample - result.mean);
+	}
+	result.stddev = std::sqrt(variance / samples.size());
+
+	result.min = samples.front();
+	result.p50 = Percentile(samples, 0.50);
+	result.p95 = Percentile(samples, 0.95);
+	result.p99 = Percentile(samples, 0.99);
+	result.max = samples.back();
+	result.count = (uint32_t)samples.size();
+	return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 写入 JSON
+
+static void AppendIndent(std::string& out, uint32_t indent) {
+	out.append(size_t(indent) * 2, ' ');
+}
+
+static void AppendString(std::string& out, std::string_view str) {
+	out.push_back('"');
+	for (char c : str) {
+		switch (c) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if ((unsigned char)c < 0x20) {
+				static constexpr char HEX[] = "0123456789abcdef";
+				out += "\\u00";
+				out.push_back(HEX[(unsigned char)c >> 4]);
+				out.push_back(HEX[c & 0xF]);
+			} else {
+				out.push_back(c);
+			}
+			break;
+		}
+	}
+	out.push_back('"');
+}
+
+static void AppendNumber(std::string& out, double value) {
+	// 固定精度使报告便于比较，to_chars 不受区域设置影响
+	char buf[64];
+	const auto [end, ec] = std::to_chars(buf, std::end(buf), value, std::chars_format::fixed, 4);
+	out.append(buf, ec == std::errc{} ? end : buf);
+}
+
+static void AppendNumber(std::string& out, uint32_t value) {
+	out += std::to_string(value);
+}
+
+static void AppendKey(std::string& out, uint32_t indent, std::string_view key) {
+	AppendIndent(out, indent);
+	AppendString(out, key);
+	out += ": ";
+}
+
+static void AppendStatistics(std::string& out, uint32_t indent, const BenchmarkStatistics& stats) {
+	out += "{\n";
+	const std::pair<const char*, double> fields[] = {
+		{ "mean", stats.mean },
+		{ "stddev", stats.stddev },
+		{ "min", stats.min },
+		{ "p50", stats.p50 },
+		{ "p95", stats.p95 },
+		{ "p99", stats.p99 },
+		{ "max", stats.max }
+	};
+	for (const auto& [key, value] : fields) {
+		AppendKey(out, indent + 1, key);
+		AppendNumber(out, value);
+		out += ",\n";
+	}
+	AppendKey(out, indent + 1, "count");
+	AppendNumber(out, stats.count);
+	out.push_back('\n');
+	AppendIndent(out, indent);
+	out.push_back('}');
+}
+
+std::string BenchmarkReport::ToJson() const {
+	std::string out = "{\n";
+
+	AppendKey(out, 1, "version");
+	AppendNumber(out, VERSION);
+	out += ",\n";
+	AppendKey(out, 1, "frameSource");
+	AppendString(out, frameSource);
+	out += ",\n";
+
+	const std::pair<const char*, uint32_t> sizes[] = {
+		{ "inputWidth", inputWidth },
+		{ "inputHeight", inputHeight },
+		{ "outputWidth", outputWidth },
+		{ "outputHeight", outputHeight },
+		{ "frameCount", frameCount }
+	};
+	for (const auto& [key, value] : sizes) {
+		AppendKey(out, 1, key);
+		AppendNumber(out, value);
+		out += ",\n";
+	}
+
+	AppendKey(out, 1, "gpuTime");
+	AppendStatistics(out, 1, gpuTime);
+	out += ",\n";
+	AppendKey(out, 1, "cpuSubmitTime");
+	AppendStatistics(out, 1, cpuSubmitTime);
+	out += ",\n";
+	AppendKey(out, 1, "frameInterval");
+	AppendStatistics(out, 1, frameInterval);
+	out += ",\n";
+
+	AppendKey(out, 1, "effects");
+	out += "[";
+	for (size_t i = 0; i < effects.size(); ++i) {
+		const BenchmarkEffectResult& effect = effects[i];
+
+		out += i == 0 ? "\n" : ",\n";
+		AppendIndent(out, 2);
+		out += "{\n";
+		AppendKey(out, 3, "name");
+		AppendString(out, effect.name);
+		out += ",\n";
+		AppendKey(out, 3, "gpuTime");
+		AppendStatistics(out, 3, effect.gpuTime);
+		out += ",\n";
+
+		AppendKey(out, 3, "passes");
+		out += "[";
+		for (size_t j = 0; j < effect.passes.size(); ++j) {
+			out += j == 0 ? "\n" : ",\n";
+			AppendIndent(out, 4);
+			out += "{\n";
+			AppendKey(out, 5, "name");
+			AppendString(out, effect.passes[j].name);
+			out += ",\n";
+			AppendKey(out, 5, "gpuTime");
+			AppendStatistics(out, 5, effect.passes[j].gpuTime);
+			out.push_back('\n');
+			AppendIndent(out, 4);
+			out.push_back('}');
+		}
+		if (!effect.passes.empty()) {
+			out.push_back('\n');
+			AppendIndent(out, 3);
+		}
+		out += "]\n";
+
+		AppendIndent(out, 2);
+		out.push_back('}');
+	}
+	if (!effects.empty()) {
+		out += "\n  ";
+	}
+	out += "]\n}\n";
+
+	return out;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 解析 JSON
+// 只需读取 ToJson 的输出，但仍支持完整的 JSON 语法，以免手动编辑过的报告无法读取
+
+namespace {
+
+struct JsonValue {
+	enum class Type {
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	const JsonValue* Find(std::string_view key) const {
+		if (type != Type::Object) {
+			return nullptr;
+		}
+
+		for (const auto& [name, value] : object) {
+			if (name == key) {
+				return &value;
+			}
+		}
+		return nullptr;
+	}
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> array;
+	// 对象很小，无需使用关联容器
+	std::vector<std::pair<std::string, JsonValue>> object;
+};
+
+class JsonParser {
+public:
+	explicit JsonParser(std::string_view json) : _json(json) {}
+
+	bool Parse(JsonValue& value) {
+		if (!_ParseValue(value, 0)) {
+			return false;
+		}
+
+		_SkipWhitespace();
+		return _pos == _json.size();
+	}
+
+private:
+	// 防止恶意输入导致栈溢出
+	static constexpr uint32_t MAX_DEPTH = 64;
+
+	void _SkipWhitespace() {
+		while (_pos < _json.size() &&
+			(_json[_pos] == ' ' || _json[_pos] == '\t' || _json[_pos] == '\n' || _json[_pos] == '\r')) {
+			++_pos;
+		}
+	}
+
+	bool _Consume(char c) {
+		_SkipWhitespace();
+		if (_pos < _json.size() && _json[_pos] == c) {
+			++_pos;
+			return true;
+		}
+		return false;
+	}
+
+	bool _ConsumeLiteral(std::string_view literal) {
+		if (_json.substr(_pos, literal.size()) != literal) {
+			return false;
+		}
+		_pos += literal.size();
+		return true;
+	}
+
+	bool _ParseValue(JsonValue& value, uint32_t depth) {
+		if (depth > MAX_DEPTH) {
+			return false;
+		}
+
+		_SkipWhitespace();
+		if (_pos >= _json.size()) {
+			return false;
+		}
+
+		switch (_json[_pos]) {
+		case '{':
+			value.type = JsonValue::Type::Object;
+			return _ParseObject(value, depth);
+		case '[':
+			value.type = JsonValue::Type::Array;
+			return _ParseArray(value, depth);
+		case '"':
+			value.type = JsonValue::Type::String;
+			return _ParseString(value.string);
+		case 't':
+			value.type = JsonValue::Type::Bool;
+			value.boolean = true;
+			return _ConsumeLiteral("true");
+		case 'f':
+			value.type = JsonValue::Type::Bool;
+			value.boolean = false;
+			return _ConsumeLiteral("false");
+		case 'n':
+			value.type = JsonValue::Type::Null;
+			return _ConsumeLiteral("null");
+		default:
+			value.type = JsonValue::Type::Number;
+			return _ParseNumber(value.number);
+		}
+	}
+
+	bool _ParseObject(JsonValue& value, uint32_t depth) {
+		++_pos;
+		if (_Consume('}')) {
+			return true;
+		}
+
+		do {
+			_SkipWhitespace();
+			std::string key;
+			if (!_ParseString(key) || !_Consume(':')) {
+				return false;
+			}
+
+			if (!_ParseValue(value.object.emplace_back(std::move(key), JsonValue{}).second, depth + 1)) {
+				return false;
+			}
+		} while (_Consume(','));
+
+		return _Consume('}');
+	}
+
+	bool _ParseArray(JsonValue& value, uint32_t depth) {
+		++_pos;
+		if (_Consume(']')) {
+			return true;
+		}
+
+		do {
+			if (!_ParseValue(value.array.emplace_back(), depth + 1)) {
+				return false;
+			}
+		} while (_Consume(','));
+
+		return _Consume(']');
+	}
+
+	bool _ParseString(std::string& str) {
+		if (_pos >= _json.size() || _json[_pos] != '"') {
+			return false;
+		}
+		++_pos;
+
+		while (_pos < _json.size()) {
+			const char c = _json[_pos++];
+			if (c == '"') {
+				return true;
+			}
+
+			if (c != '\\') {
+				str.push_back(c);
+				continue;
+			}
+
+			if (_pos >= _json.size()) {
+				return false;
+			}
+
+			switch (_json[_pos++]) {
+			case '"': str.push_back('"'); break;
+			case '\\': str.push_back('\\'); break;
+			case '/': str.push_back('/'); break;
+			case 'b': str.push_back('\b'); break;
+			case 'f': str.push_back('\f'); break;
+			case 'n': str.push_back('\n'); break;
+			case 'r': str.push_back('\r'); break;
+			case 't': str.push_back('\t'); break;
+			case 'u':
+			{
+				uint32_t codePoint;
+				if (!_ParseHex4(codePoint)) {
+					return false;
+				}
+
+				// 代理对
+				if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+					uint32_t low;
+					if (!_ConsumeLiteral("\\u") || !_ParseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+						return false;
+					}
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+				}
+
+				_AppendUtf8(str, codePoint);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	bool _ParseHex4(uint32_t& value) {
+		if (_pos + 4 > _json.size()) {
+			return false;
+		}
+
+		const char* begin = _json.data() + _pos;
+		const auto [end, ec] = std::from_chars(begin, begin + 4, value, 16);
+		if (ec != std::errc{} || end != begin + 4) {
+			return false;
+		}
+
+		_pos += 4;
+		return true;
+	}
+
+	static void _AppendUtf8(std::string& str, uint32_t codePoint) {
+		if (codePoint < 0x80) {
+			str.push_back((char)codePoint);
+		} else if (codePoint < 0x800) {
+			str.push_back(char(0xC0 | (codePoint >> 6)));
+			str.push_back(char(0x80 | (codePoint & 0x3F)));
+		} else if (codePoint < 0x10000) {
+			str.push_back(char(0xE0 | (codePoint >> 12)));
+			str.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+			str.push_back(char(0x80 | (codePoint & 0x3F)));
+		} else {
+			str.push_back(char(0xF0 | (codePoint >> 18)));
+			str.push_back(char(0x80 | ((codePoint >> 12) & 0x3F)));
+			str.push_back(char(0x80 | ((codePoint >> 6) & 0x3F)));
+			str.push_back(char(0x80 | (codePoint & 0x3F)));
+		}
+	}
+
+	bool _ParseNumber(double& number) {
+		const char* begin = _json.data() + _pos;
+		const char* end = _json.data() + _json.size();
+		const auto [ptr, ec] = std::from_chars(begin, end, number);
+		if (ec != std::errc{}) {
+			return false;
+		}
+
+		_pos += ptr - begin;
+		return true;
+	}
+
+	std::string_view _json;
+	size_t _pos = 0;
+};
+
+}
+
+static bool ReadString(const JsonValue& obj, std::string_view key, std::string& result) {
+	const JsonValue* value = obj.Find(key);
+	if (!value || value->type != JsonValue::Type::String) {
+		return false;
+	}
+
+	result = value->string;
+	return true;
+}
+
+static bool ReadUInt(const JsonValue& obj, std::string_view key, uint32_t& result) {
+	const JsonValue* value = obj.Find(key);
+	if (!value || value->type != JsonValue::Type::Number || value->number < 0 || value->number > UINT32_MAX) {
+		return false;
+	}
+
+	result = (uint32_t)value->number;
+	return true;
+}
+
+static bool ReadStatistics(const JsonValue& obj, std::string_view key, BenchmarkStatistics& result) {
+	const JsonValue* stats = obj.Find(key);
+	if (!stats || stats->type != JsonValue::Type::Object) {
+		return false;
+	}
+
+	const std::pair<const char*, double*> fields[] = {
+		{ "mean", &result.mean },
+		{ "stddev", &result.stddev },
+		{ "min", &result.min },
+		{ "p50", &result.p50 },
+		{ "p95", &result.p95 },
+		{ "p99", &result.p99 },
+		{ "max", &result.max }
+	};
+	for (const auto& [name, field] : fields) {
+		const JsonValue* value = stats->Find(name);
+		if (!value || value->type != JsonValue::Type::Number) {
+			return false;
+		}
+		*field = value->number;
+	}
+
+	return ReadUInt(*stats, "count", result.count);
+}
+
+bool BenchmarkReport::FromJson(std::string_view json) {
+	JsonValue root;
+	if (!JsonParser(json).Parse(root) || root.type != JsonValue::Type::Object) {
+		return false;
+	}
+
+	uint32_t version = 0;
+	if (!ReadUInt(root, "version", version) || version != VERSION) {
+		return false;
+	}
+
+	if (!ReadString(root, "frameSource", frameSource) ||
+		!ReadUInt(root, "inputWidth", inputWidth) ||
+		!ReadUInt(root, "inputHeight", inputHeight) ||
+		!ReadUInt(root, "outputWidth", outputWidth) ||
+		!ReadUInt(root, "outputHeight", outputHeight) ||
+		!ReadUInt(root, "frameCount", frameCount) ||
+		!ReadStatistics(root, "gpuTime", gpuTime) ||
+		!ReadStatistics(root, "cpuSubmitTime", cpuSubmitTime) ||
+		!ReadStatistics(root, "frameInterval", frameInterval)
+	) {
+		return false;
+	}
+
+	const JsonValue* effectsNode = root.Find("effects");
+	if (!effectsNode || effectsNode->type != JsonValue::Type::Array) {
+		return false;
+	}
+
+	effects.clear();
+	for (const JsonValue& effectNode : effectsNode->array) {
+		BenchmarkEffectResult& effect = effects.emplace_back();
+		if (!ReadString(effectNode, "name", effect.name) || !ReadStatistics(effectNode, "gpuTime", effect.gpuTime)) {
+			return false;
+		}
+
+		const JsonValue* passesNode = effectNode.Find("passes");
+		if (!passesNode || passesNode->type != JsonValue::Type::Array) {
+			return false;
+		}
+
+		for (const JsonValue& passNode : passesNode->array) {
+			BenchmarkPassResult& pass = effect.passes.emplace_back();
+			if (!ReadString(passNode, "name", pass.name) || !ReadStatistics(passNode, "gpuTime", pass.gpuTime)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+}
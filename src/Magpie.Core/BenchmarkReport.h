@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Magpie {
+
+// 单位为毫秒
+struct BenchmarkStatistics {
+	double mean = 0.0;
+	double stddev = 0.0;
+	double min = 0.0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	uint32_t count = 0;
+
+	// 精确计算，不同于 TimingStatistics 的估计。会对 samples 排序
+	static BenchmarkStatistics Compute(std::span<float> samples);
+};
+
+struct BenchmarkPassResult {
+	std::string name;
+	BenchmarkStatistics gpuTime;
+};
+
+struct BenchmarkEffectResult {
+	std::string name;
+	BenchmarkStatistics gpuTime;
+	std::vector<BenchmarkPassResult> passes;
+};
+
+// 测试模式下运行固定帧数后生成的报告，以 JSON 保存，字段顺序固定以便在提交之间比较。
+// BenchmarkCompare 工具读取两份报告并比较各项用时。
+// 注意此头文件和 BenchmarkReport.cpp 只能使用标准库。
+struct BenchmarkReport {
+	static constexpr uint32_t VERSION = 1;
+
+	// 捕获方式，回放帧录像时为 File，使用生成的图案时为 Synthetic
+	std::string frameSource;
+	uint32_t inputWidth = 0;
+	uint32_t inputHeight = 0;
+	uint32_t outputWidth = 0;
+	uint32_t outputHeight = 0;
+	// 有 GPU 用时的帧数
+	uint32_t frameCount = 0;
+
+	// 所有效果的 GPU 用时之和
+	BenchmarkStatistics gpuTime;
+	// 后端提交一帧的渲染命令的 CPU 用时，不包括等待 GPU
+	BenchmarkStatistics cpuSubmitTime;
+	// 相邻两次渲染的间隔
+	BenchmarkStatistics frameInterval;
+
+	std::vector<BenchmarkEffectResult> effects;
+
+	std::string ToJson() const;
+
+	// 解析失败或版本不同时返回 false
+	bool FromJson(std::string_view json);
+};
+
+}
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "CadenceDetector.h"
+#include "Logger.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+// 学习此数量的帧间隔后判断是否锁定
+static constexpr size_t LEARN_INTERVAL_COUNT = 12;
+// 锁定此时间后重新学习
+static constexpr nanoseconds RELEARN_INTERVAL = 2s;
+
+void CadenceDetector::OnFrameChecked(steady_clock::time_point captureTime, std::optional<bool> isDuplicate) noexcept {
+	if (_lastCaptureTime != steady_clock::time_point{}) {
+		_minCaptureInterval = std::min(_minCaptureInterval, nanoseconds(captureTime - _lastCaptureTime));
+	}
+	_lastCaptureTime = captureTime;
+
+	if (!isDuplicate.has_value()) {
+		if (_isLocked) {
+			// 锁定时捕获到的帧大多不重复，跳过检查的帧视为新帧
+			_lastUniqueTime = captureTime;
+		} else {
+			// 无法确定这一帧是否重复，重新开始计算间隔
+			_lastUniqueTime = {};
+		}
+		return;
+	}
+
+	if (*isDuplicate) {
+		// 锁定时也可能捕获到重复帧，比如 3:2 下拉的内容，此时保持原有节奏继续捕获即可
+		return;
+	}
+
+	if (_isLocked) {
+		_lastUniqueTime = captureTime;
+
+		if (captureTime - _lockTime >= RELEARN_INTERVAL) {
+			_Unlock();
+		}
+		return;
+	}
+
+	if (_lastUniqueTime != steady_clock::time_point{}) {
+		_uniqueIntervals.push_back(captureTime - _lastUniqueTime);
+	}
+	_lastUniqueTime = captureTime;
+
+	if (_uniqueIntervals.size() >= LEARN_INTERVAL_COUNT) {
+		_Lock(captureTime);
+	}
+}
+
+void CadenceDetector::_Lock(steady_clock::time_point captureTime) noexcept {
+	const auto [minIt, maxIt] = std::minmax_element(_uniqueIntervals.begin(), _uniqueIntervals.end());
+	const nanoseconds minInterval = *minIt;
+	const nanoseconds maxInterval = *maxIt;
+
+	_uniqueIntervals.clear();
+	const nanoseconds captureInterval = _minCaptureInterval;
+	_minCaptureInterval = nanoseconds::max();
+
+	// 帧间隔不稳定或内容帧率接近捕获帧率则无法跳过任何帧
+	if (maxInterval > 2 * minInterval || 2 * minInterval < 3 * captureInterval) {
+		return;
+	}
+
+	// 使用最小间隔以免推迟不重复的帧，3:2 下拉的内容在较长的间隔中会多检查一次
+	_isLocked = true;
+	_contentInterval = minInterval;
+	_captureInterval = captureInterval;
+	_lockTime = captureTime;
+
+	// 和上次相差不超过 5% 不输出日志
+	if (abs(_contentInterval - _loggedInterval) * 20 > _loggedInterval) {
+		_loggedInterval = _contentInterval;
+		Logger::Get().Info(fmt::format("已锁定内容帧率: {:.2f} FPS",
+			1.0 / duration_cast<duration<double>>(_contentInterval).count()));
+	}
+}
+
+void CadenceDetector::_Unlock() noexcept {
+	// 从当前帧开始重新学习
+	_isLocked = false;
+	_minCaptureInterval = nanoseconds::max();
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "SmallVector.h"
+
+namespace Magpie {
+
+// 检测源内容的帧率。很多游戏在高刷新率的桌面中以 30 或 24 FPS 渲染，捕获到的帧中有规律地出现重复帧，
+// 学习到内容的帧间隔后便可以推迟下一次捕获，跳过必然重复的帧，节省捕获和执行效果的开销。
+// 锁定后无法察觉内容帧率变高，因此每隔一段时间重新学习。
+class CadenceDetector {
+public:
+	CadenceDetector() = default;
+	CadenceDetector(const CadenceDetector&) = delete;
+	CadenceDetector(CadenceDetector&&) = delete;
+
+	// 每次检查重复帧后调用。isDuplicate 为空表示动态检测跳过了检查
+	void OnFrameChecked(std::chrono::steady_clock::time_point captureTime, std::optional<bool> isDuplicate) noexcept;
+
+	bool IsLocked() const noexcept {
+		return _isLocked;
+	}
+
+	// 锁定时下一次捕获不应早于此时间
+	std::chrono::steady_clock::time_point NextFrameTime() const noexcept {
+		// 提前四分之一个捕获间隔以容许抖动
+		return _lastUniqueTime + _contentInterval - _captureInterval / 4;
+	}
+
+private:
+	void _Lock(std::chrono::steady_clock::time_point captureTime) noexcept;
+
+	void _Unlock() noexcept;
+
+	// 学习阶段相邻两个不重复帧的间隔
+	SmallVector<std::chrono::nanoseconds, 16> _uniqueIntervals;
+	std::chrono::nanoseconds _minCaptureInterval = std::chrono::nanoseconds::max();
+	std::chrono::steady_clock::time_point _lastCaptureTime;
+	std::chrono::steady_clock::time_point _lastUniqueTime;
+
+	bool _isLocked = false;
+	std::chrono::nanoseconds _contentInterval{};
+	std::chrono::nanoseconds _captureInterval{};
+	std::chrono::steady_clock::time_point _lockTime;
+	// 上次输出日志时锁定的帧间隔，避免每次重新学习都输出日志
+	std::chrono::nanoseconds _loggedInterval{};
+};
+
+}
@@ -0,0 +1,308 @@
+#include "pch.h"
+#include "CaptureThread.h"
+#include "DeviceResources.h"
+#include "DirectXHelper.h"
+#include "Logger.h"
+#include <dispatcherqueue.h>
+
+namespace Magpie {
+
+CaptureThread::~CaptureThread() noexcept {
+	if (!_thread.joinable()) {
+		return;
+	}
+
+	const HANDLE hThread = _thread.native_handle();
+	if (!wil::handle_wait(hThread, 0)) {
+		const DWORD threadId = GetThreadId(hThread);
+
+		// 持续尝试直到捕获线程创建了消息队列
+		while (!PostThreadMessage(threadId, WM_QUIT, 0, 0)) {
+			if (wil::handle_wait(hThread, 1)) {
+				break;
+			}
+		}
+	}
+
+	_thread.join();
+
+	const CaptureThreadStatistics& stats = _statistics;
+	Logger::Get().Info(fmt::format(
+		"捕获线程统计: 捕获 {} 帧，取出 {} 帧，丢弃 {} 帧，平均队列深度 {:.2f}，最大队列深度 {}",
+		stats.producedFrames, stats.consumedFrames, stats.droppedFrames,
+		stats.consumedFrames == 0 ? 0.0 : (double)stats.totalQueueDepth / stats.consumedFrames,
+		stats.maxQueueDepth));
+}
+
+bool CaptureThread::Initialize(
+	std::unique_ptr<FrameSourceBase> frameSource,
+	DeviceResources& deviceResources,
+	std::optional<float> maxCaptureRate
+) noexcept {
+	_frameSource = std::move(frameSource);
+	_deviceResources = &deviceResources;
+	_maxCaptureRate = maxCaptureRate;
+	_backendThreadId = GetCurrentThreadId();
+
+	// 两个线程都会使用设备上下文
+	if (!deviceResources.EnableMultithreadProtection()) {
+		Logger::Get().Error("EnableMultithreadProtection 失败");
+		return false;
+	}
+
+	_thread = std::thread(std::bind(&CaptureThread::_ThreadProc, this));
+
+	_initState.wait(0, std::memory_order_acquire);
+	if (_initState.load(std::memory_order_relaxed) != 1) {
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC desc;
+	_frameSource->GetOutput()->GetDesc(&desc);
+
+	_output = DirectXHelper::CreateTexture2D(
+		deviceResources.GetD3DDevice(),
+		desc.Format,
+		desc.Width,
+		desc.Height,
+		D3D11_BIND_SHADER_RESOURCE
+	);
+	if (!_output) {
+		Logger::Get().Error("CreateTexture2D 失败");
+		return false;
+	}
+
+	return true;
+}
+
+FrameSourceState CaptureThread::Update() noexcept {
+	// 和 FrameSourceBase::Update 一致，没有新帧时强制帧应完整渲染
+	_lastDuplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
+	_dirtyRegion.isWhole = true;
+	_dirtyRegion.rects.clear();
+
+	auto lock = _queueLock.lock_exclusive();
+
+	if (_isError) {
+		return FrameSourceState::Error;
+	}
+
+	if (_queue.empty()) {
+		return FrameSourceState::Waiting;
+	}
+
+	const uint32_t queueDepth = (uint32_t)_queue.size();
+	++_statistics.consumedFrames;
+	_statistics.droppedFrames += queueDepth - 1;
+	_statistics.totalQueueDepth += queueDepth;
+	_statistics.maxQueueDepth = std::max(_statistics.maxQueueDepth, queueDepth);
+
+	const _Slot& slot = _slots[_queue.back()];
+	_queue.clear();
+
+	_captureTime = slot.captureTime;
+	_lastDuplicateCheckResult = slot.duplicateCheckResult;
+	std::swap(_dirtyRegion, _pendingDirtyRegion);
+	_pendingDirtyRegion.isWhole = false;
+	_pendingDirtyRegion.rects.clear();
+
+	// 在锁内提交复制，之后捕获线程才能覆盖这个槽
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+	if (_dirtyRegion.isWhole) {
+		d3dDC->CopyResource(_output.get(), slot.texture.get());
+	} else {
+		for (const DirtyRect& rect : _dirtyRegion.rects) {
+			const D3D11_BOX box{ rect.left, rect.top, 0, rect.right, rect.bottom, 1 };
+			d3dDC->CopySubresourceRegion(
+				_output.get(), 0, rect.left, rect.top, 0, slot.texture.get(), 0, &box);
+		}
+	}
+
+	return FrameSourceState::NewFrame;
+}
+
+void CaptureThread::GetDirtyRegion(DirtyRegion& region) const {
+	region = _dirtyRegion;
+}
+
+CaptureThreadStatistics CaptureThread::Statistics() noexcept {
+	auto lock = _queueLock.lock_exclusive();
+	return _statistics;
+}
+
+void CaptureThread::OnCursorVisibilityChanged(bool isVisible, bool onDestory) noexcept {
+	_dispatcher.TryEnqueue([this, isVisible, onDestory]() {
+		_frameSource->OnCursorVisibilityChanged(isVisible, onDestory);
+	});
+}
+
+void CaptureThread::_ThreadProc() noexcept {
+#ifdef _DEBUG
+	SetThreadDescription(GetCurrentThread(), L"Magpie 捕获线程");
+#endif
+
+	winrt::init_apartment(winrt::apartment_type::single_threaded);
+
+	const bool success = _InitializeOnThread();
+	_initState.store(success ? 1 : 2, std::memory_order_release);
+	_initState.notify_one();
+
+	if (success) {
+		_CaptureLoop();
+	} else {
+		// 即使失败也要创建消息循环，否则析构时无法通知退出
+		MSG msg;
+		while (GetMessage(&msg, NULL, 0, 0)) {
+			DispatchMessage(&msg);
+		}
+	}
+
+	// 不能在其他线程释放
+	_frameSource.reset();
+}
+
+bool CaptureThread::_InitializeOnThread() noexcept {
+	// Graphics Capture 在当前线程的 DispatcherQueue 上通知新帧
+	{
+		winrt::Windows::System::DispatcherQueueController dqc{ nullptr };
+		HRESULT hr = CreateDispatcherQueueController(
+			DispatcherQueueOptions{
+				.dwSize = sizeof(DispatcherQueueOptions),
+				.threadType = DQTYPE_THREAD_CURRENT
+			},
+			(PDISPATCHERQUEUECONTROLLER*)winrt::put_abi(dqc)
+		);
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateDispatcherQueueController 失败", hr);
+			return false;
+		}
+
+		_dispatcher = dqc.DispatcherQueue();
+	}
+
+	_descriptorStore.Initialize(_deviceResources->GetD3DDevice());
+
+	if (!_frameSource->Initialize(*_deviceResources, _descriptorStore)) {
+		Logger::Get().Error("初始化 FrameSource 失败");
+		return false;
+	}
+
+	D3D11_TEXTURE2D_DESC desc;
+	_frameSource->GetOutput()->GetDesc(&desc);
+
+	for (_Slot& slot : _slots) {
+		slot.texture = DirectXHelper::CreateTexture2D(
+			_deviceResources->GetD3DDevice(), desc.Format, desc.Width, desc.Height, 0);
+		if (!slot.texture) {
+			Logger::Get().Error("CreateTexture2D 失败");
+			return false;
+		}
+	}
+
+	// 后端取出的第一帧需完整复制
+	_pendingDirtyRegion.isWhole = true;
+
+	// 这里只限制需要轮询的捕获方式，用户设置的最大帧率由后端限制
+	_stepTimer.Initialize(0.0f, _maxCaptureRate, false);
+
+	Logger::Get().Info("捕获线程初始化完成");
+	return true;
+}
+
+void CaptureThread::_CaptureLoop() noexcept {
+	StepTimerStatus stepTimerStatus = StepTimerStatus::WaitForNewFrame;
+	const bool waitMsgForNewFrame =
+		_frameSource->WaitType() == FrameSourceWaitType::WaitForMessage;
+
+	MSG msg;
+	while (true) {
+		stepTimerStatus = _stepTimer.WaitForNextFrame(
+			waitMsgForNewFrame && stepTimerStatus != StepTimerStatus::WaitForFPSLimiter);
+
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) {
+				return;
+			}
+
+			DispatchMessage(&msg);
+		}
+
+		if (stepTimerStatus == StepTimerStatus::WaitForFPSLimiter) {
+			continue;
+		}
+
+		FrameSourceState state;
+		{
+			// 检查重复帧时会设置管线状态。等待新帧不在这里，因此不会长时间阻塞后端
+			auto contextLock = _deviceResources->LockContext();
+			state = _frameSource->Update();
+		}
+
+		switch (state) {
+		case FrameSourceState::NewFrame:
+			_stepTimer.PrepareForRender();
+			_PushFrame();
+			_stepTimer.OnFrameRendered();
+			break;
+		case FrameSourceState::Waiting:
+			break;
+		case FrameSourceState::Error:
+		{
+			{
+				auto lock = _queueLock.lock_exclusive();
+				_isError = true;
+			}
+			// 由后端线程退出缩放
+			_NotifyBackend();
+
+			while (GetMessage(&msg, NULL, 0, 0)) {
+				DispatchMessage(&msg);
+			}
+			return;
+		}
+		}
+	}
+}
+
+void CaptureThread::_PushFrame() noexcept {
+	// 捕获线程中同步检查重复帧，因此这里的帧都需要渲染
+	_frameSource->GetDirtyRegion(_frameDirtyRegion);
+
+	{
+		auto lock = _queueLock.lock_exclusive();
+
+		if (_queue.size() == QUEUE_SIZE) {
+			// 丢弃最旧的帧，它的变化已记录在 _pendingDirtyRegion 中
+			_queue.erase(_queue.begin());
+			++_statistics.droppedFrames;
+		}
+
+		// 选择不在队列中的槽
+		uint32_t slotIdx = 0;
+		while (std::find(_queue.begin(), _queue.end(), slotIdx) != _queue.end()) {
+			++slotIdx;
+		}
+
+		_Slot& slot = _slots[slotIdx];
+		_deviceResources->GetD3DDC()->CopyResource(slot.texture.get(), _frameSource->GetOutput());
+		slot.captureTime = _frameSource->CaptureTime();
+		slot.duplicateCheckResult = _frameSource->LastDuplicateCheckResult();
+		_queue.push_back(slotIdx);
+		++_statistics.producedFrames;
+
+		if (!_pendingDirtyRegion.isWhole) {
+			if (_frameDirtyRegion.isWhole) {
+				_pendingDirtyRegion.isWhole = true;
+				_pendingDirtyRegion.rects.clear();
+			} else {
+				_pendingDirtyRegion.rects.insert(_pendingDirtyRegion.rects.end(),
+					_frameDirtyRegion.rects.begin(), _frameDirtyRegion.rects.end());
+				DirtyRegionPlanner::NormalizeRects(_pendingDirtyRegion.rects, DirtyRegionPlanner::MAX_RECTS);
+			}
+		}
+	}
+
+	_NotifyBackend();
+}
+
+}
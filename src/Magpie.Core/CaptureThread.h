@@ -0,0 +1,131 @@
+#pragma once
+#include "FrameSourceBase.h"
+#include "BackendDescriptorStore.h"
+#include "StepTimer.h"
+#include "SmallVector.h"
+
+namespace Magpie {
+
+class DeviceResources;
+
+struct CaptureThreadStatistics {
+	// 捕获线程放入队列的帧数
+	uint64_t producedFrames = 0;
+	// 后端线程取出的帧数
+	uint64_t consumedFrames = 0;
+	// 被更新的帧取代而没有渲染的帧数
+	uint64_t droppedFrames = 0;
+	// 后端线程取帧时队列中帧数的总和，除以 consumedFrames 即为平均队列深度
+	uint64_t totalQueueDepth = 0;
+	uint32_t maxQueueDepth = 0;
+};
+
+// 在专用线程中运行捕获，捕获到的帧连同时间戳放入一个小的纹理队列，后端线程取出最新的一帧，
+// 更旧的帧被丢弃。等待新帧、捕获和检查重复帧因此不会推迟渲染，后端等待 GPU 完成渲染时捕获线程
+// 也可以继续工作。
+// 两个线程共用后端的设备上下文，由 D3D 的多线程保护同步，设置管线状态的一系列调用期间需持有
+// DeviceResources::LockContext。GPU 按提交的顺序执行复制，因此队列只需保证 CPU 上的访问互斥。
+class CaptureThread {
+public:
+	// 队列中最多有这么多帧，已满时丢弃最旧的帧
+	static constexpr uint32_t QUEUE_SIZE = 3;
+
+	CaptureThread() = default;
+	CaptureThread(const CaptureThread&) = delete;
+	CaptureThread(CaptureThread&&) = delete;
+
+	~CaptureThread() noexcept;
+
+	// 由后端线程调用，返回时捕获线程已完成初始化。frameSource 将在捕获线程中初始化和使用。
+	// maxCaptureRate 用于限制需要轮询的捕获方式。
+	bool Initialize(
+		std::unique_ptr<FrameSourceBase> frameSource,
+		DeviceResources& deviceResources,
+		std::optional<float> maxCaptureRate
+	) noexcept;
+
+	// 初始化后只能使用 const 成员
+	const FrameSourceBase& FrameSource() const noexcept {
+		return *_frameSource;
+	}
+
+	// 以下只能由后端线程调用
+
+	// 作为效果的输入，Update 返回 NewFrame 时更新为最新的帧
+	ID3D11Texture2D* GetOutput() const noexcept {
+		return _output.get();
+	}
+
+	// 取出队列中最新的帧，队列为空时返回 Waiting。捕获线程放入新帧后会向后端线程发送消息
+	FrameSourceState Update() noexcept;
+
+	std::chrono::steady_clock::time_point CaptureTime() const noexcept {
+		return _captureTime;
+	}
+
+	DuplicateFrameCheckResult LastDuplicateCheckResult() const noexcept {
+		return _lastDuplicateCheckResult;
+	}
+
+	// 最近一次 Update 返回 NewFrame 时 GetOutput 相对上一次变化的区域，包含被丢弃的帧的变化
+	void GetDirtyRegion(DirtyRegion& region) const;
+
+	CaptureThreadStatistics Statistics() noexcept;
+
+	void OnCursorVisibilityChanged(bool isVisible, bool onDestory) noexcept;
+
+private:
+	struct _Slot {
+		winrt::com_ptr<ID3D11Texture2D> texture;
+		std::chrono::steady_clock::time_point captureTime;
+		DuplicateFrameCheckResult duplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
+	};
+
+	void _ThreadProc() noexcept;
+
+	bool _InitializeOnThread() noexcept;
+
+	void _CaptureLoop() noexcept;
+
+	void _PushFrame() noexcept;
+
+	void _NotifyBackend() const noexcept {
+		PostThreadMessage(_backendThreadId, WM_NULL, 0, 0);
+	}
+
+	std::thread _thread;
+	DWORD _backendThreadId = 0;
+
+	std::unique_ptr<FrameSourceBase> _frameSource;
+	DeviceResources* _deviceResources = nullptr;
+	std::optional<float> _maxCaptureRate;
+
+	// 以下只由捕获线程访问
+	// BackendDescriptorStore 不是线程安全的，捕获线程使用自己的
+	BackendDescriptorStore _descriptorStore;
+	StepTimer _stepTimer;
+	DirtyRegion _frameDirtyRegion;
+
+	// 在捕获线程中创建，初始化完成后可以在其他线程使用
+	winrt::Windows::System::DispatcherQueue _dispatcher{ nullptr };
+	// 0: 正在初始化，1: 成功，2: 失败
+	std::atomic<uint32_t> _initState = 0;
+
+	wil::srwlock _queueLock;
+	// 以下由 _queueLock 保护
+	std::array<_Slot, QUEUE_SIZE> _slots;
+	// 队列中的帧在 _slots 中的索引，从旧到新
+	SmallVector<uint32_t, QUEUE_SIZE> _queue;
+	// 后端线程上次取帧以来所有帧变化的区域
+	DirtyRegion _pendingDirtyRegion;
+	CaptureThreadStatistics _statistics;
+	bool _isError = false;
+
+	// 以下只由后端线程访问
+	winrt::com_ptr<ID3D11Texture2D> _output;
+	std::chrono::steady_clock::time_point _captureTime;
+	DuplicateFrameCheckResult _lastDuplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
+	DirtyRegion _dirtyRegion;
+};
+
+}
@@ -9,6 +9,11 @@
 
 namespace Magpie {
 
+// 合并变化的区域，最多复制这么多次
+static constexpr uint32_t MAX_COPY_RECTS = 16;
+// 等待线程每隔这么久检查一次是否应退出
+static constexpr UINT ACQUIRE_TIMEOUT_MS = 100;
+
 static winrt::com_ptr<IDXGIOutput1> FindMonitor(IDXGIAdapter1* adapter, HMONITOR hMonitor) noexcept {
 	winrt::com_ptr<IDXGIOutput> output;
 
@@ -37,6 +42,14 @@ static winrt::com_ptr<IDXGIOutput1> FindMonitor(IDXGIAdapter1* adapter, HMONITOR
 	return nullptr;
 }
 
+DesktopDuplicationFrameSource::~DesktopDuplicationFrameSource() {
+	if (_acquireThread.joinable()) {
+		_isStopping.store(true, std::memory_order_relaxed);
+		_frameReleasedEvent.SetEvent();
+		_acquireThread.join();
+	}
+}
+
 bool DesktopDuplicationFrameSource::_Initialize() noexcept {
 	// WDA_EXCLUDEFROMCAPTURE 只在 Win10 20H1 及更新版本中可用
 	if (!Win32Helper::GetOSVersion().Is20H1OrNewer()) {
@@ -121,35 +134,80 @@ bool DesktopDuplicationFrameSource::_Initialize() noexcept {
 		return false;
 	}
 
+	// AcquireNextFrame 可能在内部使用设备，而后端线程同时在渲染
+	if (!_deviceResources->EnableMultithreadProtection()) {
+		Logger::Get().Error("EnableMultithreadProtection 失败");
+		return false;
+	}
+
+	if (!_frameReleasedEvent.try_create(wil::EventOptions::None, nullptr)) {
+		Logger::Get().Win32Error("CreateEvent 失败");
+		return false;
+	}
+
+	_backendThreadId = GetCurrentThreadId();
+	_acquireThread = std::thread(std::bind(&DesktopDuplicationFrameSource::_AcquireThreadProc, this));
+
 	Logger::Get().Info("DesktopDuplicationFrameSource 初始化完成");
 	return true;
 }
 
 FrameSourceState DesktopDuplicationFrameSource::_Update() noexcept {
-	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
-
-	if (_isFrameAcquired) {
-		// 根据文档，释放后立刻获取下一帧可以提高性能
-		_outputDup->ReleaseFrame();
-		_isFrameAcquired = false;
-	}
-
-	DXGI_OUTDUPL_FRAME_INFO info;
-	winrt::com_ptr<IDXGIResource> dxgiRes;
-	// 等待 1ms
-	HRESULT hr = _outputDup->AcquireNextFrame(1, &info, dxgiRes.put());
-	if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
+	if (!_isFrameAcquired.load(std::memory_order_acquire)) {
+		// 获取到新帧时等待线程会发送消息
 		return FrameSourceState::Waiting;
 	}
 
-	if (FAILED(hr)) {
-		Logger::Get().ComError("AcquireNextFrame 失败", hr);
+	if (FAILED(_acquireResult)) {
+		Logger::Get().ComError("AcquireNextFrame 失败", _acquireResult);
 		return FrameSourceState::Error;
 	}
 
-	_isFrameAcquired = true;
+	const FrameSourceState state = _ProcessAcquiredFrame();
+
+	// 交还给等待线程，由它在获取下一帧前释放这一帧
+	_frameResource = nullptr;
+	_isFrameAcquired.store(false, std::memory_order_relaxed);
+	_frameReleasedEvent.SetEvent();
+
+	return state;
+}
+
+void DesktopDuplicationFrameSource::_AcquireThreadProc() noexcept {
+#ifdef _DEBUG
+	SetThreadDescription(GetCurrentThread(), L"Magpie-DD 等待线程");
+#endif
+
+	while (!_isStopping.load(std::memory_order_relaxed)) {
+		HRESULT hr = _outputDup->AcquireNextFrame(
+			ACQUIRE_TIMEOUT_MS, &_frameInfo, _frameResource.put());
+		if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
+			continue;
+		}
+
+		_acquireResult = hr;
+		_isFrameAcquired.store(true, std::memory_order_release);
+		// 唤醒后端线程
+		PostThreadMessage(_backendThreadId, WM_NULL, 0, 0);
+
+		_frameReleasedEvent.wait();
+
+		if (FAILED(hr)) {
+			// 后端线程将停止捕获
+			break;
+		}
+
+		// 根据文档，释放后立刻获取下一帧可以提高性能
+		_outputDup->ReleaseFrame();
+	}
+}
+
+FrameSourceState DesktopDuplicationFrameSource::_ProcessAcquiredFrame() noexcept {
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+	const DXGI_OUTDUPL_FRAME_INFO& info = _frameInfo;
+	HRESULT hr;
 
-	bool noUpdate = true;
+	_dirtyRects.clear();
 
 	// 检索 move rects 和 dirty rects
 	// 这些区域如果和窗口客户区有重叠则表明画面有变化
@@ -168,52 +226,79 @@ FrameSourceState DesktopDuplicationFrameSource::_Update() noexcept {
 			return FrameSourceState::Error;
 		}
 
+		// 桌面图像中目标区域已经是移动后的内容，直接复制即可。在 _output 内移动需要额外的纹理，
+		// 因为源和目标可能重叠，而且复制的数据量相同
 		uint32_t nRect = bufSize / sizeof(DXGI_OUTDUPL_MOVE_RECT);
 		for (uint32_t i = 0; i < nRect; ++i) {
 			const DXGI_OUTDUPL_MOVE_RECT& rect = 
 				((DXGI_OUTDUPL_MOVE_RECT*)_dupMetaData.data())[i];
-			if (Win32Helper::CheckOverlap(_srcClientInMonitor, rect.DestinationRect)) {
-				noUpdate = false;
-				break;
-			}
+			_AddDirtyRect(rect.DestinationRect);
 		}
 
-		if (noUpdate) {
-			bufSize = info.TotalMetadataBufferSize;
+		bufSize = info.TotalMetadataBufferSize;
 
-			// Dirty rects
-			hr = _outputDup->GetFrameDirtyRects(
-				bufSize, (RECT*)_dupMetaData.data(), &bufSize);
-			if (FAILED(hr)) {
-				Logger::Get().ComError("GetFrameDirtyRects 失败", hr);
-				return FrameSourceState::Error;
-			}
+		// Dirty rects
+		hr = _outputDup->GetFrameDirtyRects(
+			bufSize, (RECT*)_dupMetaData.data(), &bufSize);
+		if (FAILED(hr)) {
+			Logger::Get().ComError("GetFrameDirtyRects 失败", hr);
+			return FrameSourceState::Error;
+		}
 
-			nRect = bufSize / sizeof(RECT);
-			for (uint32_t i = 0; i < nRect; ++i) {
-				const RECT& rect = ((RECT*)_dupMetaData.data())[i];
-				if (Win32Helper::CheckOverlap(_srcClientInMonitor, rect)) {
-					noUpdate = false;
-					break;
-				}
-			}
+		nRect = bufSize / sizeof(RECT);
+		for (uint32_t i = 0; i < nRect; ++i) {
+			_AddDirtyRect(((RECT*)_dupMetaData.data())[i]);
 		}
 	}
 
-	if (noUpdate) {
+	if (_dirtyRects.empty()) {
 		return FrameSourceState::Waiting;
 	}
 	
-	winrt::com_ptr<ID3D11Texture2D> frameTexture = dxgiRes.try_as<ID3D11Texture2D>();
+	winrt::com_ptr<ID3D11Texture2D> frameTexture = _frameResource.try_as<ID3D11Texture2D>();
 	if (!frameTexture) {
 		Logger::Get().Error("从 IDXGIResource 检索 ID3D11Resource 失败");
 		return FrameSourceState::Error;
 	}
 
-	d3dDC->CopySubresourceRegion(
-		_output.get(), 0, 0, 0, 0, frameTexture.get(), 0, &_frameInMonitor);
+	if (!_isOutputInitialized) {
+		d3dDC->CopySubresourceRegion(
+			_output.get(), 0, 0, 0, 0, frameTexture.get(), 0, &_frameInMonitor);
+		_isOutputInitialized = true;
+		return FrameSourceState::NewFrame;
+	}
 
+	// 只复制变化的部分
+	DirtyRegionPlanner::NormalizeRects(_dirtyRects, MAX_COPY_RECTS);
+	for (const DirtyRect& rect : _dirtyRects) {
+		const D3D11_BOX box{
+			_frameInMonitor.left + rect.left,
+			_frameInMonitor.top + rect.top,
+			0,
+			_frameInMonitor.left + rect.right,
+			_frameInMonitor.top + rect.bottom,
+			1
+		};
+		d3dDC->CopySubresourceRegion(
+			_output.get(), 0, rect.left, rect.top, 0, frameTexture.get(), 0, &box);
+	}
+
+	_hasDirtyRects = true;
 	return FrameSourceState::NewFrame;
 }
 
+void DesktopDuplicationFrameSource::_AddDirtyRect(const RECT& rect) {
+	RECT intersection;
+	if (!IntersectRect(&intersection, &_srcClientInMonitor, &rect)) {
+		return;
+	}
+
+	_dirtyRects.push_back({
+		uint32_t(intersection.left - _srcClientInMonitor.left),
+		uint32_t(intersection.top - _srcClientInMonitor.top),
+		uint32_t(intersection.right - _srcClientInMonitor.left),
+		uint32_t(intersection.bottom - _srcClientInMonitor.top)
+	});
+}
+
 }
@@ -5,14 +5,18 @@
 
 namespace Magpie {
 
+// AcquireNextFrame 没有可以等待的句柄，为了不轮询，在专用线程中阻塞等待新帧，获取到新帧后向后端线程
+// 发送消息。两个线程交替使用 _outputDup: 等待线程获取帧后便不再访问，直到后端线程处理完这一帧。
 class DesktopDuplicationFrameSource final : public FrameSourceBase {
 public:
+	virtual ~DesktopDuplicationFrameSource();
+
 	bool IsScreenCapture() const noexcept override {
 		return true;
 	}
 
 	FrameSourceWaitType WaitType() const noexcept override {
-		return FrameSourceWaitType::WaitForFrame;
+		return FrameSourceWaitType::WaitForMessage;
 	}
 
 	const char* Name() const noexcept override {
@@ -33,6 +37,14 @@ protected:
 	FrameSourceState _Update() noexcept override;
 
 private:
+	// 将和窗口客户区重叠的部分添加到 _dirtyRects
+	void _AddDirtyRect(const RECT& rect);
+
+	void _AcquireThreadProc() noexcept;
+
+	// 处理等待线程获取到的帧，返回后帧可以被释放
+	FrameSourceState _ProcessAcquiredFrame() noexcept;
+
 	winrt::com_ptr<IDXGIOutputDuplication> _outputDup;
 
 	SmallVector<uint8_t, 0> _dupMetaData;
@@ -40,7 +52,18 @@ private:
 	RECT _srcClientInMonitor{};
 	D3D11_BOX _frameInMonitor{};
 
-	bool _isFrameAcquired = false;
+	std::thread _acquireThread;
+	DWORD _backendThreadId = 0;
+	// 后端线程处理完一帧或要求退出时设置
+	wil::unique_event_nothrow _frameReleasedEvent;
+	std::atomic<bool> _isStopping = false;
+	// 以下三个成员由等待线程写入，_isFrameAcquired 为 true 后由后端线程读取
+	std::atomic<bool> _isFrameAcquired = false;
+	HRESULT _acquireResult = S_OK;
+	DXGI_OUTDUPL_FRAME_INFO _frameInfo{};
+	winrt::com_ptr<IDXGIResource> _frameResource;
+	// 第一帧需要复制整个客户区，之后只复制变化的部分
+	bool _isOutputInitialized = false;
 };
 
 }
@@ -41,6 +41,9 @@ bool DeviceResources::Initialize() noexcept {
 
 ID3D11SamplerState* DeviceResources::GetSampler(D3D11_FILTER filterMode, D3D11_TEXTURE_ADDRESS_MODE addressMode) noexcept {
 	auto key = std::make_pair(filterMode, addressMode);
+
+	auto lock = _samMapLock.lock_exclusive();
+
 	auto it = _samMap.find(key);
 	if (it != _samMap.end()) {
 		return it->second.get();
@@ -64,6 +67,21 @@ ID3D11SamplerState* DeviceResources::GetSampler(D3D11_FILTER filterMode, D3D11_T
 	return _samMap.emplace(key, std::move(sam)).first->second.get();
 }
 
+bool DeviceResources::EnableMultithreadProtection() noexcept {
+	if (_multithread) {
+		return true;
+	}
+
+	HRESULT hr = _d3dDC->QueryInterface(IID_PPV_ARGS(_multithread.put()));
+	if (FAILED(hr)) {
+		Logger::Get().ComError("获取 ID3D11Multithread 失败", hr);
+		return false;
+	}
+
+	_multithread->SetMultithreadProtected(TRUE);
+	return true;
+}
+
 bool DeviceResources::_ObtainAdapterAndDevice(GraphicsCardId graphicsCardId) noexcept {
 	winrt::com_ptr<IDXGIAdapter1> adapter;
 	// 记录不支持 FL11 的显卡索引，防止重复尝试
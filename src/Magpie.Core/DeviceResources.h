@@ -20,8 +20,25 @@ public:
 	bool IsTearingSupported() const noexcept { return _isTearingSupported; }
 	bool IsFP16Supported() const noexcept { return _isFP16Supported; }
 
+	// 可以在多个线程中调用
 	ID3D11SamplerState* GetSampler(D3D11_FILTER filterMode, D3D11_TEXTURE_ADDRESS_MODE addressMode) noexcept;
 
+	// 多个线程使用 GetD3DDC() 前调用，之后 D3D 会在内部同步对设备上下文的每次调用
+	bool EnableMultithreadProtection() noexcept;
+
+	// 设置管线状态并执行 Dispatch 等一系列调用期间应持有此锁，防止其他线程修改管线状态。
+	// 未启用多线程保护时什么也不做
+	[[nodiscard]] auto LockContext() noexcept {
+		if (_multithread) {
+			_multithread->Enter();
+		}
+		return wil::scope_exit([this]() {
+			if (_multithread) {
+				_multithread->Leave();
+			}
+		});
+	}
+
 private:
 	bool _ObtainAdapterAndDevice(GraphicsCardId graphicsCardId) noexcept;
 	bool _TryCreateD3DDevice(const winrt::com_ptr<IDXGIAdapter1>& adapter) noexcept;
@@ -30,11 +47,14 @@ private:
 	winrt::com_ptr<IDXGIAdapter4> _graphicsAdapter;
 	winrt::com_ptr<ID3D11Device5> _d3dDevice;
 	winrt::com_ptr<ID3D11DeviceContext4> _d3dDC;
+	// 启用多线程保护后才有值
+	winrt::com_ptr<ID3D11Multithread> _multithread;
 
 	phmap::flat_hash_map<
 		std::pair<D3D11_FILTER, D3D11_TEXTURE_ADDRESS_MODE>,
 		winrt::com_ptr<ID3D11SamplerState>
 	> _samMap;
+	wil::srwlock _samMapLock;
 
 	bool _isTearingSupported = false;
 	bool _isFP16Supported = false;
@@ -0,0 +1,269 @@
+// 不使用预编译头，只能使用标准库
+#include "DirtyRegionPlanner.h"
+#include <algorithm>
+
+namespace Magpie {
+
+// 矩形太多时直接合并为外接矩形，避免 NormalizeRects 耗时过长
+static constexpr size_t MAX_INPUT_RECTS = 64;
+
+static bool IsEmptyRect(const DirtyRect& rect) noexcept {
+	return rect.left >= rect.right || rect.top >= rect.bottom;
+}
+
+static bool IsOverlapped(const DirtyRect& a, const DirtyRect& b) noexcept {
+	return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+// 共用一条完整的边，合并后面积不变。只有角或部分边接触的矩形合并后会包含未变化的区域，因此不在此列
+static bool IsAdjacent(const DirtyRect& a, const DirtyRect& b) noexcept {
+	if (a.top == b.top && a.bottom == b.bottom) {
+		return a.right == b.left || b.right == a.left;
+	}
+	if (a.left == b.left && a.right == b.right) {
+		return a.bottom == b.top || b.bottom == a.top;
+	}
+	return false;
+}
+
+static DirtyRect UnionRect(const DirtyRect& a, const DirtyRect& b) noexcept {
+	return {
+		std::min(a.left, b.left),
+		std::min(a.top, b.top),
+		std::max(a.right, b.right),
+		std::max(a.bottom, b.bottom)
+	};
+}
+
+static uint64_t RectArea(const DirtyRect& rect) noexcept {
+	return uint64_t(rect.right - rect.left) * (rect.bottom - rect.top);
+}
+
+// 将 from 中的矩形以 radius 扩展后映射到 to 中，向外取整
+static DirtyRect MapRect(
+	const DirtyRect& rect,
+	uint32_t fromWidth,
+	uint32_t fromHeight,
+	uint32_t toWidth,
+	uint32_t toHeight,
+	uint32_t radius
+) noexcept {
+	const uint64_t left = rect.left > radius ? rect.left - radius : 0;
+	const uint64_t top = rect.top > radius ? rect.top - radius : 0;
+	const uint64_t right = std::min(uint64_t(rect.right) + radius, uint64_t(fromWidth));
+	const uint64_t bottom = std::min(uint64_t(rect.bottom) + radius, uint64_t(fromHeight));
+
+	return {
+		uint32_t(left * toWidth / fromWidth),
+		uint32_t(top * toHeight / fromHeight),
+		uint32_t(std::min((right * toWidth + fromWidth - 1) / fromWidth, uint64_t(toWidth))),
+		uint32_t(std::min((bottom * toHeight + fromHeight - 1) / fromHeight, uint64_t(toHeight)))
+	};
+}
+
+void DirtyRegionPlanner::AddTexture(uint32_t width, uint32_t height, bool isConstant) {
+	_textures.push_back({ width, height, isConstant, false });
+}
+
+void DirtyRegionPlanner::AddPass(
+	std::span<const uint32_t> inputs,
+	std::span<const uint32_t> outputs,
+	int32_t sampleRadius,
+	uint32_t blockWidth,
+	uint32_t blockHeight
+) {
+	for (uint32_t input : inputs) {
+		const _TextureInfo& texInfo = _textures[input];
+		if (input >= 2 && !texInfo.isConstant && !texInfo.isWritten) {
+			// 读取的是之前的帧留下的内容
+			_isPlannable = false;
+		}
+	}
+
+	for (uint32_t output : outputs) {
+		_TextureInfo& texInfo = _textures[output];
+		if (texInfo.isWritten) {
+			// 被多个通道写入
+			_isPlannable = false;
+		}
+		texInfo.isWritten = true;
+	}
+
+	_passes.push_back({
+		std::vector<uint32_t>(inputs.begin(), inputs.end()),
+		std::vector<uint32_t>(outputs.begin(), outputs.end()),
+		sampleRadius,
+		blockWidth,
+		blockHeight
+	});
+	_passDispatches.emplace_back();
+}
+
+void DirtyRegionPlanner::Plan(const DirtyRegion& inputRegion, DirtyRegion& outputRegion) {
+	_regions.resize(_textures.size());
+	for (DirtyRegion& region : _regions) {
+		region.isWhole = false;
+		region.rects.clear();
+	}
+
+	// 第一帧没有可以保留的内容
+	const bool isFull = !_isPlannable || !_hasHistory || inputRegion.isWhole;
+	_hasHistory = true;
+
+	if (isFull) {
+		_regions[0].isWhole = true;
+	} else {
+		_regions[0].rects = inputRegion.rects;
+		NormalizeRects(_regions[0].rects, MAX_RECTS);
+	}
+
+	for (uint32_t i = 0; i < _passes.size(); ++i) {
+		const _PassInfo& pass = _passes[i];
+		const _TextureInfo& outputInfo = _textures[pass.outputs[0]];
+		DirtyRegion& region = _regions[pass.outputs[0]];
+
+		if (pass.sampleRadius < 0) {
+			region.isWhole = true;
+		} else {
+			for (uint32_t input : pass.inputs) {
+				const DirtyRegion& srcRegion = _regions[input];
+				if (srcRegion.isWhole) {
+					region.isWhole = true;
+					break;
+				}
+
+				const _TextureInfo& inputInfo = _textures[input];
+				for (const DirtyRect& rect : srcRegion.rects) {
+					region.rects.push_back(MapRect(rect, inputInfo.width, inputInfo.height,
+						outputInfo.width, outputInfo.height, (uint32_t)pass.sampleRadius));
+				}
+			}
+
+			if (!region.isWhole) {
+				NormalizeRects(region.rects, MAX_RECTS);
+			}
+		}
+
+		_PlanDispatches(region, pass, _passDispatches[i]);
+
+		// 其他输出和第一个输出的变化区域相同
+		for (size_t j = 1; j < pass.outputs.size(); ++j) {
+			const _TextureInfo& otherInfo = _textures[pass.outputs[j]];
+			DirtyRegion& otherRegion = _regions[pass.outputs[j]];
+			otherRegion.isWhole = region.isWhole;
+			for (const DirtyRect& rect : region.rects) {
+				otherRegion.rects.push_back(MapRect(rect, outputInfo.width, outputInfo.height,
+					otherInfo.width, otherInfo.height, 0));
+			}
+		}
+	}
+
+	outputRegion = _regions[1];
+}
+
+void DirtyRegionPlanner::_PlanDispatches(
+	const DirtyRegion& region,
+	const _PassInfo& pass,
+	std::vector<DirtyDispatch>& dispatches
+) {
+	dispatches.clear();
+
+	const _TextureInfo& outputInfo = _textures[pass.outputs[0]];
+	const uint32_t groupCountX = (outputInfo.width + pass.blockWidth - 1) / pass.blockWidth;
+	const uint32_t groupCountY = (outputInfo.height + pass.blockHeight - 1) / pass.blockHeight;
+
+	if (region.isWhole) {
+		dispatches.push_back({ 0, 0, groupCountX, groupCountY });
+		return;
+	}
+
+	if (region.rects.empty()) {
+		return;
+	}
+
+	// 每个线程组负责输出中的一块
+	_groupRects.clear();
+	for (const DirtyRect& rect : region.rects) {
+		_groupRects.push_back({
+			rect.left / pass.blockWidth,
+			rect.top / pass.blockHeight,
+			(rect.right + pass.blockWidth - 1) / pass.blockWidth,
+			(rect.bottom + pass.blockHeight - 1) / pass.blockHeight
+		});
+	}
+	NormalizeRects(_groupRects, MAX_RECTS);
+
+	uint64_t groupCount = 0;
+	for (const DirtyRect& rect : _groupRects) {
+		groupCount += RectArea(rect);
+	}
+
+	if (groupCount > uint64_t(groupCountX) * groupCountY * FULL_DISPATCH_RATIO) {
+		dispatches.push_back({ 0, 0, groupCountX, groupCountY });
+		return;
+	}
+
+	for (const DirtyRect& rect : _groupRects) {
+		dispatches.push_back({ rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top });
+	}
+}
+
+void DirtyRegionPlanner::NormalizeRects(std::vector<DirtyRect>& rects, uint32_t maxCount) {
+	std::erase_if(rects, IsEmptyRect);
+
+	if (rects.size() > MAX_INPUT_RECTS) {
+		DirtyRect bounds = rects[0];
+		for (size_t i = 1; i < rects.size(); ++i) {
+			bounds = UnionRect(bounds, rects[i]);
+		}
+		rects.assign(1, bounds);
+		return;
+	}
+
+	while (true) {
+		// 首先合并重叠或相邻的矩形
+		bool merged = false;
+		for (size_t i = 0; i < rects.size() && !merged; ++i) {
+			for (size_t j = i + 1; j < rects.size(); ++j) {
+				if (IsOverlapped(rects[i], rects[j]) || IsAdjacent(rects[i], rects[j])) {
+					rects[i] = UnionRect(rects[i], rects[j]);
+					rects.erase(rects.begin() + j);
+					merged = true;
+					break;
+				}
+			}
+		}
+		if (merged) {
+			continue;
+		}
+
+		if (rects.size() <= maxCount) {
+			break;
+		}
+
+		// 合并使面积增加最少的两个矩形
+		size_t bestI = 0;
+		size_t bestJ = 1;
+		uint64_t minIncrease = UINT64_MAX;
+		for (size_t i = 0; i < rects.size(); ++i) {
+			for (size_t j = i + 1; j < rects.size(); ++j) {
+				const uint64_t increase = RectArea(UnionRect(rects[i], rects[j]))
+					- RectArea(rects[i]) - RectArea(rects[j]);
+				if (increase < minIncrease) {
+					minIncrease = increase;
+					bestI = i;
+					bestJ = j;
+				}
+			}
+		}
+
+		rects[bestI] = UnionRect(rects[bestI], rects[bestJ]);
+		rects.erase(rects.begin() + bestJ);
+	}
+
+	std::sort(rects.begin(), rects.end(), [](const DirtyRect& l, const DirtyRect& r) {
+		return l.top != r.top ? l.top < r.top : l.left < r.left;
+	});
+}
+
+}
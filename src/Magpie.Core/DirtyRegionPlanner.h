@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Magpie {
+
+// 单位为像素
+struct DirtyRect {
+	uint32_t left;
+	uint32_t top;
+	uint32_t right;
+	uint32_t bottom;
+};
+
+// 纹理中自上一帧以来变化的区域
+struct DirtyRegion {
+	// 为 true 时应视为整个纹理都已变化，rects 无意义
+	bool isWhole = true;
+	// 互不重叠。为空表示没有变化
+	std::vector<DirtyRect> rects;
+};
+
+// 一次 Dispatch，单位为线程组
+struct DirtyDispatch {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+};
+
+// 根据输入变化的区域规划效果的每个通道需要执行的线程组。通道输出变化的区域是所有输入变化的区域
+// 以通道声明的采样半径 (见 MagpieFX 的 RADIUS) 扩展后映射到输出的结果，未变化的部分保留上一帧
+// 的内容。为了使这成立，效果中不能有时间上的依赖: 不能读取之前的帧留下的中间纹理，每个中间纹理
+// 也只能由一个通道写入，否则总是完整渲染。
+// 此类不依赖 GPU，注意此头文件和 DirtyRegionPlanner.cpp 只能使用标准库。
+class DirtyRegionPlanner {
+public:
+	// 变化的区域最多由这么多矩形组成，超过时合并相邻的矩形
+	static constexpr uint32_t MAX_RECTS = 8;
+	// 需要的线程组超过完整 Dispatch 的此比例时退回完整 Dispatch
+	static constexpr float FULL_DISPATCH_RATIO = 0.5f;
+
+	// 纹理 0 为 INPUT，纹理 1 为 OUTPUT。isConstant 表示从文件加载的纹理
+	void AddTexture(uint32_t width, uint32_t height, bool isConstant);
+
+	// sampleRadius 为输出的每个像素最多使用输入中距离对应位置多少像素的内容，单位为输入纹理的像素。
+	// 小于 0 表示未知，此通道总是完整渲染。需在添加所有纹理后调用
+	void AddPass(
+		std::span<const uint32_t> inputs,
+		std::span<const uint32_t> outputs,
+		int32_t sampleRadius,
+		uint32_t blockWidth,
+		uint32_t blockHeight
+	);
+
+	// 根据 INPUT 变化的区域规划每个通道的 Dispatch，返回 OUTPUT 变化的区域。调用者必须按规划执行所有
+	// 通道，否则应调用 Reset
+	void Plan(const DirtyRegion& inputRegion, DirtyRegion& outputRegion);
+
+	// 下一次 Plan 完整渲染，比如纹理的内容失效时
+	void Reset() noexcept {
+		_hasHistory = false;
+	}
+
+	// Plan 之后获取通道需要执行的 Dispatch，为空表示此通道无需执行
+	std::span<const DirtyDispatch> PassDispatches(uint32_t passIdx) const noexcept {
+		return _passDispatches[passIdx];
+	}
+
+	// 合并重叠或共用一条完整边的矩形，数量超过 maxCount 时继续合并使外接矩形面积增加最少的两个矩形。
+	// 结果按 top 和 left 排序
+	static void NormalizeRects(std::vector<DirtyRect>& rects, uint32_t maxCount);
+
+private:
+	struct _TextureInfo {
+		uint32_t width;
+		uint32_t height;
+		bool isConstant;
+		bool isWritten;
+	};
+
+	struct _PassInfo {
+		std::vector<uint32_t> inputs;
+		std::vector<uint32_t> outputs;
+		int32_t sampleRadius;
+		uint32_t blockWidth;
+		uint32_t blockHeight;
+	};
+
+	void _PlanDispatches(const DirtyRegion& region, const _PassInfo& pass, std::vector<DirtyDispatch>& dispatches);
+
+	std::vector<_TextureInfo> _textures;
+	std::vector<_PassInfo> _passes;
+	std::vector<std::vector<DirtyDispatch>> _passDispatches;
+	// Plan 中使用，避免每帧分配内存
+	std::vector<DirtyRegion> _regions;
+	std::vector<DirtyRect> _groupRects;
+	// 效果中存在时间上的依赖时只能完整渲染
+	bool _isPlannable = true;
+	bool _hasHistory = false;
+};
+
+}
@@ -0,0 +1,92 @@
+// 不使用预编译头，以便 DuplicateFrameSimulator 直接编译此文件
+#include "DuplicateFramePredictor.h"
+#include <algorithm>
+
+namespace Magpie {
+
+static constexpr uint16_t INITIAL_CHECK_COUNT = 16;
+static constexpr uint16_t INITIAL_SKIP_COUNT = 1;
+
+void HeuristicDuplicateFramePredictor::OnChecked(bool isDuplicate) noexcept {
+	static constexpr uint16_t MAX_SKIP_COUNT = 16;
+
+	if (isDuplicate) {
+		_isChecking = true;
+		_framesLeft = INITIAL_CHECK_COUNT;
+		_nextSkipCount = INITIAL_SKIP_COUNT;
+		return;
+	}
+
+	if (--_framesLeft == 0) {
+		_isChecking = false;
+		_framesLeft = _nextSkipCount;
+		if (_nextSkipCount < MAX_SKIP_COUNT) {
+			// 增加下一次连续跳过检查的帧数
+			++_nextSkipCount;
+		}
+	}
+}
+
+void HeuristicDuplicateFramePredictor::OnSkipped() noexcept {
+	if (--_framesLeft == 0) {
+		_isChecking = true;
+		// 第 2 次连续检查 10 帧，之后逐渐减少，从第 16 次开始只连续检查 2 帧
+		_framesLeft = uint16_t((-4 * (int)_nextSkipCount + 78) / 7);
+	}
+}
+
+void ExponentialBackoffDuplicateFramePredictor::OnChecked(bool isDuplicate) noexcept {
+	static constexpr uint16_t MAX_SKIP_COUNT = 64;
+
+	if (isDuplicate) {
+		_isChecking = true;
+		_framesLeft = INITIAL_CHECK_COUNT;
+		_nextSkipCount = INITIAL_SKIP_COUNT;
+		return;
+	}
+
+	if (--_framesLeft == 0) {
+		_isChecking = false;
+		_framesLeft = _nextSkipCount;
+		_nextSkipCount = std::min(uint16_t(_nextSkipCount * 2), MAX_SKIP_COUNT);
+	}
+}
+
+void ExponentialBackoffDuplicateFramePredictor::OnSkipped() noexcept {
+	// 每次跳过后只检查 2 帧
+	static constexpr uint16_t CHECK_COUNT = 2;
+
+	if (--_framesLeft == 0) {
+		_isChecking = true;
+		_framesLeft = CHECK_COUNT;
+	}
+}
+
+// 检查的开销和渲染一帧的开销之比。重复帧的概率高于此值时检查的收益大于开销
+static constexpr float CHECK_COST_RATIO = 0.05f;
+// 概率估计值的指数移动平均系数
+static constexpr float LEARNING_RATE = 1.0f / 32;
+// 跳过检查时至少每隔此帧数检查一次
+static constexpr uint32_t EXPLORATION_INTERVAL = 16;
+
+bool LearnedDuplicateFramePredictor::ShouldCheck() const noexcept {
+	return _duplicateProbability > CHECK_COST_RATIO || _framesSinceCheck + 1 >= EXPLORATION_INTERVAL;
+}
+
+void LearnedDuplicateFramePredictor::OnChecked(bool isDuplicate) noexcept {
+	_framesSinceCheck = 0;
+
+	if (isDuplicate) {
+		// 重复帧往往成段出现，立即恢复检查
+		_duplicateProbability = std::max(
+			_duplicateProbability + (1.0f - _duplicateProbability) * LEARNING_RATE, 2 * CHECK_COST_RATIO);
+	} else {
+		_duplicateProbability -= _duplicateProbability * LEARNING_RATE;
+	}
+}
+
+void LearnedDuplicateFramePredictor::OnSkipped() noexcept {
+	++_framesSinceCheck;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+
+namespace Magpie {
+
+// 动态检测重复帧时预测是否值得检查下一帧。检查重复帧需要一次 GPU 往返，跳过检查则可能渲染重复帧，
+// 不同的策略在两者之间取舍。此类不依赖 GPU，因此可以由 DuplicateFrameSimulator 离线重放记录的序列。
+// 注意此头文件和 DuplicateFramePredictor.cpp 只能使用标准库。
+class DuplicateFramePredictor {
+public:
+	virtual ~DuplicateFramePredictor() noexcept = default;
+
+	// 是否应检查当前帧
+	virtual bool ShouldCheck() const noexcept = 0;
+
+	// ShouldCheck 返回 true 时报告检查结果
+	virtual void OnChecked(bool isDuplicate) noexcept = 0;
+
+	// ShouldCheck 返回 false 时调用
+	virtual void OnSkipped() noexcept = 0;
+};
+
+// 连续检查一段时间没有发现重复帧则跳过检查，跳过的帧数逐渐增加，同时连续检查的帧数逐渐减少。见 #787
+class HeuristicDuplicateFramePredictor : public DuplicateFramePredictor {
+public:
+	bool ShouldCheck() const noexcept override {
+		return _isChecking;
+	}
+
+	void OnChecked(bool isDuplicate) noexcept override;
+
+	void OnSkipped() noexcept override;
+
+private:
+	uint16_t _nextSkipCount = 1;
+	uint16_t _framesLeft = 16;
+	bool _isChecking = true;
+};
+
+// 每次没有发现重复帧后跳过的帧数翻倍，发现重复帧则重置
+class ExponentialBackoffDuplicateFramePredictor : public DuplicateFramePredictor {
+public:
+	bool ShouldCheck() const noexcept override {
+		return _isChecking;
+	}
+
+	void OnChecked(bool isDuplicate) noexcept override;
+
+	void OnSkipped() noexcept override;
+
+private:
+	uint16_t _nextSkipCount = 1;
+	uint16_t _framesLeft = 16;
+	bool _isChecking = true;
+};
+
+// 估计重复帧出现的概率，只在检查的收益大于开销时检查，否则每隔一段时间检查一帧以更新估计值
+class LearnedDuplicateFramePredictor : public DuplicateFramePredictor {
+public:
+	bool ShouldCheck() const noexcept override;
+
+	void OnChecked(bool isDuplicate) noexcept override;
+
+	void OnSkipped() noexcept override;
+
+	float DuplicateProbability() const noexcept {
+		return _duplicateProbability;
+	}
+
+private:
+	// 初始时总是检查
+	float _duplicateProbability = 1.0f;
+	uint32_t _framesSinceCheck = 0;
+};
+
+}
@@ -87,6 +87,10 @@ bool DwmSharedSurfaceFrameSource::_Initialize() noexcept {
 	return true;
 }
 
+DwmSharedSurfaceFrameSource::~DwmSharedSurfaceFrameSource() {
+	Logger::Get().Info(fmt::format("共享纹理在 {} 帧中打开了 {} 次", _frameCount, _openCount));
+}
+
 FrameSourceState DwmSharedSurfaceFrameSource::_Update() noexcept {
 	HANDLE sharedTextureHandle = NULL;
 	if (!dwmGetDxSharedSurface(ScalingWindow::Get().HwndSrc(),
@@ -97,16 +101,28 @@ FrameSourceState DwmSharedSurfaceFrameSource::_Update() noexcept {
 		return FrameSourceState::Error;
 	}
 
-	winrt::com_ptr<ID3D11Texture2D> sharedTexture;
-	HRESULT hr = _deviceResources->GetD3DDevice()
-		->OpenSharedResource(sharedTextureHandle, IID_PPV_ARGS(&sharedTexture));
-	if (FAILED(hr)) {
-		Logger::Get().ComError("OpenSharedResource 失败", hr);
-		return FrameSourceState::Error;
+	if (sharedTextureHandle != _sharedTextureHandle) {
+		_sharedTexture = nullptr;
+		HRESULT hr = _deviceResources->GetD3DDevice()
+			->OpenSharedResource(sharedTextureHandle, IID_PPV_ARGS(&_sharedTexture));
+		if (FAILED(hr)) {
+			_sharedTextureHandle = NULL;
+			Logger::Get().ComError("OpenSharedResource 失败", hr);
+			return FrameSourceState::Error;
+		}
+
+		_sharedTextureHandle = sharedTextureHandle;
+		++_openCount;
+		if (_openCount > 1) {
+			Logger::Get().Info(fmt::format("共享纹理已改变，第 {} 帧时重新打开，共打开 {} 次",
+				_frameCount + 1, _openCount));
+		}
 	}
 
+	++_frameCount;
+
 	_deviceResources->GetD3DDC()->CopySubresourceRegion(
-		_output.get(), 0, 0, 0, 0, sharedTexture.get(), 0, &_frameInWnd);
+		_output.get(), 0, 0, 0, 0, _sharedTexture.get(), 0, &_frameInWnd);
 
 	return FrameSourceState::NewFrame;
 }
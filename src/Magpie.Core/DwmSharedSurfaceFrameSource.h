@@ -5,7 +5,7 @@ namespace Magpie {
 
 class DwmSharedSurfaceFrameSource final : public FrameSourceBase {
 public:
-	virtual ~DwmSharedSurfaceFrameSource() {}
+	virtual ~DwmSharedSurfaceFrameSource();
 
 	bool IsScreenCapture() const noexcept override {
 		return false;
@@ -34,6 +34,14 @@ protected:
 
 private:
 	D3D11_BOX _frameInWnd{};
+
+	// 共享纹理只在窗口的重定向表面改变时 (如尺寸或 DPI 变化) 才变化，因此缓存打开的纹理
+	HANDLE _sharedTextureHandle = NULL;
+	winrt::com_ptr<ID3D11Texture2D> _sharedTexture;
+
+	// 用于在日志中报告重新打开的频率
+	uint64_t _frameCount = 0;
+	uint32_t _openCount = 0;
 };
 
 }
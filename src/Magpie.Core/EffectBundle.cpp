@@ -0,0 +1,162 @@
+// 不使用预编译头，只能使用标准库
+#include "EffectBundle.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Magpie {
+
+static constexpr char MAGIC[4] = { 'M', 'P', 'F', 'B' };
+static constexpr uint32_t HEADER_SIZE = 16;
+static constexpr uint32_t INDEX_ENTRY_SIZE = 32;
+
+struct IndexEntry {
+	uint64_t hash;
+	uint32_t flags;
+	uint32_t nameOffset;
+	uint32_t nameSize;
+	uint32_t dataOffset;
+	uint32_t dataSize;
+	uint32_t reserved;
+};
+static_assert(sizeof(IndexEntry) == INDEX_ENTRY_SIZE);
+
+template <typename T>
+static T Read(const uint8_t* data) noexcept {
+	T result;
+	std::memcpy(&result, data, sizeof(T));
+	return result;
+}
+
+static IndexEntry ReadIndexEntry(std::span<const uint8_t> buf, uint32_t idx) noexcept {
+	return Read<IndexEntry>(buf.data() + HEADER_SIZE + (size_t)INDEX_ENTRY_SIZE * idx);
+}
+
+template <typename T>
+static void Append(std::vector<uint8_t>& buf, const T& value) noexcept {
+	const uint8_t* data = (const uint8_t*)&value;
+	buf.insert(buf.end(), data, data + sizeof(T));
+}
+
+bool EffectBundle::Write(std::vector<EffectBundleEntry>& entries, uint32_t cacheVersion, std::vector<uint8_t>& buf) noexcept {
+	std::sort(entries.begin(), entries.end(), [](const EffectBundleEntry& l, const EffectBundleEntry& r) {
+		return l.name != r.name ? l.name < r.name : l.flags < r.flags;
+	});
+
+	// 名称和标志不能重复，否则查找的结果不确定
+	if (std::adjacent_find(entries.begin(), entries.end(), [](const EffectBundleEntry& l, const EffectBundleEntry& r) {
+		return l.name == r.name && l.flags == r.flags;
+	}) != entries.end()) {
+		return false;
+	}
+
+	uint64_t offset = HEADER_SIZE + (uint64_t)INDEX_ENTRY_SIZE * entries.size();
+	std::vector<IndexEntry> index(entries.size());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		index[i].hash = entries[i].hash;
+		index[i].flags = entries[i].flags;
+		index[i].nameOffset = (uint32_t)offset;
+		index[i].nameSize = (uint32_t)entries[i].name.size();
+		offset += entries[i].name.size();
+	}
+	for (size_t i = 0; i < entries.size(); ++i) {
+		index[i].dataOffset = (uint32_t)offset;
+		index[i].dataSize = (uint32_t)entries[i].data.size();
+		offset += entries[i].data.size();
+	}
+
+	// 偏移使用 32 位
+	if (offset > UINT32_MAX) {
+		return false;
+	}
+
+	buf.clear();
+	buf.reserve((size_t)offset);
+	buf.insert(buf.end(), std::begin(MAGIC), std::end(MAGIC));
+	Append(buf, VERSION);
+	Append(buf, cacheVersion);
+	Append(buf, (uint32_t)entries.size());
+	for (const IndexEntry& entry : index) {
+		Append(buf, entry);
+	}
+	for (const EffectBundleEntry& entry : entries) {
+		buf.insert(buf.end(), entry.name.begin(), entry.name.end());
+	}
+	for (const EffectBundleEntry& entry : entries) {
+		buf.insert(buf.end(), entry.data.begin(), entry.data.end());
+	}
+
+	return true;
+}
+
+bool EffectBundle::Open(std::span<const uint8_t> buf, uint32_t cacheVersion) noexcept {
+	_buf = {};
+	_count = 0;
+
+	if (buf.size() < HEADER_SIZE || std::memcmp(buf.data(), MAGIC, sizeof(MAGIC)) != 0 ||
+		Read<uint32_t>(buf.data() + 4) != VERSION || Read<uint32_t>(buf.data() + 8) != cacheVersion) {
+		return false;
+	}
+
+	const uint32_t count = Read<uint32_t>(buf.data() + 12);
+	if (HEADER_SIZE + (uint64_t)INDEX_ENTRY_SIZE * count > buf.size()) {
+		return false;
+	}
+
+	// 检查所有条目都在范围内且已排序，查找时不再检查
+	for (uint32_t i = 0; i < count; ++i) {
+		const IndexEntry entry = ReadIndexEntry(buf, i);
+		if ((uint64_t)entry.nameOffset + entry.nameSize > buf.size() ||
+			(uint64_t)entry.dataOffset + entry.dataSize > buf.size()) {
+			return false;
+		}
+	}
+
+	_buf = buf;
+	_count = count;
+
+	for (uint32_t i = 1; i < count; ++i) {
+		const std::string_view prevName = _GetName(i - 1);
+		const std::string_view name = _GetName(i);
+		if (prevName > name || (prevName == name && ReadIndexEntry(_buf, i - 1).flags >= ReadIndexEntry(_buf, i).flags)) {
+			_buf = {};
+			_count = 0;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::span<const uint8_t> EffectBundle::Find(std::string_view name, uint32_t flags, uint64_t hash) const noexcept {
+	// 二分查找第一个不小于 (name, flags) 的条目
+	uint32_t low = 0;
+	uint32_t high = _count;
+	while (low < high) {
+		const uint32_t mid = low + (high - low) / 2;
+		const std::string_view midName = _GetName(mid);
+		const uint32_t midFlags = ReadIndexEntry(_buf, mid).flags;
+		if (midName < name || (midName == name && midFlags < flags)) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == _count) {
+		return {};
+	}
+
+	const IndexEntry entry = ReadIndexEntry(_buf, low);
+	if (_GetName(low) != name || entry.flags != flags || entry.hash != hash) {
+		return {};
+	}
+
+	return _buf.subspan(entry.dataOffset, entry.dataSize);
+}
+
+std::string_view EffectBundle::_GetName(uint32_t idx) const noexcept {
+	const IndexEntry entry = ReadIndexEntry(_buf, idx);
+	return std::string_view((const char*)_buf.data() + entry.nameOffset, entry.nameSize);
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Magpie {
+
+struct EffectBundleEntry {
+	// 同 EffectDesc::name
+	std::string name;
+	// EffectCompilerFlags 的低 16 位
+	uint32_t flags = 0;
+	// 缓存键的哈希
+	uint64_t hash = 0;
+	// EffectCacheSerializer 序列化的结果，缓存键为空
+	std::vector<uint8_t> data;
+};
+
+// 内置效果包: 构建时预先编译的所有内置效果，由 EffectCacheManager 映射到内存，作为用户缓存之下的只读缓存。
+// 所有整数为小端序:
+// 文件头: "MPFB" | 版本 (uint32) | 缓存版本 (uint32) | 条目数 (uint32)
+// 之后是按效果名和标志排序的索引，每项: 哈希 (uint64) | 标志 (uint32) | 名称偏移 (uint32) | 名称长度 (uint32)
+//   | 数据偏移 (uint32) | 数据长度 (uint32) | 保留 (uint32)
+// 偏移相对于文件开头。数据的格式同缓存文件，但缓存键为空，否则包中将包含每种标志下每个效果的源码。
+// 效果源码被修改后由哈希检测，不会误用。
+// 注意此头文件和 EffectBundle.cpp 只能使用标准库。
+class EffectBundle {
+public:
+	static constexpr uint32_t VERSION = 1;
+
+	// entries 将被排序，效果名和标志重复时失败
+	static bool Write(std::vector<EffectBundleEntry>& entries, uint32_t cacheVersion, std::vector<uint8_t>& buf) noexcept;
+
+	// buf 的生命周期应长于此对象。版本或缓存版本不同以及文件损坏时失败，此时此对象为空
+	bool Open(std::span<const uint8_t> buf, uint32_t cacheVersion) noexcept;
+
+	bool IsEmpty() const noexcept {
+		return _count == 0;
+	}
+
+	// 返回缓存数据，不存在或哈希不同时返回空
+	std::span<const uint8_t> Find(std::string_view name, uint32_t flags, uint64_t hash) const noexcept;
+
+private:
+	std::string_view _GetName(uint32_t idx) const noexcept;
+
+	std::span<const uint8_t> _buf;
+	uint32_t _count = 0;
+};
+
+}
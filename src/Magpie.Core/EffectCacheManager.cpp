@@ -3,82 +3,12 @@
 #include "StrHelper.h"
 #include "Logger.h"
 #include "CommonSharedConstants.h"
-#include <d3dcompiler.h>
-#include <rapidhash.h>
-#include "YasHelper.h"
-
-namespace yas::detail {
-
-// winrt::com_ptr<ID3DBlob>
-template <std::size_t F>
-struct serializer<
-	type_prop::not_a_fundamental,
-	ser_case::use_internal_serializer,
-	F,
-	winrt::com_ptr<ID3DBlob>
-> {
-	template <typename Archive>
-	static Archive& save(Archive& ar, const winrt::com_ptr<ID3DBlob>& blob) {
-		uint32_t size = (uint32_t)blob->GetBufferSize();
-		ar& size;
-
-		ar.write(blob->GetBufferPointer(), size);
-
-		return ar;
-	}
-
-	template <typename Archive>
-	static Archive& load(Archive& ar, winrt::com_ptr<ID3DBlob>& blob) {
-		uint32_t size = 0;
-		ar& size;
-		HRESULT hr = D3DCreateBlob(size, blob.put());
-		if (FAILED(hr)) {
-			Magpie::Logger::Get().ComError("D3DCreateBlob 失败", hr);
-			throw new std::exception();
-		}
-
-		ar.read(blob->GetBufferPointer(), size);
-
-		return ar;
-	}
-};
-
-}
+#include "EffectCacheSerializer.h"
 
 namespace Magpie {
 
-template <typename Archive>
-void serialize(Archive& ar, EffectParameterDesc& o) {
-	ar& o.name& o.label& o.constant;
-}
-
-template <typename Archive>
-void serialize(Archive& ar, EffectIntermediateTextureDesc& o) {
-	ar& o.format& o.name& o.source& o.sizeExpr;
-}
-
-template <typename Archive>
-void serialize(Archive& ar, EffectSamplerDesc& o) {
-	ar& o.filterType& o.addressType& o.name;
-}
-
-template <typename Archive>
-void serialize(Archive& ar, EffectPassDesc& o) {
-	ar& o.cso& o.inputs& o.outputs& o.numThreads[0] & o.numThreads[1] & o.numThreads[2] & o.blockSize& o.desc& o.flags;
-}
-
-template <typename Archive>
-void serialize(Archive& ar, EffectDesc& o) {
-	ar& o.name& o.params& o.textures& o.samplers& o.passes& o.flags;
-}
-
 static constexpr uint32_t MAX_CACHE_COUNT = 127;
 
-// 缓存版本
-// 当缓存文件结构有更改时更新它，使旧缓存失效
-static constexpr uint32_t EFFECT_CACHE_VERSION = 15;
-
-
 static std::wstring GetLinearEffectName(std::wstring_view effectName) {
 	std::wstring result(effectName);
 	for (wchar_t& c : result) {
@@ -148,21 +78,41 @@ bool EffectCacheManager::_LoadFromMemCache(const std::wstring& cacheFileName, st
 	return false;
 }
 
-bool EffectCacheManager::Load(
-	std::wstring_view effectName,
-	uint32_t flags,
-	uint64_t hash,
-	std::string_view key,
-	EffectDesc& desc
-) {
-	assert(!effectName.empty() && !key.empty());
+EffectCacheManager::EffectCacheManager() noexcept {
+	// 内置效果包是可选的，找不到时所有效果在运行时编译
+	_hBundleFile.reset(CreateFile(CommonSharedConstants::BUILTIN_EFFECTS_BUNDLE_PATH,
+		GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+	if (!_hBundleFile) {
+		return;
+	}
 
-	std::wstring cacheFileName = GetCacheFileName(GetLinearEffectName(effectName), flags, hash);
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(_hBundleFile.get(), &fileSize) || fileSize.QuadPart == 0) {
+		return;
+	}
 
-	if (_LoadFromMemCache(cacheFileName, key, desc)) {
-		return true;
+	_hBundleMapping.reset(CreateFileMapping(_hBundleFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+	if (!_hBundleMapping) {
+		Logger::Get().Win32Error("CreateFileMapping 失败");
+		return;
 	}
 
+	_bundleView.reset((uint8_t*)MapViewOfFile(_hBundleMapping.get(), FILE_MAP_READ, 0, 0, 0));
+	if (!_bundleView) {
+		Logger::Get().Win32Error("MapViewOfFile 失败");
+		return;
+	}
+
+	if (!_bundle.Open({ _bundleView.get(), (size_t)fileSize.QuadPart }, EffectCacheSerializer::VERSION)) {
+		// 通常是因为缓存版本不匹配
+		Logger::Get().Info("内置效果包无效或版本不匹配，将忽略它");
+		return;
+	}
+
+	Logger::Get().Info("已加载内置效果包");
+}
+
+bool EffectCacheManager::_LoadFromFile(const std::wstring& cacheFileName, std::string_view key, EffectDesc& desc) {
 	if (!Win32Helper::FileExists(cacheFileName.c_str())) {
 		return false;
 	}
@@ -172,34 +122,75 @@ bool EffectCacheManager::Load(
 		return false;
 	}
 
-	std::string cachedKey;
-	try {
-		yas::mem_istream mi(buf.data(), buf.size());
-		yas::binary_iarchive<yas::mem_istream, yas::binary> ia(mi);
+	switch (EffectCacheSerializer::Load(buf, key, desc)) {
+	case EffectCacheLoadResult::Success:
+		break;
+	case EffectCacheLoadResult::VersionMismatch:
+		Logger::Get().Info("缓存版本不匹配");
+		return false;
+	case EffectCacheLoadResult::KeyMismatch:
+		Logger::Get().Info("缓存键不匹配");
+		return false;
+	default:
+		Logger::Get().Error("反序列化失败");
+		return false;
+	}
 
-		uint32_t cacheVersion;
-		ia.read(cacheVersion);
-		if (cacheVersion != EFFECT_CACHE_VERSION) {
-			Logger::Get().Info("缓存版本不匹配");
-			return false;
-		}
-		
-		ia& cachedKey;
-		if (cachedKey != key) {
-			Logger::Get().Info("缓存键不匹配");
-			return false;
-		}
+	Logger::Get().Info(StrHelper::Concat("已读取缓存 ", StrHelper::UTF16ToUTF8(cacheFileName)));
+	return true;
+}
 
-		ia& desc;
-	} catch (...) {
-		Logger::Get().Error("反序列化失败");
+bool EffectCacheManager::_LoadFromBundle(
+	std::wstring_view effectName,
+	uint32_t flags,
+	uint64_t hash,
+	EffectDesc& desc
+) {
+	if (_bundle.IsEmpty()) {
+		return false;
+	}
+
+	const std::string name = StrHelper::UTF16ToUTF8(effectName);
+
+	// 哈希不同说明源码或内联参数和构建时不同，需要在运行时编译
+	std::span<const uint8_t> data = _bundle.Find(name, flags, hash);
+	if (data.empty()) {
+		return false;
+	}
+
+	// 包中的缓存键为空，只通过哈希检查源码
+	if (EffectCacheSerializer::Load(data, {}, desc) != EffectCacheLoadResult::Success) {
 		desc = {};
+		Logger::Get().Error(StrHelper::Concat("读取内置效果包中的 ", name, " 失败"));
 		return false;
 	}
 
-	_AddToMemCache(cacheFileName, cachedKey, desc);
+	Logger::Get().Info(StrHelper::Concat("已从内置效果包读取 ", name));
+	return true;
+}
 
-	Logger::Get().Info(StrHelper::Concat("已读取缓存 ", StrHelper::UTF16ToUTF8(cacheFileName)));
+bool EffectCacheManager::Load(
+	std::wstring_view effectName,
+	uint32_t flags,
+	uint64_t hash,
+	std::string_view key,
+	EffectDesc& desc
+) {
+	assert(!effectName.empty() && !key.empty());
+
+	std::wstring cacheFileName = GetCacheFileName(GetLinearEffectName(effectName), flags, hash);
+
+	if (_LoadFromMemCache(cacheFileName, key, desc)) {
+		return true;
+	}
+
+	// 用户缓存优先，其次是内置效果包
+	if (!_LoadFromFile(cacheFileName, key, desc) && !_LoadFromBundle(effectName, flags, hash, desc)) {
+		return false;
+	}
+
+	std::string cachedKey(key);
+	_AddToMemCache(cacheFileName, cachedKey, desc);
 	return true;
 }
 
@@ -212,16 +203,8 @@ void EffectCacheManager::Save(
 ) {
 	const std::wstring linearEffectName = GetLinearEffectName(effectName);
 
-	std::vector<BYTE> buf;
-	buf.reserve(4096);
-
-	try {
-		yas::vector_ostream os(buf);
-		yas::binary_oarchive<yas::vector_ostream<BYTE>, yas::binary> oa(os);
-
-		oa.write(EFFECT_CACHE_VERSION);
-		oa& key& desc;
-	} catch (...) {
+	std::vector<uint8_t> buf;
+	if (!EffectCacheSerializer::Save(key, desc, buf)) {
 		Logger::Get().Error("序列化 EffectDesc 失败");
 		return;
 	}
@@ -303,7 +286,7 @@ void EffectCacheManager::Save(
 }
 
 uint64_t EffectCacheManager::GetHash(std::string_view key) {
-	return rapidhash(key.data(), key.size());
+	return EffectCacheSerializer::GetHash(key);
 }
 
 }
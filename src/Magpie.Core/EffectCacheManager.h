@@ -1,6 +1,7 @@
 #pragma once
 #include "Win32Helper.h"
 #include "EffectDesc.h"
+#include "EffectBundle.h"
 #include <parallel_hashmap/phmap.h>
 
 namespace Magpie {
@@ -22,7 +23,10 @@ public:
 	static uint64_t GetHash(std::string_view key);
 
 private:
-	EffectCacheManager() = default;
+	EffectCacheManager() noexcept;
+
+	bool _LoadFromFile(const std::wstring& cacheFileName, std::string_view key, EffectDesc& desc);
+	bool _LoadFromBundle(std::wstring_view effectName, uint32_t flags, uint64_t hash, EffectDesc& desc);
 
 	void _AddToMemCache(const std::wstring& cacheFileName, std::string& key, const EffectDesc& desc);
 	bool _LoadFromMemCache(const std::wstring& cacheFileName, std::string_view key, EffectDesc& desc);
@@ -38,6 +42,12 @@ private:
 	phmap::flat_hash_map<std::wstring, _MemCacheItem> _memCache;
 
 	UINT _lastAccess = 0;
+
+	// 内置效果包映射到内存，初始化后只读，不需要同步
+	wil::unique_hfile _hBundleFile;
+	wil::unique_handle _hBundleMapping;
+	wil::unique_mapview_ptr<uint8_t> _bundleView;
+	EffectBundle _bundle;
 };
 
 }
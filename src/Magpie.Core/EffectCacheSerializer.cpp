@@ -0,0 +1,110 @@
+// 不使用预编译头，只能使用标准库和头文件库
+#include "EffectCacheSerializer.h"
+#include <algorithm>
+#include <cmath>
+#include <rapidhash.h>
+#include "YasHelper.h"
+
+namespace Magpie {
+
+template <typename Archive>
+void serialize(Archive& ar, EffectParameterDesc& o) {
+	ar& o.name& o.label& o.constant;
+}
+
+template <typename Archive>
+void serialize(Archive& ar, EffectIntermediateTextureDesc& o) {
+	ar& o.format& o.name& o.source& o.sizeExpr;
+}
+
+template <typename Archive>
+void serialize(Archive& ar, EffectSamplerDesc& o) {
+	ar& o.filterType& o.addressType& o.name;
+}
+
+template <typename Archive>
+void serialize(Archive& ar, EffectPassDesc& o) {
+	ar& o.cso& o.inputs& o.outputs& o.numThreads[0] & o.numThreads[1] & o.numThreads[2] & o.blockSize& o.desc& o.flags& o.sampleRadius;
+}
+
+template <typename Archive>
+void serialize(Archive& ar, EffectDesc& o) {
+	ar& o.name& o.params& o.textures& o.samplers& o.passes& o.flags;
+}
+
+bool EffectCacheSerializer::Save(std::string_view key, const EffectDesc& desc, std::vector<uint8_t>& buf) noexcept {
+	buf.clear();
+	buf.reserve(4096);
+
+	try {
+		yas::vector_ostream os(buf);
+		yas::binary_oarchive<yas::vector_ostream<uint8_t>, yas::binary> oa(os);
+
+		oa.write(VERSION);
+		oa& key& desc;
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
+EffectCacheLoadResult EffectCacheSerializer::Load(std::span<const uint8_t> buf, std::string_view key, EffectDesc& desc) noexcept {
+	try {
+		yas::mem_istream mi(buf.data(), buf.size());
+		yas::binary_iarchive<yas::mem_istream, yas::binary> ia(mi);
+
+		uint32_t cacheVersion;
+		ia.read(cacheVersion);
+		if (cacheVersion != VERSION) {
+			return EffectCacheLoadResult::VersionMismatch;
+		}
+
+		std::string cachedKey;
+		ia& cachedKey;
+		if (cachedKey != key) {
+			return EffectCacheLoadResult::KeyMismatch;
+		}
+
+		ia& desc;
+	} catch (...) {
+		desc = {};
+		return EffectCacheLoadResult::Corrupted;
+	}
+
+	return EffectCacheLoadResult::Success;
+}
+
+std::string EffectCacheSerializer::GetKey(
+	std::string_view source,
+	const std::vector<std::pair<std::string, float>>* inlineParams
+) noexcept {
+	std::string key;
+	key.reserve(source.size() + 256);
+	key.append(source);
+
+	if (inlineParams) {
+		std::vector<const std::pair<std::string, float>*> sortedParams;
+		sortedParams.reserve(inlineParams->size());
+		for (const auto& pair : *inlineParams) {
+			sortedParams.push_back(&pair);
+		}
+		std::sort(sortedParams.begin(), sortedParams.end(),
+			[](const auto* l, const auto* r) { return l->first < r->first; });
+
+		for (const auto* pair : sortedParams) {
+			key.append(pair->first);
+			key.push_back('=');
+			key.append(std::to_string(std::lroundf(pair->second * 10000)));
+			key.push_back('\n');
+		}
+	}
+
+	return key;
+}
+
+uint64_t EffectCacheSerializer::GetHash(std::string_view key) noexcept {
+	return rapidhash(key.data(), key.size());
+}
+
+}
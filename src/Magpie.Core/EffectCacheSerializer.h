@@ -0,0 +1,34 @@
+#pragma once
+#include "EffectDesc.h"
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Magpie {
+
+enum class EffectCacheLoadResult {
+	Success,
+	VersionMismatch,
+	KeyMismatch,
+	Corrupted
+};
+
+// 效果缓存的文件格式。不依赖 Windows，离线工具生成的缓存可以直接被 EffectCacheManager 读取
+struct EffectCacheSerializer {
+	// 缓存版本
+	// 当缓存文件结构有更改时更新它，使旧缓存失效
+	static constexpr uint32_t VERSION = 17;
+
+	static bool Save(std::string_view key, const EffectDesc& desc, std::vector<uint8_t>& buf) noexcept;
+
+	// key 用于防止哈希碰撞，和缓存中的不同时失败
+	static EffectCacheLoadResult Load(std::span<const uint8_t> buf, std::string_view key, EffectDesc& desc) noexcept;
+
+	// 缓存键由移除注释后的源码和内联参数组成。内联参数按名称排序，离线工具可以生成相同的键
+	static std::string GetKey(std::string_view source, const std::vector<std::pair<std::string, float>>* inlineParams) noexcept;
+
+	// 缓存文件名中的哈希
+	static uint64_t GetHash(std::string_view key) noexcept;
+};
+
+}
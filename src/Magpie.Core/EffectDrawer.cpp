@@ -90,6 +90,7 @@ bool EffectDrawer::Initialize(
 	BackendDescriptorStore& descriptorStore,
 	ID3D11Texture2D** inOutTexture
 ) noexcept {
+	_d3dDevice = deviceResources.GetD3DDevice();
 	_d3dDC = deviceResources.GetD3DDC();
 
 	SIZE inputSize{};
@@ -135,7 +136,7 @@ bool EffectDrawer::Initialize(
 	// 创建输出纹理，格式始终是 DXGI_FORMAT_R8G8B8A8_UNORM
 	_textures[1] = DirectXHelper::CreateTexture2D(
 		deviceResources.GetD3DDevice(),
-		EffectHelper::FORMAT_DESCS[(uint32_t)desc.textures[1].format].dxgiFormat,
+		EffectHelper::DXGI_FORMATS[(uint32_t)desc.textures[1].format],
 		outputSize.cx,
 		outputSize.cy,
 		D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS
@@ -167,7 +168,7 @@ bool EffectDrawer::Initialize(
 				// 检查纹理格式是否匹配
 				D3D11_TEXTURE2D_DESC srcDesc{};
 				_textures[i]->GetDesc(&srcDesc);
-				if (srcDesc.Format != EffectHelper::FORMAT_DESCS[(uint32_t)texDesc.format].dxgiFormat) {
+				if (srcDesc.Format != EffectHelper::DXGI_FORMATS[(uint32_t)texDesc.format]) {
 					Logger::Get().Error("SOURCE 纹理格式不匹配");
 					return false;
 				}
@@ -192,7 +193,7 @@ bool EffectDrawer::Initialize(
 
 			_textures[i] = DirectXHelper::CreateTexture2D(
 				deviceResources.GetD3DDevice(),
-				EffectHelper::FORMAT_DESCS[(UINT)texDesc.format].dxgiFormat,
+				EffectHelper::DXGI_FORMATS[(UINT)texDesc.format],
 				texSize.cx,
 				texSize.cy,
 				D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS
@@ -211,7 +212,7 @@ bool EffectDrawer::Initialize(
 		const EffectPassDesc& passDesc = desc.passes[i];
 
 		HRESULT hr = deviceResources.GetD3DDevice()->CreateComputeShader(
-			passDesc.cso->GetBufferPointer(), passDesc.cso->GetBufferSize(), nullptr, _shaders[i].put());
+			passDesc.cso.data(), passDesc.cso.size(), nullptr, _shaders[i].put());
 		if (FAILED(hr)) {
 			Logger::Get().ComError("创建计算着色器失败", hr);
 			return false;
@@ -224,6 +225,10 @@ bool EffectDrawer::Initialize(
 				Logger::Get().Error("GetShaderResourceView 失败");
 				return false;
 			}
+
+			if (passDesc.inputs[j] == 0) {
+				_inputSrvSlots.emplace_back(i, j);
+			}
 		}
 
 		_uavs[i].resize(passDesc.outputs.size() * 2);
@@ -234,13 +239,11 @@ bool EffectDrawer::Initialize(
 				return false;
 			}
 		}
+	}
 
-		D3D11_TEXTURE2D_DESC outputDesc;
-		_textures[passDesc.outputs[0]]->GetDesc(&outputDesc);
-		_dispatches.emplace_back(
-			(outputDesc.Width + passDesc.blockSize.first - 1) / passDesc.blockSize.first,
-			(outputDesc.Height + passDesc.blockSize.second - 1) / passDesc.blockSize.second
-		);
+	if (!_InitializeDirtyRegionPlanner(desc, deviceResources)) {
+		Logger::Get().Error("_InitializeDirtyRegionPlanner 失败");
+		return false;
 	}
 
 	if (!_InitializeConstants(desc, option, deviceResources, inputSize, outputSize)) {
@@ -251,27 +254,127 @@ bool EffectDrawer::Initialize(
 	return true;
 }
 
-void EffectDrawer::Draw(EffectsProfiler& profiler) const noexcept {
+void EffectDrawer::Draw(EffectsProfiler& profiler, const DirtyRegion& inputRegion, DirtyRegion& outputRegion) noexcept {
 	{
 		ID3D11Buffer* t = _constantBuffer.get();
 		_d3dDC->CSSetConstantBuffers(0, 1, &t);
 	}
+	if (ID3D11Buffer* t = _dispatchOffsetCB.get()) {
+		_d3dDC->CSSetConstantBuffers(2, 1, &t);
+	}
 	_d3dDC->CSSetSamplers(0, (UINT)_samplers.size(), _samplers.data());
 
-	for (uint32_t i = 0; i < _dispatches.size(); ++i) {
+	_dirtyRegionPlanner.Plan(inputRegion, outputRegion);
+
+	for (uint32_t i = 0; i < _shaders.size(); ++i) {
 		_DrawPass(i);
 		profiler.OnEndPass(_d3dDC);
 	}
 }
 
-void EffectDrawer::_DrawPass(uint32_t i) const noexcept {
+bool EffectDrawer::_InitializeDirtyRegionPlanner(const EffectDesc& desc, DeviceResources& deviceResources) noexcept {
+	for (size_t i = 0; i < _textures.size(); ++i) {
+		D3D11_TEXTURE2D_DESC texDesc;
+		_textures[i]->GetDesc(&texDesc);
+		_dirtyRegionPlanner.AddTexture(texDesc.Width, texDesc.Height, !desc.textures[i].source.empty());
+	}
+
+	bool hasSampleRadius = false;
+	for (const EffectPassDesc& passDesc : desc.passes) {
+		// 使用帧数的通道每帧输出都可能不同
+		const int32_t sampleRadius = (passDesc.flags & EffectPassFlags::UseDynamic) ? -1 : passDesc.sampleRadius;
+		hasSampleRadius |= passDesc.sampleRadius >= 0;
+
+		_dirtyRegionPlanner.AddPass(
+			std::span(passDesc.inputs.data(), passDesc.inputs.size()),
+			std::span(passDesc.outputs.data(), passDesc.outputs.size()),
+			sampleRadius,
+			passDesc.blockSize.first,
+			passDesc.blockSize.second
+		);
+	}
+
+	if (!hasSampleRadius) {
+		return true;
+	}
+
+	// 大小必须为 16 的倍数
+	D3D11_BUFFER_DESC bd{
+		.ByteWidth = 16,
+		.Usage = D3D11_USAGE_DEFAULT,
+		.BindFlags = D3D11_BIND_CONSTANT_BUFFER
+	};
+	static constexpr uint32_t ZERO[4]{};
+	D3D11_SUBRESOURCE_DATA initData{ .pSysMem = ZERO };
+	HRESULT hr = deviceResources.GetD3DDevice()->CreateBuffer(&bd, &initData, _dispatchOffsetCB.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateBuffer 失败", hr);
+		return false;
+	}
+
+	return true;
+}
+
+void EffectDrawer::SetInput(ID3D11Texture2D* input) noexcept {
+	if (_textures[0].get() == input) {
+		return;
+	}
+
+	ID3D11ShaderResourceView* srv = nullptr;
+	for (const auto& [texture, view] : _inputSrvCache) {
+		if (texture.get() == input) {
+			srv = view.get();
+			break;
+		}
+	}
+
+	if (!srv) {
+		winrt::com_ptr<ID3D11ShaderResourceView> newSrv;
+		HRESULT hr = _d3dDevice->CreateShaderResourceView(input, nullptr, newSrv.put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateShaderResourceView 失败", hr);
+			return;
+		}
+
+		// 被移除的视图不是当前的输入，当前的输入在下面被替换
+		if (_inputSrvCache.size() == INPUT_SRV_CACHE_SIZE) {
+			_inputSrvCache.erase(_inputSrvCache.begin());
+		}
+
+		srv = newSrv.get();
+		winrt::com_ptr<ID3D11Texture2D> texture;
+		texture.copy_from(input);
+		_inputSrvCache.emplace_back(std::move(texture), std::move(newSrv));
+	}
+
+	for (const auto& [passIdx, slot] : _inputSrvSlots) {
+		_srvs[passIdx][slot] = srv;
+	}
+	_textures[0].copy_from(input);
+}
+
+void EffectDrawer::_DrawPass(uint32_t i) noexcept {
+	const std::span<const DirtyDispatch> dispatches = _dirtyRegionPlanner.PassDispatches(i);
+	if (dispatches.empty()) {
+		// 输入没有变化
+		return;
+	}
+
 	_d3dDC->CSSetShader(_shaders[i].get(), nullptr, 0);
 
 	_d3dDC->CSSetShaderResources(0, (UINT)_srvs[i].size(), _srvs[i].data());
 	UINT uavCount = (UINT)_uavs[i].size() / 2;
 	_d3dDC->CSSetUnorderedAccessViews(0, uavCount, _uavs[i].data(), nullptr);
 
-	_d3dDC->Dispatch(_dispatches[i].first, _dispatches[i].second, 1);
+	for (const DirtyDispatch& dispatch : dispatches) {
+		if (_dispatchOffsetCB && (dispatch.x != _dispatchOffset.first || dispatch.y != _dispatchOffset.second)) {
+			_dispatchOffset = { dispatch.x, dispatch.y };
+			const uint32_t data[4]{ dispatch.x, dispatch.y };
+			_d3dDC->UpdateSubresource(_dispatchOffsetCB.get(), 0, nullptr, data, 0, 0);
+		}
+
+		_d3dDC->Dispatch(dispatch.width, dispatch.height, 1);
+	}
 
 	_d3dDC->CSSetUnorderedAccessViews(0, uavCount, _uavs[i].data() + uavCount, nullptr);
 }
@@ -2,6 +2,7 @@
 #include "EffectDesc.h"
 #include "SmallVector.h"
 #include "EffectHelper.h"
+#include "DirtyRegionPlanner.h"
 
 namespace Magpie {
 
@@ -24,7 +25,11 @@ public:
 		ID3D11Texture2D** inOutTexture
 	) noexcept;
 
-	void Draw(EffectsProfiler& profiler) const noexcept;
+	// 更换输入纹理，尺寸和格式必须和初始化时相同。用于零复制捕获，这时每帧的输入纹理可能不同
+	void SetInput(ID3D11Texture2D* input) noexcept;
+
+	// inputRegion 为输入自上一帧以来变化的区域，只渲染受影响的部分，outputRegion 返回输出变化的区域
+	void Draw(EffectsProfiler& profiler, const DirtyRegion& inputRegion, DirtyRegion& outputRegion) noexcept;
 
 private:
 	bool _InitializeConstants(
@@ -35,13 +40,24 @@ private:
 		SIZE outputSize
 	) noexcept;
 
-	void _DrawPass(uint32_t i) const noexcept;
+	bool _InitializeDirtyRegionPlanner(const EffectDesc& desc, DeviceResources& deviceResources) noexcept;
+
+	void _DrawPass(uint32_t i) noexcept;
+
+	// 帧缓冲池中的纹理不多，缓存它们的视图
+	static constexpr uint32_t INPUT_SRV_CACHE_SIZE = 4;
 
+	ID3D11Device* _d3dDevice = nullptr;
 	ID3D11DeviceContext* _d3dDC = nullptr;
 
 	SmallVector<ID3D11SamplerState*> _samplers;
 	SmallVector<winrt::com_ptr<ID3D11Texture2D>> _textures;
 	std::vector<SmallVector<ID3D11ShaderResourceView*>> _srvs;
+	// INPUT 在 _srvs 中的位置: (通道, 槽)
+	SmallVector<std::pair<uint32_t, uint32_t>> _inputSrvSlots;
+	// SetInput 创建的视图，按创建顺序排列
+	SmallVector<std::pair<winrt::com_ptr<ID3D11Texture2D>, winrt::com_ptr<ID3D11ShaderResourceView>>,
+		INPUT_SRV_CACHE_SIZE> _inputSrvCache;
 	// 后半部分为空，用于解绑
 	std::vector<SmallVector<ID3D11UnorderedAccessView*>> _uavs;
 
@@ -50,7 +66,11 @@ private:
 
 	SmallVector<winrt::com_ptr<ID3D11ComputeShader>> _shaders;
 
-	SmallVector<std::pair<uint32_t, uint32_t>> _dispatches;
+	// 只渲染变化的区域，也决定每个通道的 Dispatch
+	DirtyRegionPlanner _dirtyRegionPlanner;
+	// cbuffer __CB3 : register(b2) { uint2 __dispatchOffset; };
+	winrt::com_ptr<ID3D11Buffer> _dispatchOffsetCB;
+	std::pair<uint32_t, uint32_t> _dispatchOffset{};
 };
 
 }
@@ -0,0 +1,60 @@
+#pragma once
+#include "EffectDesc.h"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Magpie {
+
+// 解析和生成代码时产生的消息，由调用者决定如何输出
+struct EffectParserLog {
+	std::vector<std::string> warnings;
+	// 失败的原因
+	std::string error;
+};
+
+// 源码中生成通道代码所需的部分，引用移除注释后的源码，源码的生命周期应长于此结构
+struct EffectSourceBlocks {
+	SmallVector<std::string_view> commonBlocks;
+	// 已按通道序号排序
+	SmallVector<std::string_view> passBlocks;
+};
+
+// MagpieFX 的前端: 解析效果和生成每个通道的 HLSL。不依赖 Windows 和 Direct3D，
+// 编译着色器由 EffectShaderCompiler 的实现完成。
+struct EffectParser {
+	// 移除注释，失败返回非 0
+	static uint32_t RemoveComments(std::string& source) noexcept;
+
+	// 解析移除注释后的源码，调用者需填入 desc 中的 name 和 flags。flags 为 EffectCompilerFlags，
+	// 含 NoCompile 时只解析输出尺寸和参数。成功返回 0，不是 MagpieFX 文件时返回 2
+	static uint32_t Parse(
+		std::string_view source,
+		uint32_t flags,
+		EffectDesc& desc,
+		EffectSourceBlocks& blocks,
+		EffectParserLog& log
+	) noexcept;
+
+	// 生成所有通道共用的常量缓冲区。desc 含 EffectFlags::InlineParams 时参数以常量内联，
+	// 未在 inlineParams 中的参数使用默认值，inlineParams 含未知参数时失败
+	static uint32_t GenerateConstantBuffer(
+		const EffectDesc& desc,
+		const std::vector<std::pair<std::string, float>>* inlineParams,
+		std::string& cbHlsl,
+		EffectParserLog& log
+	) noexcept;
+
+	// 生成第 passIdx 个通道 (从 1 开始) 的 HLSL，macros 为编译时需定义的宏
+	static void GeneratePassSource(
+		const EffectDesc& desc,
+		uint32_t passIdx,
+		std::string_view cbHlsl,
+		const EffectSourceBlocks& blocks,
+		std::string& result,
+		std::vector<std::pair<std::string, std::string>>& macros
+	) noexcept;
+};
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Magpie {
+
+// 将 EffectParser 生成的通道源码编译为计算着色器字节码，入口点为 __M。
+// EffectCompiler 使用 D3DCompile 实现，离线工具可以提供其他实现。
+// 可能在多个线程中同时调用。
+class EffectShaderCompiler {
+public:
+	virtual ~EffectShaderCompiler() = default;
+
+	// sourceName 用于错误消息，#include 相对于效果所在的文件夹解析
+	virtual bool CompilePass(
+		std::string_view hlsl,
+		std::string_view sourceName,
+		const std::vector<std::pair<std::string, std::string>>& macros,
+		std::vector<uint8_t>& bytecode
+	) noexcept = 0;
+};
+
+}
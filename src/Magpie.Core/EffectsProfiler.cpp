@@ -2,97 +2,208 @@
 #include "EffectsProfiler.h"
 #include "DeviceResources.h"
 
+using namespace std::chrono;
+
 namespace Magpie {
 
-void EffectsProfiler::Start(ID3D11Device* d3dDevice, uint32_t passCount) {
-	assert(_passQueries.empty());
-	_passQueries.resize(passCount);
+void EffectsProfiler::Start(ID3D11Device* d3dDevice, uint32_t passCount, uint32_t statisticsWindow) {
+	assert(_passCount == 0 && passCount > 0);
+	_passCount = passCount;
+
+	D3D11_QUERY_DESC disjointDesc{ .Query = D3D11_QUERY_TIMESTAMP_DISJOINT };
+	D3D11_QUERY_DESC timestampDesc{ .Query = D3D11_QUERY_TIMESTAMP };
+	for (_QuerySet& querySet : _querySets) {
+		d3dDevice->CreateQuery(&disjointDesc, querySet.disjointQuery.put());
+		d3dDevice->CreateQuery(&timestampDesc, querySet.startQuery.put());
 
-	D3D11_QUERY_DESC desc{ .Query = D3D11_QUERY_TIMESTAMP_DISJOINT };
-	d3dDevice->CreateQuery(&desc, _disjointQuery.put());
+		querySet.passQueries.resize(passCount);
+		for (winrt::com_ptr<ID3D11Query>& query : querySet.passQueries) {
+			d3dDevice->CreateQuery(&timestampDesc, query.put());
+		}
+	}
 
-	desc.Query = D3D11_QUERY_TIMESTAMP;
-	d3dDevice->CreateQuery(&desc, _startQuery.put());
-	for (winrt::com_ptr<ID3D11Query>& query : _passQueries) {
-		d3dDevice->CreateQuery(&desc, query.put());
+	// 重新开始统计，停止期间的数据已经过时
+	_passTimings.resize(passCount);
+	_passStatistics.resize(passCount);
+	for (TimingStatistics& statistics : _passStatistics) {
+		statistics.Initialize(statisticsWindow);
+	}
+	_lastPublishTime = {};
+	_hasNewSamples = false;
+
+	// 通道数在缩放期间不会改变，因此只在第一次启动时分配内存。前端线程可能正在读取缓冲区，
+	// 再次启动时不能重新分配。
+	for (SmallVector<TimingStatistics::Summary>& summaries : _statisticsBuffers) {
+		if (summaries.empty()) {
+			summaries.resize(passCount);
+		}
+		assert(summaries.size() == passCount);
 	}
 }
 
 void EffectsProfiler::Stop() {
-	_disjointQuery = nullptr;
-	_startQuery = nullptr;
-	_passQueries.clear();
+	for (_QuerySet& querySet : _querySets) {
+		querySet.disjointQuery = nullptr;
+		querySet.startQuery = nullptr;
+		querySet.passQueries.clear();
+		querySet.isPending = false;
+	}
+
+	_writeIdx = 0;
+	_readIdx = 0;
+	_passCount = 0;
+	_isMeasuring = false;
 }
 
-void EffectsProfiler::OnBeginEffects(ID3D11DeviceContext* d3dDC) {
-	if (_passQueries.empty()) {
+void EffectsProfiler::OnBeginEffects(ID3D11DeviceContext* d3dDC, uint64_t frameId) {
+	if (_passCount == 0) {
 		return;
 	}
 
-	d3dDC->Begin(_disjointQuery.get());
-	d3dDC->End(_startQuery.get());
+	_QuerySet& querySet = _querySets[_writeIdx];
+	if (querySet.isPending) {
+		// 所有查询都在使用中，先尝试取回最早的查询
+		QueryTimings(d3dDC);
+
+		if (querySet.isPending) {
+			// GPU 落后太多，为了不阻塞跳过这一帧
+			_isMeasuring = false;
+			return;
+		}
+	}
+
+	_isMeasuring = true;
+	querySet.frameId = frameId;
+	d3dDC->Begin(querySet.disjointQuery.get());
+	d3dDC->End(querySet.startQuery.get());
 
 	_curPass = 0;
 }
 
 void EffectsProfiler::OnEndPass(ID3D11DeviceContext* d3dDC) {
-	if (_passQueries.empty()) {
+	if (!_isMeasuring) {
 		return;
 	}
 
-	d3dDC->End(_passQueries[_curPass++].get());
+	d3dDC->End(_querySets[_writeIdx].passQueries[_curPass++].get());
 }
 
 void EffectsProfiler::OnEndEffects(ID3D11DeviceContext* d3dDC) {
-	if (_passQueries.empty()) {
+	if (!_isMeasuring) {
 		return;
 	}
 
-	d3dDC->End(_disjointQuery.get());
+	_QuerySet& querySet = _querySets[_writeIdx];
+	d3dDC->End(querySet.disjointQuery.get());
+	querySet.isPending = true;
+
+	_writeIdx = (_writeIdx + 1) % QUERY_SET_COUNT;
+	_isMeasuring = false;
 }
 
 template <typename T>
-static T GetQueryData(ID3D11DeviceContext* d3dDC, ID3D11Query* query) noexcept {
-	T data{};
-	while (d3dDC->GetData(query, &data, sizeof(data), 0) != S_OK) {
-		Sleep(0);
-	}
-	return data;
+static bool TryGetQueryData(ID3D11DeviceContext* d3dDC, ID3D11Query* query, T& data) noexcept {
+	// 渲染每帧后都会调用 Flush，因此无需再次 Flush
+	return d3dDC->GetData(query, &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
 }
 
 void EffectsProfiler::QueryTimings(ID3D11DeviceContext* d3dDC) noexcept {
-	if (_passQueries.empty()) {
+	if (_passCount == 0) {
 		return;
 	}
 
-	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData =
-		GetQueryData<D3D11_QUERY_DATA_TIMESTAMP_DISJOINT>(d3dDC, _disjointQuery.get());
+	// 按提交顺序取回，遇到未完成的查询则停止
+	while (_querySets[_readIdx].isPending) {
+		_QuerySet& querySet = _querySets[_readIdx];
+
+		D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+		if (!TryGetQueryData(d3dDC, querySet.disjointQuery.get(), disjointData)) {
+			break;
+		}
 
-	if (disjointData.Disjoint) {
+		if (!disjointData.Disjoint) {
+			if (!_TryReadQuerySet(d3dDC, querySet, 1000.0f / disjointData.Frequency)) {
+				break;
+			}
+
+			_AddSamples();
+
+			if (_timingsCallback) {
+				_timingsCallback(querySet.frameId, { _passTimings.data(), _passTimings.size() });
+			}
+		}
+
+		querySet.isPending = false;
+		_readIdx = (_readIdx + 1) % QUERY_SET_COUNT;
+	}
+
+	if (!_hasNewSamples) {
 		return;
 	}
 
-	const float toMS = 1000.0f / disjointData.Frequency;
+	// 第一次取回结果时立即发布，之后每 PUBLISH_INTERVAL 发布一次
+	const steady_clock::time_point now = steady_clock::now();
+	if (_lastPublishTime == steady_clock::time_point{} || now - _lastPublishTime >= PUBLISH_INTERVAL) {
+		_lastPublishTime = now;
+		_PublishStatistics();
+	}
+}
 
-	uint64_t prevTimestamp = GetQueryData<uint64_t>(d3dDC, _startQuery.get());
+// 所有通道的时间戳都可用时将各通道的用时写入 _passTimings
+bool EffectsProfiler::_TryReadQuerySet(ID3D11DeviceContext* d3dDC, _QuerySet& querySet, float toMS) noexcept {
+	uint64_t prevTimestamp;
+	if (!TryGetQueryData(d3dDC, querySet.startQuery.get(), prevTimestamp)) {
+		return false;
+	}
 
-	auto lock = _timingsLock.lock_exclusive();
-	_timings.resize(_passQueries.size());
-	for (size_t i = 0; i < _passQueries.size(); ++i) {
-		uint64_t timestamp = GetQueryData<uint64_t>(d3dDC, _passQueries[i].get());
-		_timings[i] = (timestamp - prevTimestamp) * toMS;
+	for (uint32_t i = 0; i < _passCount; ++i) {
+		uint64_t timestamp;
+		if (!TryGetQueryData(d3dDC, querySet.passQueries[i].get(), timestamp)) {
+			return false;
+		}
 
+		_passTimings[i] = (timestamp - prevTimestamp) * toMS;
 		prevTimestamp = timestamp;
 	}
+
+	return true;
 }
 
-SmallVector<float> EffectsProfiler::GetTimings() noexcept {
-	auto lock = _timingsLock.lock_exclusive();
+void EffectsProfiler::_AddSamples() noexcept {
+	for (uint32_t i = 0; i < _passCount; ++i) {
+		// 有时会跳过某些效果的渲染，即渲染时间为 0，这时不应计入
+		if (_passTimings[i] > 1e-3f) {
+			_passStatistics[i].Add(_passTimings[i]);
+		}
+	}
+
+	_hasNewSamples = true;
+}
+
+void EffectsProfiler::_PublishStatistics() noexcept {
+	SmallVector<TimingStatistics::Summary>& summaries = _statisticsBuffers[_backIdx];
+	for (uint32_t i = 0; i < _passCount; ++i) {
+		summaries[i] = _passStatistics[i].Summarize();
+	}
+	_hasNewSamples = false;
+
+	// 交换后缓冲区和中间缓冲区
+	const uint8_t prevMiddle = _middleIdx.exchange(_backIdx | NEW_STATISTICS_FLAG, std::memory_order_acq_rel);
+	_backIdx = prevMiddle & ~NEW_STATISTICS_FLAG;
+}
+
+std::span<const TimingStatistics::Summary> EffectsProfiler::GetStatistics() noexcept {
+	if (!(_middleIdx.load(std::memory_order_relaxed) & NEW_STATISTICS_FLAG)) {
+		// 没有新的统计结果
+		return {};
+	}
+
+	// 交换前缓冲区和中间缓冲区
+	const uint8_t prevMiddle = _middleIdx.exchange(_frontIdx, std::memory_order_acq_rel);
+	_frontIdx = prevMiddle & ~NEW_STATISTICS_FLAG;
 
-	// 没有渲染新帧时 _timings 为空
-	SmallVector<float> result = std::move(_timings);
-	_timings.clear();
-	return result;
+	const SmallVector<TimingStatistics::Summary>& summaries = _statisticsBuffers[_frontIdx];
+	return { summaries.data(), summaries.size() };
 }
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "SmallVector.h"
 #include "Win32Helper.h"
+#include "TimingStatistics.h"
 
 namespace Magpie {
 
@@ -13,30 +14,80 @@ public:
 	EffectsProfiler(const EffectsProfiler&) = delete;
 	EffectsProfiler(EffectsProfiler&&) = delete;
 
-	void Start(ID3D11Device* d3dDevice, uint32_t passCount);
+	// statisticsWindow 为统计的帧数
+	void Start(ID3D11Device* d3dDevice, uint32_t passCount, uint32_t statisticsWindow);
 
 	void Stop();
 
-	void OnBeginEffects(ID3D11DeviceContext* d3dDC);
+	bool IsStarted() const noexcept {
+		return _passCount != 0;
+	}
+
+	// frameId 用于在取回结果时标识这一帧
+	void OnBeginEffects(ID3D11DeviceContext* d3dDC, uint64_t frameId = 0);
 
 	void OnEndPass(ID3D11DeviceContext* d3dDC);
 
 	void OnEndEffects(ID3D11DeviceContext* d3dDC);
 
+	// 取回已完成的查询，不会等待 GPU
 	void QueryTimings(ID3D11DeviceContext* d3dDC) noexcept;
 
-	// 从前端线程调用
-	SmallVector<float> GetTimings() noexcept;
+	// 每取回一帧的结果调用一次，参数为帧序号和各通道用时。只在后端线程调用
+	void SetTimingsCallback(std::function<void(uint64_t, std::span<const float>)> callback) noexcept {
+		_timingsCallback = std::move(callback);
+	}
+
+	// 从前端线程调用，返回各通道用时的统计。返回值在下次调用前有效，没有新的统计结果时为空
+	std::span<const TimingStatistics::Summary> GetStatistics() noexcept;
 
 private:
-	SmallVector<float> _timings;
-	wil::srwlock _timingsLock;
+	// 查询结果在数帧后才取回，因此需要多组查询轮流使用
+	static constexpr uint32_t QUERY_SET_COUNT = 4;
+
+	struct _QuerySet {
+		winrt::com_ptr<ID3D11Query> disjointQuery;
+		winrt::com_ptr<ID3D11Query> startQuery;
+		SmallVector<winrt::com_ptr<ID3D11Query>> passQueries;
+		uint64_t frameId = 0;
+		bool isPending = false;
+	};
+
+	// 统计结果的更新间隔
+	static constexpr std::chrono::milliseconds PUBLISH_INTERVAL{ 500 };
 
-	winrt::com_ptr<ID3D11Query> _disjointQuery;
-	winrt::com_ptr<ID3D11Query> _startQuery;
-	std::vector<winrt::com_ptr<ID3D11Query>> _passQueries;
+	bool _TryReadQuerySet(ID3D11DeviceContext* d3dDC, _QuerySet& querySet, float toMS) noexcept;
 
+	void _AddSamples() noexcept;
+
+	void _PublishStatistics() noexcept;
+
+	std::array<_QuerySet, QUERY_SET_COUNT> _querySets;
+	// 下一帧使用的查询
+	uint32_t _writeIdx = 0;
+	// 最早的未取回的查询
+	uint32_t _readIdx = 0;
+	uint32_t _passCount = 0;
 	uint32_t _curPass = 0;
+	// 所有查询都未完成时跳过这一帧的测量
+	bool _isMeasuring = false;
+
+	// 最近一次取回的各通道用时
+	SmallVector<float> _passTimings;
+	std::vector<TimingStatistics> _passStatistics;
+	std::chrono::steady_clock::time_point _lastPublishTime{};
+	bool _hasNewSamples = false;
+	std::function<void(uint64_t, std::span<const float>)> _timingsCallback;
+
+	// 三重缓冲，后端线程写入，前端线程读取，无需加锁
+	std::array<SmallVector<TimingStatistics::Summary>, 3> _statisticsBuffers;
+	// 只能由后端线程访问
+	uint8_t _backIdx = 0;
+	// 只能由前端线程访问
+	uint8_t _frontIdx = 1;
+	// 低两位为中间缓冲区的索引，NEW_STATISTICS_FLAG 表示中间缓冲区有新数据
+	static constexpr uint8_t NEW_STATISTICS_FLAG = 4;
+	std::atomic<uint8_t> _middleIdx = 2;
 };
 
 }
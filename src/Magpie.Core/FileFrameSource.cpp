@@ -0,0 +1,194 @@
+#include "pch.h"
+#include "FileFrameSource.h"
+#include "Logger.h"
+#include "ScalingOptions.h"
+#include "DirectXHelper.h"
+#include "DeviceResources.h"
+#include "ScalingWindow.h"
+#include "StrHelper.h"
+#include "CommonSharedConstants.h"
+
+namespace Magpie {
+
+// 生成的图案每帧移动的像素数和循环周期，周期也是横向渐变的周期
+static constexpr uint32_t SYNTHETIC_SHIFT = 2;
+static constexpr uint32_t SYNTHETIC_PERIOD = 256;
+static constexpr uint32_t SYNTHETIC_FRAME_COUNT = SYNTHETIC_PERIOD / SYNTHETIC_SHIFT;
+
+bool FileFrameSource::_Initialize() noexcept {
+	if (!_CalcSrcRect()) {
+		return false;
+	}
+
+	if (!(_isSynthetic ? _InitSynthetic() : _InitRecording())) {
+		return false;
+	}
+
+	_output = DirectXHelper::CreateTexture2D(
+		_deviceResources->GetD3DDevice(),
+		!_isSynthetic && _reader.Format() == FrameRecordingFormat::RGBA8
+			? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_B8G8R8A8_UNORM,
+		_width,
+		_height,
+		D3D11_BIND_SHADER_RESOURCE
+	);
+	if (!_output) {
+		Logger::Get().Error("创建纹理失败");
+		return false;
+	}
+
+	_isBenchmarkMode = ScalingWindow::Get().Options().IsBenchmarkMode();
+
+	Logger::Get().Info(fmt::format("FileFrameSource 初始化完成，{}，共 {} 帧，时长 {:.3f} 秒",
+		_isSynthetic ? "使用生成的图案" : "使用帧录像", _timestamps.size(), _timestamps.back() / 1e9));
+	return true;
+}
+
+FrameSourceState FileFrameSource::_Update() noexcept {
+	const std::optional<uint32_t> frameIdx = _NextFrameIndex();
+	if (!frameIdx) {
+		return FrameSourceState::Waiting;
+	}
+
+	if (_isSynthetic) {
+		// 图案在横向上以 SYNTHETIC_PERIOD 为周期重复，从不同的偏移上传即可使其移动
+		const uint32_t offset = *frameIdx * SYNTHETIC_SHIFT;
+		_deviceResources->GetD3DDC()->UpdateSubresource(_output.get(), 0, nullptr,
+			_pixels.data() + offset * FrameRecording::BYTES_PER_PIXEL,
+			(_width + SYNTHETIC_PERIOD) * FrameRecording::BYTES_PER_PIXEL, 0);
+		return FrameSourceState::NewFrame;
+	}
+
+	try {
+		uint64_t timestamp;
+		if (!_reader.ReadFrame(*frameIdx, timestamp, _pixels)) {
+			Logger::Get().Error("读取帧录像失败");
+			return FrameSourceState::Error;
+		}
+	} catch (const std::exception& e) {
+		Logger::Get().Error(StrHelper::Concat("读取帧录像失败: ", e.what()));
+		return FrameSourceState::Error;
+	}
+
+	_deviceResources->GetD3DDC()->UpdateSubresource(_output.get(), 0, nullptr,
+		_pixels.data(), _width * FrameRecording::BYTES_PER_PIXEL, 0);
+
+	return FrameSourceState::NewFrame;
+}
+
+bool FileFrameSource::_InitSynthetic() noexcept {
+	_width = uint32_t(_srcRect.right - _srcRect.left);
+	_height = uint32_t(_srcRect.bottom - _srcRect.top);
+
+	// 一次生成比帧宽一个周期的图案，播放时不再有 CPU 开销。R 为横向的三角波渐变，G 为纵向渐变，
+	// B 为 8x8 的棋盘格，用于检验锐化等对边缘敏感的效果。
+	const uint32_t stride = _width + SYNTHETIC_PERIOD;
+	try {
+		_pixels.resize(FrameRecording::FrameDataSize(stride, _height));
+	} catch (const std::bad_alloc&) {
+		Logger::Get().Error("内存不足");
+		return false;
+	}
+
+	uint8_t* pixel = _pixels.data();
+	for (uint32_t y = 0; y < _height; ++y) {
+		const uint8_t g = uint8_t(_height > 1 ? y * 255 / (_height - 1) : 0);
+		for (uint32_t x = 0; x < stride; ++x) {
+			const uint32_t t = x % SYNTHETIC_PERIOD;
+			pixel[0] = ((x / 8 + y / 8) & 1) ? 200 : 55;
+			pixel[1] = g;
+			pixel[2] = uint8_t(t < SYNTHETIC_PERIOD / 2 ? t * 2 : (SYNTHETIC_PERIOD - 1 - t) * 2);
+			pixel[3] = 255;
+			pixel += FrameRecording::BYTES_PER_PIXEL;
+		}
+	}
+
+	_timestamps.resize(SYNTHETIC_FRAME_COUNT);
+	for (uint32_t i = 0; i < SYNTHETIC_FRAME_COUNT; ++i) {
+		_timestamps[i] = uint64_t(i) * 1'000'000'000 / 60;
+	}
+
+	return true;
+}
+
+bool FileFrameSource::_InitRecording() noexcept {
+	try {
+		if (!_reader.Open(CommonSharedConstants::FRAME_RECORDING_PATH)) {
+			Logger::Get().Error(StrHelper::Concat("打开帧录像 ",
+				StrHelper::UTF16ToUTF8(CommonSharedConstants::FRAME_RECORDING_PATH), " 失败"));
+			return false;
+		}
+
+		if (_reader.FrameCount() == 0) {
+			Logger::Get().Error("帧录像中没有帧");
+			return false;
+		}
+
+		// 预先读取所有时间戳，回放时只需读取像素
+		_timestamps.resize(_reader.FrameCount());
+		for (uint32_t i = 0; i < _reader.FrameCount(); ++i) {
+			if (!_reader.ReadTimestamp(i, _timestamps[i])) {
+				Logger::Get().Error("读取帧录像失败");
+				return false;
+			}
+		}
+
+		_pixels.resize(FrameRecording::FrameDataSize(_reader.Width(), _reader.Height()));
+	} catch (const std::exception& e) {
+		Logger::Get().Error(StrHelper::Concat("读取帧录像失败: ", e.what()));
+		return false;
+	}
+
+	_width = _reader.Width();
+	_height = _reader.Height();
+	return true;
+}
+
+std::optional<uint32_t> FileFrameSource::_NextFrameIndex() noexcept {
+	const uint32_t frameCount = (uint32_t)_timestamps.size();
+
+	if (_isBenchmarkMode) {
+		// 不考虑时间戳，尽可能快地播放
+		const uint32_t frameIdx = _nextFrameIdx;
+		_nextFrameIdx = (_nextFrameIdx + 1) % frameCount;
+		return frameIdx;
+	}
+
+	using namespace std::chrono;
+	const steady_clock::time_point now = steady_clock::now();
+
+	if (_nextFrameIdx == 0) {
+		// 开始 (或重新开始) 播放
+		_playbackStart = now;
+		_nextFrameIdx = 1;
+		return 0;
+	}
+
+	const uint64_t elapsed = (uint64_t)duration_cast<nanoseconds>(now - _playbackStart).count();
+	if (_nextFrameIdx == frameCount) {
+		// 最后一帧保持一个平均帧间隔后循环
+		const uint64_t avgInterval = frameCount > 1 ? _timestamps.back() / (frameCount - 1) : 0;
+		if (elapsed < _timestamps.back() + avgInterval) {
+			return std::nullopt;
+		}
+
+		_playbackStart = now;
+		_nextFrameIdx = 1;
+		return 0;
+	}
+
+	if (_timestamps[_nextFrameIdx] > elapsed) {
+		return std::nullopt;
+	}
+
+	// 跳到最近一个已到时间的帧，赶不上录制的帧率时丢弃中间的帧
+	uint32_t frameIdx = _nextFrameIdx;
+	while (frameIdx + 1 < frameCount && _timestamps[frameIdx + 1] <= elapsed) {
+		++frameIdx;
+	}
+
+	_nextFrameIdx = frameIdx + 1;
+	return frameIdx;
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "FrameSourceBase.h"
+#include "FrameRecording.h"
+
+namespace Magpie {
+
+// 回放 FrameRecorder 录制的帧，使效果的性能可以在相同的输入下比较。源窗口只用于确定缩放窗口的
+// 位置，捕获尺寸为录制时的尺寸。按录制时的时间间隔循环播放，测试模式下每次 Update 都返回下一帧。
+// 启用 SyntheticFrames 时不读取录像，而是以 60 FPS 播放生成的移动渐变，尺寸和源窗口相同。
+class FileFrameSource final : public FrameSourceBase {
+public:
+	explicit FileFrameSource(bool isSynthetic) noexcept : _isSynthetic(isSynthetic) {}
+
+	virtual ~FileFrameSource() {}
+
+	bool IsScreenCapture() const noexcept override {
+		return false;
+	}
+
+	FrameSourceWaitType WaitType() const noexcept override {
+		return FrameSourceWaitType::NoWait;
+	}
+
+	const char* Name() const noexcept override {
+		return _isSynthetic ? "Synthetic" : "File";
+	}
+
+protected:
+	bool _Initialize() noexcept override;
+
+	FrameSourceState _Update() noexcept override;
+
+	bool _HasRoundCornerInWin11() noexcept override {
+		return false;
+	}
+
+	bool _CanCaptureTitleBar() noexcept override {
+		return false;
+	}
+
+private:
+	// 返回现在应显示的帧，尚未到下一帧的时间时返回 std::nullopt
+	std::optional<uint32_t> _NextFrameIndex() noexcept;
+
+	bool _InitSynthetic() noexcept;
+
+	bool _InitRecording() noexcept;
+
+	FrameRecordingReader _reader;
+	// 使用生成的图案时比帧宽 SYNTHETIC_PERIOD 个像素，每帧从不同的偏移上传，见 _InitSynthetic
+	std::vector<uint8_t> _pixels;
+	// 每帧的时间戳，单位为纳秒
+	std::vector<uint64_t> _timestamps;
+
+	std::chrono::steady_clock::time_point _playbackStart;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	uint32_t _nextFrameIdx = 0;
+	bool _isBenchmarkMode = false;
+	const bool _isSynthetic;
+};
+
+}
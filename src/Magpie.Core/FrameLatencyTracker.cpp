@@ -0,0 +1,140 @@
+#include "pch.h"
+#include "FrameLatencyTracker.h"
+#include "Logger.h"
+#include "StrHelper.h"
+#include "CommonSharedConstants.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+// 统计最近 600 帧
+static constexpr uint32_t STATISTICS_WINDOW = 600;
+static constexpr milliseconds SUMMARIZE_INTERVAL = 500ms;
+// CSV 缓冲区超过此大小时写入文件，避免每帧都执行 IO
+static constexpr size_t CSV_FLUSH_THRESHOLD = 64 * 1024;
+
+static float ToMS(steady_clock::duration duration) noexcept {
+	return duration_cast<nanoseconds>(duration).count() / 1e6f;
+}
+
+FrameLatencyTracker::~FrameLatencyTracker() noexcept {
+	_FlushCsv();
+	_LogStatistics();
+}
+
+bool FrameLatencyTracker::Initialize(bool exportCsv) noexcept {
+	for (TimingStatistics& statistics : _statistics) {
+		statistics.Initialize(STATISTICS_WINDOW);
+	}
+
+	_startTime = steady_clock::now();
+
+	if (exportCsv) {
+		if (_wfopen_s(_csvFile.put(), CommonSharedConstants::FRAME_LATENCY_PATH, L"wb") || !_csvFile) {
+			Logger::Get().Error(StrHelper::Concat("打开文件 ",
+				StrHelper::UTF16ToUTF8(CommonSharedConstants::FRAME_LATENCY_PATH), " 失败"));
+			return false;
+		}
+
+		_csvBuffer = "frame,capture,render_end,publish,copy,present\n";
+		_csvBuffer.reserve(CSV_FLUSH_THRESHOLD + 256);
+	}
+
+	return true;
+}
+
+void FrameLatencyTracker::OnFramePublished(uint64_t frameId, const FrameTimestamps& timestamps) noexcept {
+	auto lock = _publishLock.lock_exclusive();
+	_publishedFrameId = frameId;
+	_publishedTimestamps = timestamps;
+}
+
+void FrameLatencyTracker::OnFrameCopied() noexcept {
+	{
+		auto lock = _publishLock.lock_shared();
+		_isNewFrame = _publishedFrameId != _lastPresentedFrameId;
+		if (!_isNewFrame) {
+			return;
+		}
+
+		_curRecord.frameId = _publishedFrameId;
+		_curRecord.timestamps = _publishedTimestamps;
+	}
+
+	// 只是提交了复制命令的时间
+	_curRecord.copy = steady_clock::now();
+}
+
+uint64_t FrameLatencyTracker::OnFramePresented(steady_clock::time_point presentTime) noexcept {
+	if (!_isNewFrame) {
+		return 0;
+	}
+	_isNewFrame = false;
+
+	_curRecord.present = presentTime;
+	_lastPresentedFrameId = _curRecord.frameId;
+
+	const steady_clock::time_point captureTime = _curRecord.timestamps.capture;
+	_statistics[(size_t)Stage::Render].Add(ToMS(_curRecord.timestamps.renderEnd - captureTime));
+	_statistics[(size_t)Stage::Publish].Add(ToMS(_curRecord.timestamps.publish - captureTime));
+	_statistics[(size_t)Stage::Copy].Add(ToMS(_curRecord.copy - captureTime));
+	_statistics[(size_t)Stage::Present].Add(ToMS(presentTime - captureTime));
+
+	if (_csvFile) {
+		_WriteCsvRecord(_curRecord);
+	}
+
+	if (presentTime - _lastSummarizeTime >= SUMMARIZE_INTERVAL) {
+		_lastSummarizeTime = presentTime;
+
+		for (size_t i = 0; i < _statistics.size(); ++i) {
+			_summaries[i] = _statistics[i].Summarize();
+		}
+		++_statisticsVersion;
+	}
+
+	return _curRecord.frameId;
+}
+
+void FrameLatencyTracker::_WriteCsvRecord(const _FrameRecord& record) noexcept {
+	fmt::format_to(std::back_inserter(_csvBuffer), "{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f}\n",
+		record.frameId,
+		ToMS(record.timestamps.capture - _startTime),
+		ToMS(record.timestamps.renderEnd - _startTime),
+		ToMS(record.timestamps.publish - _startTime),
+		ToMS(record.copy - _startTime),
+		ToMS(record.present - _startTime)
+	);
+
+	if (_csvBuffer.size() >= CSV_FLUSH_THRESHOLD) {
+		_FlushCsv();
+	}
+}
+
+void FrameLatencyTracker::_FlushCsv() noexcept {
+	if (!_csvFile || _csvBuffer.empty()) {
+		return;
+	}
+
+	fwrite(_csvBuffer.data(), 1, _csvBuffer.size(), _csvFile.get());
+	_csvBuffer.clear();
+}
+
+void FrameLatencyTracker::_LogStatistics() const noexcept {
+	const TimingStatistics::Summary present = _statistics[(size_t)Stage::Present].Summarize();
+	if (present.count == 0) {
+		return;
+	}
+
+	const TimingStatistics::Summary render = _statistics[(size_t)Stage::Render].Summarize();
+	Logger::Get().Info(fmt::format(R"(最近 {} 帧的延迟 (ms)
+	捕获到渲染完成: mean {:.3f}, p50 {:.3f}, p95 {:.3f}, p99 {:.3f}, max {:.3f}
+	捕获到呈现: mean {:.3f}, p50 {:.3f}, p95 {:.3f}, p99 {:.3f}, max {:.3f})",
+		present.count,
+		render.mean, render.p50, render.p95, render.p99, render.max,
+		present.mean, present.p50, present.p95, present.p99, present.max
+	));
+}
+
+}
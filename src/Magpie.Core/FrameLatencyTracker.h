@@ -0,0 +1,91 @@
+#pragma once
+#include "TimingStatistics.h"
+
+namespace Magpie {
+
+// 后端线程记录的时间戳，通过共享纹理交给前端
+struct FrameTimestamps {
+	// 捕获到这一帧的时间
+	std::chrono::steady_clock::time_point capture;
+	// GPU 完成效果渲染，即 fence 完成的时间
+	std::chrono::steady_clock::time_point renderEnd;
+	// 写入共享纹理的时间
+	std::chrono::steady_clock::time_point publish;
+};
+
+// 统计从捕获到呈现的端到端延迟。除 OnFramePublished 外都只能由前端线程调用。
+class FrameLatencyTracker {
+public:
+	// 各阶段的延迟都从捕获开始计算
+	enum class Stage {
+		Render,
+		Publish,
+		Copy,
+		Present,
+		COUNT
+	};
+
+	FrameLatencyTracker() = default;
+	FrameLatencyTracker(const FrameLatencyTracker&) = delete;
+	FrameLatencyTracker(FrameLatencyTracker&&) = delete;
+
+	~FrameLatencyTracker() noexcept;
+
+	bool Initialize(bool exportCsv) noexcept;
+
+	// 由后端线程在持有共享纹理的锁时调用
+	void OnFramePublished(uint64_t frameId, const FrameTimestamps& timestamps) noexcept;
+
+	// 前端将共享纹理复制到后缓冲区后，释放共享纹理的锁之前调用
+	void OnFrameCopied() noexcept;
+
+	// 返回新呈现的帧的 id，和 OnFramePublished 的 frameId 相同。没有呈现新帧时返回 0
+	uint64_t OnFramePresented(std::chrono::steady_clock::time_point presentTime) noexcept;
+
+	// 每 500ms 更新一次
+	const std::array<TimingStatistics::Summary, (size_t)Stage::COUNT>& GetStatistics() const noexcept {
+		return _summaries;
+	}
+
+	// 统计结果更新后递增
+	uint32_t StatisticsVersion() const noexcept {
+		return _statisticsVersion;
+	}
+
+private:
+	struct _FrameRecord {
+		uint64_t frameId = 0;
+		FrameTimestamps timestamps;
+		std::chrono::steady_clock::time_point copy;
+		std::chrono::steady_clock::time_point present;
+	};
+
+	void _WriteCsvRecord(const _FrameRecord& record) noexcept;
+
+	void _FlushCsv() noexcept;
+
+	void _LogStatistics() const noexcept;
+
+	// 由 _publishLock 保护
+	wil::srwlock _publishLock;
+	uint64_t _publishedFrameId = 0;
+	FrameTimestamps _publishedTimestamps;
+
+	// 只能由前端线程访问
+	_FrameRecord _curRecord;
+	// 同一帧可能因为光标移动被多次呈现，只统计第一次
+	uint64_t _lastPresentedFrameId = 0;
+	bool _isNewFrame = false;
+
+	std::array<TimingStatistics, (size_t)Stage::COUNT> _statistics;
+	std::array<TimingStatistics::Summary, (size_t)Stage::COUNT> _summaries{};
+	std::chrono::steady_clock::time_point _lastSummarizeTime{};
+	uint32_t _statisticsVersion = 0;
+
+	wil::unique_file _csvFile;
+	std::string _csvBuffer;
+	// CSV 中的时间都相对于此时间
+	std::chrono::steady_clock::time_point _startTime;
+};
+
+}
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "FrameRecorder.h"
+#include "Logger.h"
+#include "StrHelper.h"
+#include "CommonSharedConstants.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+FrameRecorder::~FrameRecorder() noexcept {
+	_Stop();
+}
+
+bool FrameRecorder::Initialize(ID3D11Device* d3dDevice, ID3D11Texture2D* source) noexcept {
+	D3D11_TEXTURE2D_DESC desc;
+	source->GetDesc(&desc);
+
+	FrameRecordingFormat format;
+	if (desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM) {
+		format = FrameRecordingFormat::BGRA8;
+	} else if (desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM) {
+		format = FrameRecordingFormat::RGBA8;
+	} else {
+		Logger::Get().Error(fmt::format("不支持录制格式为 {} 的帧", (int)desc.Format));
+		return false;
+	}
+
+	const D3D11_TEXTURE2D_DESC stagingDesc{
+		.Width = desc.Width,
+		.Height = desc.Height,
+		.MipLevels = 1,
+		.ArraySize = 1,
+		.Format = desc.Format,
+		.SampleDesc{
+			.Count = 1,
+			.Quality = 0
+		},
+		.Usage = D3D11_USAGE_STAGING,
+		.CPUAccessFlags = D3D11_CPU_ACCESS_READ
+	};
+	for (_Slot& slot : _slots) {
+		HRESULT hr = d3dDevice->CreateTexture2D(&stagingDesc, nullptr, slot.texture.put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateTexture2D 失败", hr);
+			return false;
+		}
+	}
+
+	bool success;
+	try {
+		success = _writer.Open(CommonSharedConstants::FRAME_RECORDING_PATH, desc.Width, desc.Height, format);
+	} catch (const std::exception& e) {
+		Logger::Get().Error(StrHelper::Concat("FrameRecordingWriter::Open 失败: ", e.what()));
+		success = false;
+	}
+	if (!success) {
+		Logger::Get().Error(StrHelper::Concat("打开文件 ",
+			StrHelper::UTF16ToUTF8(CommonSharedConstants::FRAME_RECORDING_PATH), " 失败"));
+		return false;
+	}
+
+	Logger::Get().Info(StrHelper::Concat("开始录制帧: ",
+		StrHelper::UTF16ToUTF8(CommonSharedConstants::FRAME_RECORDING_PATH)));
+	return true;
+}
+
+void FrameRecorder::OnNewFrame(
+	ID3D11DeviceContext* d3dDC,
+	ID3D11Texture2D* frame,
+	steady_clock::time_point captureTime
+) noexcept {
+	if (!_writer.IsOpen()) {
+		return;
+	}
+
+	_d3dDC = d3dDC;
+
+	_Slot& slot = _slots[_nextSlot];
+	if (_pendingCount == STAGING_COUNT) {
+		// 这个槽中是最旧的帧，复制已提交数帧，读回时通常无需等待
+		if (!_WriteSlot(d3dDC, slot)) {
+			_Stop();
+			return;
+		}
+		--_pendingCount;
+	}
+
+	d3dDC->CopyResource(slot.texture.get(), frame);
+	slot.captureTime = captureTime;
+	++_pendingCount;
+	_nextSlot = (_nextSlot + 1) % STAGING_COUNT;
+}
+
+bool FrameRecorder::_WriteSlot(ID3D11DeviceContext* d3dDC, const _Slot& slot) noexcept {
+	if (!_firstCaptureTime) {
+		_firstCaptureTime = slot.captureTime;
+	}
+	const uint64_t timestamp = (uint64_t)duration_cast<nanoseconds>(
+		std::max(slot.captureTime - *_firstCaptureTime, steady_clock::duration::zero())).count();
+
+	D3D11_MAPPED_SUBRESOURCE ms;
+	HRESULT hr = d3dDC->Map(slot.texture.get(), 0, D3D11_MAP_READ, 0, &ms);
+	if (FAILED(hr)) {
+		Logger::Get().ComError("Map 失败", hr);
+		return false;
+	}
+
+	bool success;
+	try {
+		success = _writer.WriteFrame(timestamp, (const uint8_t*)ms.pData, ms.RowPitch);
+	} catch (const std::exception& e) {
+		Logger::Get().Error(StrHelper::Concat("FrameRecordingWriter::WriteFrame 失败: ", e.what()));
+		success = false;
+	}
+
+	d3dDC->Unmap(slot.texture.get(), 0);
+
+	if (!success) {
+		Logger::Get().Error("写入帧录像失败");
+	}
+	return success;
+}
+
+void FrameRecorder::_Stop() noexcept {
+	if (!_writer.IsOpen()) {
+		return;
+	}
+
+	// 写入剩余的帧
+	if (_d3dDC) {
+		for (uint32_t i = _pendingCount; i > 0; --i) {
+			const _Slot& slot = _slots[(_nextSlot + STAGING_COUNT - i) % STAGING_COUNT];
+			if (!_WriteSlot(_d3dDC, slot)) {
+				break;
+			}
+		}
+	}
+	_pendingCount = 0;
+
+	bool success;
+	try {
+		success = _writer.Close();
+	} catch (const std::exception&) {
+		success = false;
+	}
+
+	if (success) {
+		Logger::Get().Info(fmt::format("帧录制结束，共 {} 帧", _writer.FrameCount()));
+	} else {
+		Logger::Get().Error("关闭帧录像失败");
+	}
+}
+
+}
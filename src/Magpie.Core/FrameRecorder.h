@@ -0,0 +1,53 @@
+#pragma once
+#include "FrameRecording.h"
+
+namespace Magpie {
+
+// 将捕获到的帧连同捕获时间写入帧录像，供 FileFrameSource 回放。帧先复制到暂存纹理，数帧后
+// 才读回，避免等待 GPU。只能由后端线程调用。
+class FrameRecorder {
+public:
+	FrameRecorder() = default;
+	FrameRecorder(const FrameRecorder&) = delete;
+	FrameRecorder(FrameRecorder&&) = delete;
+
+	~FrameRecorder() noexcept;
+
+	// source 为要录制的纹理，之后的帧尺寸和格式应和它相同
+	bool Initialize(ID3D11Device* d3dDevice, ID3D11Texture2D* source) noexcept;
+
+	bool IsRecording() const noexcept {
+		return _writer.IsOpen();
+	}
+
+	void OnNewFrame(
+		ID3D11DeviceContext* d3dDC,
+		ID3D11Texture2D* frame,
+		std::chrono::steady_clock::time_point captureTime
+	) noexcept;
+
+private:
+	// 暂存纹理的个数，也是读回前等待的帧数
+	static constexpr uint32_t STAGING_COUNT = 3;
+
+	struct _Slot {
+		winrt::com_ptr<ID3D11Texture2D> texture;
+		std::chrono::steady_clock::time_point captureTime;
+	};
+
+	bool _WriteSlot(ID3D11DeviceContext* d3dDC, const _Slot& slot) noexcept;
+
+	void _Stop() noexcept;
+
+	std::array<_Slot, STAGING_COUNT> _slots;
+	// 下一帧使用的槽
+	uint32_t _nextSlot = 0;
+	// 已复制但未写入的帧数
+	uint32_t _pendingCount = 0;
+	ID3D11DeviceContext* _d3dDC = nullptr;
+
+	FrameRecordingWriter _writer;
+	std::optional<std::chrono::steady_clock::time_point> _firstCaptureTime;
+};
+
+}
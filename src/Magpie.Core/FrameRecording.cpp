@@ -0,0 +1,161 @@
+// 不使用预编译头，只能使用标准库
+#include "FrameRecording.h"
+#include <array>
+
+namespace Magpie {
+
+static constexpr std::array<char, 4> MAGIC = { 'M', 'P', 'F', 'R' };
+
+static void StoreLE(uint8_t* dest, uint64_t value, uint32_t size) noexcept {
+	for (uint32_t i = 0; i < size; ++i) {
+		dest[i] = uint8_t(value >> (i * 8));
+	}
+}
+
+static uint64_t LoadLE(const uint8_t* src, uint32_t size) noexcept {
+	uint64_t value = 0;
+	for (uint32_t i = 0; i < size; ++i) {
+		value |= uint64_t(src[i]) << (i * 8);
+	}
+	return value;
+}
+
+bool FrameRecordingWriter::Open(
+	const std::filesystem::path& path,
+	uint32_t width,
+	uint32_t height,
+	FrameRecordingFormat format
+) {
+	if (width == 0 || height == 0) {
+		return false;
+	}
+
+	_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!_file) {
+		return false;
+	}
+
+	_width = width;
+	_height = height;
+	_frameCount = 0;
+
+	std::array<uint8_t, FrameRecording::HEADER_SIZE> header{};
+	std::copy(MAGIC.begin(), MAGIC.end(), header.begin());
+	StoreLE(&header[4], FrameRecording::VERSION, 4);
+	StoreLE(&header[8], width, 4);
+	StoreLE(&header[12], height, 4);
+	StoreLE(&header[16], (uint32_t)format, 4);
+	_file.write((const char*)header.data(), header.size());
+
+	return (bool)_file;
+}
+
+bool FrameRecordingWriter::WriteFrame(uint64_t timestampNs, const uint8_t* pixels, uint32_t rowPitch) {
+	if (!_file) {
+		return false;
+	}
+
+	std::array<uint8_t, 8> timestamp;
+	StoreLE(timestamp.data(), timestampNs, 8);
+	_file.write((const char*)timestamp.data(), timestamp.size());
+
+	const uint32_t rowSize = _width * FrameRecording::BYTES_PER_PIXEL;
+	for (uint32_t y = 0; y < _height; ++y) {
+		_file.write((const char*)pixels + size_t(y) * rowPitch, rowSize);
+	}
+
+	if (!_file) {
+		return false;
+	}
+
+	++_frameCount;
+	return true;
+}
+
+bool FrameRecordingWriter::Close() {
+	if (!_file.is_open()) {
+		return false;
+	}
+
+	_file.close();
+	return !_file.fail();
+}
+
+bool FrameRecordingReader::Open(const std::filesystem::path& path) {
+	_file.open(path, std::ios::binary);
+	if (!_file) {
+		return false;
+	}
+
+	std::array<uint8_t, FrameRecording::HEADER_SIZE> header;
+	if (!_file.read((char*)header.data(), header.size())) {
+		return false;
+	}
+
+	if (!std::equal(MAGIC.begin(), MAGIC.end(), header.begin())) {
+		return false;
+	}
+
+	if (LoadLE(&header[4], 4) != FrameRecording::VERSION) {
+		return false;
+	}
+
+	_width = (uint32_t)LoadLE(&header[8], 4);
+	_height = (uint32_t)LoadLE(&header[12], 4);
+	const uint32_t format = (uint32_t)LoadLE(&header[16], 4);
+	if (_width == 0 || _height == 0 || format > (uint32_t)FrameRecordingFormat::RGBA8) {
+		return false;
+	}
+	_format = (FrameRecordingFormat)format;
+
+	std::error_code ec;
+	const uint64_t fileSize = std::filesystem::file_size(path, ec);
+	if (ec) {
+		return false;
+	}
+
+	// 忽略写入中断时不完整的最后一帧
+	const uint64_t frameSize = 8 + FrameRecording::FrameDataSize(_width, _height);
+	_frameCount = uint32_t((fileSize - FrameRecording::HEADER_SIZE) / frameSize);
+	return true;
+}
+
+bool FrameRecordingReader::ReadTimestamp(uint32_t frameIdx, uint64_t& timestampNs) {
+	if (!_Seek(frameIdx)) {
+		return false;
+	}
+
+	std::array<uint8_t, 8> timestamp;
+	if (!_file.read((char*)timestamp.data(), timestamp.size())) {
+		return false;
+	}
+
+	timestampNs = LoadLE(timestamp.data(), 8);
+	return true;
+}
+
+bool FrameRecordingReader::ReadFrame(uint32_t frameIdx, uint64_t& timestampNs, std::span<uint8_t> pixels) {
+	const uint64_t dataSize = FrameRecording::FrameDataSize(_width, _height);
+	if (pixels.size() < dataSize) {
+		return false;
+	}
+
+	if (!ReadTimestamp(frameIdx, timestampNs)) {
+		return false;
+	}
+
+	return (bool)_file.read((char*)pixels.data(), (std::streamsize)dataSize);
+}
+
+bool FrameRecordingReader::_Seek(uint32_t frameIdx) {
+	if (frameIdx >= _frameCount) {
+		return false;
+	}
+
+	const uint64_t frameSize = 8 + FrameRecording::FrameDataSize(_width, _height);
+	_file.clear();
+	_file.seekg((std::streamoff)(FrameRecording::HEADER_SIZE + frameIdx * frameSize));
+	return (bool)_file;
+}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+namespace Magpie {
+
+enum class FrameRecordingFormat : uint32_t {
+	BGRA8 = 0,
+	RGBA8 = 1
+};
+
+// 帧录像的容器格式，用于以固定的输入重现渲染。所有整数为小端序:
+// 文件头: "MPFR" | 版本 (uint32) | 宽 (uint32) | 高 (uint32) | 像素格式 (uint32)
+// 之后每帧: 时间戳 (uint64，相对第一帧，单位为纳秒) | 宽 * 高 * 4 字节的像素，按行紧密排列
+// 每帧大小相同，因此可以随机访问，帧数由文件大小得出，写入中断也不会损坏之前的帧。
+// 注意此头文件和 FrameRecording.cpp 只能使用标准库。
+struct FrameRecording {
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t HEADER_SIZE = 20;
+	static constexpr uint32_t BYTES_PER_PIXEL = 4;
+
+	static uint64_t FrameDataSize(uint32_t width, uint32_t height) noexcept {
+		return uint64_t(width) * height * BYTES_PER_PIXEL;
+	}
+};
+
+class FrameRecordingWriter {
+public:
+	bool Open(const std::filesystem::path& path, uint32_t width, uint32_t height, FrameRecordingFormat format);
+
+	bool IsOpen() const noexcept {
+		return _file.is_open();
+	}
+
+	// rowPitch 为 pixels 中每行的字节数，可以大于宽 * 4
+	bool WriteFrame(uint64_t timestampNs, const uint8_t* pixels, uint32_t rowPitch);
+
+	uint32_t FrameCount() const noexcept {
+		return _frameCount;
+	}
+
+	// 返回之前写入的数据是否都已成功写入文件
+	bool Close();
+
+private:
+	std::ofstream _file;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	uint32_t _frameCount = 0;
+};
+
+class FrameRecordingReader {
+public:
+	bool Open(const std::filesystem::path& path);
+
+	uint32_t Width() const noexcept {
+		return _width;
+	}
+
+	uint32_t Height() const noexcept {
+		return _height;
+	}
+
+	FrameRecordingFormat Format() const noexcept {
+		return _format;
+	}
+
+	uint32_t FrameCount() const noexcept {
+		return _frameCount;
+	}
+
+	// 只读取时间戳
+	bool ReadTimestamp(uint32_t frameIdx, uint64_t& timestampNs);
+
+	// pixels 的大小应为 FrameRecording::FrameDataSize(Width(), Height())
+	bool ReadFrame(uint32_t frameIdx, uint64_t& timestampNs, std::span<uint8_t> pixels);
+
+private:
+	bool _Seek(uint32_t frameIdx);
+
+	std::ifstream _file;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	FrameRecordingFormat _format = FrameRecordingFormat::BGRA8;
+	uint32_t _frameCount = 0;
+};
+
+}
@@ -7,18 +7,15 @@
 #include "DirectXHelper.h"
 #include "DeviceResources.h"
 #include "shaders/DuplicateFrameCS.h"
+#include "shaders/DuplicateFramePredicateVS.h"
+#include "shaders/TileChangeCS.h"
 #include "ScalingWindow.h"
 #include "BackendDescriptorStore.h"
 #include <dwmapi.h>
 
 namespace Magpie {
 
-static constexpr uint16_t INITIAL_CHECK_COUNT = 16;
-static constexpr uint16_t INITIAL_SKIP_COUNT = 1;
-static constexpr uint16_t MAX_SKIP_COUNT = 16;
-
-FrameSourceBase::FrameSourceBase() noexcept :
-	_nextSkipCount(INITIAL_SKIP_COUNT), _framesLeft(INITIAL_CHECK_COUNT) {}
+FrameSourceBase::FrameSourceBase() noexcept {}
 
 FrameSourceBase::~FrameSourceBase() noexcept {
 	const HWND hwndSrc = ScalingWindow::Get().HwndSrc();
@@ -100,6 +97,21 @@ bool FrameSourceBase::Initialize(DeviceResources& deviceResources, BackendDescri
 		return false;
 	}
 
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	if (options.duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Dynamic) {
+		switch (options.duplicateFramePredictorPolicy) {
+		case DuplicateFramePredictorPolicy::ExponentialBackoff:
+			_duplicateFramePredictor = std::make_unique<ExponentialBackoffDuplicateFramePredictor>();
+			break;
+		case DuplicateFramePredictorPolicy::Learned:
+			_duplicateFramePredictor = std::make_unique<LearnedDuplicateFramePredictor>();
+			break;
+		default:
+			_duplicateFramePredictor = std::make_unique<HeuristicDuplicateFramePredictor>();
+			break;
+		}
+	}
+
 	assert(_output);
 	_outputSrv = descriptorStore.GetShaderResourceView(_output.get());
 	if (!_outputSrv) {
@@ -111,7 +123,13 @@ bool FrameSourceBase::Initialize(DeviceResources& deviceResources, BackendDescri
 }
 
 FrameSourceState FrameSourceBase::Update() noexcept {
+	_lastDuplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
+	_isTileChangeMapValid = false;
+	_hasDirtyRects = false;
 	const FrameSourceState state = _Update();
+	if (state == FrameSourceState::NewFrame) {
+		_captureTime = std::chrono::steady_clock::now();
+	}
 
 	const ScalingOptions& options = ScalingWindow::Get().Options();
 	const auto duplicateFrameDetectionMode = options.duplicateFrameDetectionMode;
@@ -124,6 +142,21 @@ FrameSourceState FrameSourceBase::Update() noexcept {
 
 	if (!_prevFrame) {
 		if (_InitCheckingForDuplicateFrame()) {
+			if (options.IsTileChangeMapEnabled()) {
+				// 渲染前需要取回位图，因此不能和异步检查同时使用
+				if (!_InitTileChangeMap()) {
+					// 退回整帧检查
+					Logger::Get().Error("_InitTileChangeMap 失败");
+				}
+			} else if (options.IsAsyncDuplicateFrameCheckEnabled() &&
+				// 捕获线程中同步检查不会阻塞渲染
+				!options.IsCaptureThreadEnabled() &&
+				!_InitAsyncDuplicateFrameCheck()) {
+				// 退回同步检查
+				Logger::Get().Error("_InitAsyncDuplicateFrameCheck 失败");
+				_dupFramePredicate = nullptr;
+			}
+
 			d3dDC->CopyResource(_prevFrame.get(), _output.get());
 		} else {
 			Logger::Get().Error("_InitCheckingForDuplicateFrame 失败");
@@ -136,10 +169,17 @@ FrameSourceState FrameSourceBase::Update() noexcept {
 
 	if (duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Always) {
 		// 总是检查重复帧
+		if (_dupFramePredicate) {
+			_CheckDuplicateFrameAsync();
+			return FrameSourceState::NewFrame;
+		}
+
 		if (_IsDuplicateFrame()) {
+			_lastDuplicateCheckResult = DuplicateFrameCheckResult::Duplicate;
 			return FrameSourceState::Waiting;
 		} else {
-			d3dDC->CopyResource(_prevFrame.get(), _output.get());
+			_lastDuplicateCheckResult = DuplicateFrameCheckResult::Unique;
+			_UpdatePrevFrame();
 			return FrameSourceState::NewFrame;
 		}
 	}
@@ -152,43 +192,34 @@ FrameSourceState FrameSourceBase::Update() noexcept {
 
 	const bool isStatisticsEnabled = options.IsStatisticsForDynamicDetectionEnabled();
 
-	if (_isCheckingForDuplicateFrame) {
-		if (--_framesLeft == 0) {
-			_isCheckingForDuplicateFrame = false;
-			_framesLeft = _nextSkipCount;
-			if (_nextSkipCount < MAX_SKIP_COUNT) {
-				// 增加下一次连续跳过检查的帧数
-				++_nextSkipCount;
-			}
+	if (_duplicateFramePredictor->ShouldCheck()) {
+		if (_dupFramePredicate) {
+			// 结果由 ResolveDuplicateCheck 报告给 _duplicateFramePredictor
+			_CheckDuplicateFrameAsync();
+			return FrameSourceState::NewFrame;
 		}
 
-		if (_IsDuplicateFrame()) {
-			_isCheckingForDuplicateFrame = true;
-			_framesLeft = INITIAL_CHECK_COUNT;
-			_nextSkipCount = INITIAL_SKIP_COUNT;
+		const bool isDuplicate = _IsDuplicateFrame();
+		_duplicateFramePredictor->OnChecked(isDuplicate);
+
+		if (isDuplicate) {
+			_lastDuplicateCheckResult = DuplicateFrameCheckResult::Duplicate;
 			return FrameSourceState::Waiting;
 		} else {
-			if (_isCheckingForDuplicateFrame || isStatisticsEnabled) {
-				d3dDC->CopyResource(_prevFrame.get(), _output.get());
+			_lastDuplicateCheckResult = DuplicateFrameCheckResult::Unique;
+			if (_duplicateFramePredictor->ShouldCheck() || isStatisticsEnabled) {
+				_UpdatePrevFrame();
 			}
 			return FrameSourceState::NewFrame;
 		}
 	} else {
-		if (--_framesLeft == 0) {
-			_isCheckingForDuplicateFrame = true;
-			// 第 2 次连续检查 10 帧，之后逐渐减少，从第 16 次开始只连续检查 2 帧
-			_framesLeft = uint32_t((-4 * (int)_nextSkipCount + 78) / 7);
-			
-			if (!isStatisticsEnabled) {
-				// 下一帧将检查重复帧，需要复制此帧
-				d3dDC->CopyResource(_prevFrame.get(), _output.get());
-			}
-		}
+		_lastDuplicateCheckResult = DuplicateFrameCheckResult::Skipped;
+		_duplicateFramePredictor->OnSkipped();
 
 		if (isStatisticsEnabled) {
 			const bool isDuplicate = _IsDuplicateFrame();
 			if (!isDuplicate) {
-				d3dDC->CopyResource(_prevFrame.get(), _output.get());
+				_UpdatePrevFrame();
 			}
 
 			std::pair<uint32_t, uint32_t> statistics = _statistics.load(std::memory_order_relaxed);
@@ -199,12 +230,28 @@ FrameSourceState FrameSourceBase::Update() noexcept {
 			// 总帧数
 			++statistics.second;
 			_statistics.store(statistics, std::memory_order_relaxed);
+		} else if (_duplicateFramePredictor->ShouldCheck()) {
+			// 下一帧将检查重复帧，需要复制此帧
+			_UpdatePrevFrame();
 		}
 
 		return FrameSourceState::NewFrame;
 	}
 }
 
+void FrameSourceBase::GetDirtyRegion(DirtyRegion& region) const {
+	if (_isTileChangeMapValid) {
+		region.isWhole = false;
+		_tileChangeMap.MergeDirtyRects(region.rects);
+	} else if (_hasDirtyRects) {
+		region.isWhole = false;
+		region.rects = _dirtyRects;
+	} else {
+		region.isWhole = true;
+		region.rects.clear();
+	}
+}
+
 std::pair<uint32_t, uint32_t> FrameSourceBase::GetStatisticsForDynamicDetection() const noexcept {
 	return _statistics.load(std::memory_order_relaxed);
 }
@@ -564,7 +611,76 @@ bool FrameSourceBase::_InitCheckingForDuplicateFrame() {
 	return true;
 }
 
-bool FrameSourceBase::_IsDuplicateFrame() {
+bool FrameSourceBase::_InitAsyncDuplicateFrameCheck() noexcept {
+	ID3D11Device5* d3dDevice = _deviceResources->GetD3DDevice();
+
+	// _resultBuffer 需要绑定为 SRV，因此重新创建
+	D3D11_BUFFER_DESC bd{
+		.ByteWidth = 4,
+		.Usage = D3D11_USAGE_DEFAULT,
+		.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE,
+		.StructureByteStride = 4
+	};
+	winrt::com_ptr<ID3D11Buffer> resultBuffer;
+	HRESULT hr = d3dDevice->CreateBuffer(&bd, nullptr, resultBuffer.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateBuffer 失败", hr);
+		return false;
+	}
+
+	_resultBufferUav = _descriptorStore->GetUnorderedAccessView(
+		resultBuffer.get(), 1, DXGI_FORMAT_R32_UINT);
+	if (!_resultBufferUav) {
+		Logger::Get().Error("GetUnorderedAccessView 失败");
+		return false;
+	}
+	_resultBuffer = std::move(resultBuffer);
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc{
+		.Format = DXGI_FORMAT_R32_UINT,
+		.ViewDimension = D3D11_SRV_DIMENSION_BUFFER,
+		.Buffer{
+			.NumElements = 1
+		}
+	};
+	hr = d3dDevice->CreateShaderResourceView(_resultBuffer.get(), &srvDesc, _resultBufferSrv.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateShaderResourceView 失败", hr);
+		return false;
+	}
+
+	hr = d3dDevice->CreateVertexShader(
+		DuplicateFramePredicateVS, sizeof(DuplicateFramePredicateVS), nullptr, _dupFramePredicateVS.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateVertexShader 失败", hr);
+		return false;
+	}
+
+	// 遮挡谓词需要光栅化，因此创建 1x1 的渲染目标
+	_predicateTarget = DirectXHelper::CreateTexture2D(
+		d3dDevice, DXGI_FORMAT_R8_UNORM, 1, 1, D3D11_BIND_RENDER_TARGET);
+	if (!_predicateTarget) {
+		Logger::Get().Error("CreateTexture2D 失败");
+		return false;
+	}
+
+	hr = d3dDevice->CreateRenderTargetView(_predicateTarget.get(), nullptr, _predicateTargetRtv.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateRenderTargetView 失败", hr);
+		return false;
+	}
+
+	const D3D11_QUERY_DESC queryDesc{ .Query = D3D11_QUERY_OCCLUSION_PREDICATE };
+	hr = d3dDevice->CreatePredicate(&queryDesc, _dupFramePredicate.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreatePredicate 失败", hr);
+		return false;
+	}
+
+	return true;
+}
+
+void FrameSourceBase::_DispatchDuplicateFrameCheck() noexcept {
 	// 检查是否和前一帧相同
 	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
 
@@ -586,6 +702,10 @@ bool FrameSourceBase::_IsDuplicateFrame() {
 
 	// 取回结果
 	d3dDC->CopyResource(_readBackBuffer.get(), _resultBuffer.get());
+}
+
+bool FrameSourceBase::_ReadDuplicateCheckResult() noexcept {
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
 
 	uint32_t result = 1;
 	D3D11_MAPPED_SUBRESOURCE ms;
@@ -597,4 +717,163 @@ bool FrameSourceBase::_IsDuplicateFrame() {
 	return result == 0;
 }
 
+bool FrameSourceBase::_InitTileChangeMap() noexcept {
+	ID3D11Device5* d3dDevice = _deviceResources->GetD3DDevice();
+
+	D3D11_TEXTURE2D_DESC td;
+	_output->GetDesc(&td);
+	_tileChangeMap.Initialize(td.Width, td.Height);
+	const uint32_t wordCount = _tileChangeMap.WordCount();
+
+	// 每块占一位，重新创建 _resultBuffer 和 _readBackBuffer 以容纳位图
+	D3D11_BUFFER_DESC bd{
+		.ByteWidth = wordCount * 4,
+		.Usage = D3D11_USAGE_DEFAULT,
+		.BindFlags = D3D11_BIND_UNORDERED_ACCESS,
+		.StructureByteStride = 4
+	};
+	winrt::com_ptr<ID3D11Buffer> resultBuffer;
+	HRESULT hr = d3dDevice->CreateBuffer(&bd, nullptr, resultBuffer.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateBuffer 失败", hr);
+		return false;
+	}
+
+	ID3D11UnorderedAccessView* resultBufferUav = _descriptorStore->GetUnorderedAccessView(
+		resultBuffer.get(), wordCount, DXGI_FORMAT_R32_UINT);
+	if (!resultBufferUav) {
+		Logger::Get().Error("GetUnorderedAccessView 失败");
+		return false;
+	}
+
+	bd.Usage = D3D11_USAGE_STAGING;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	bd.BindFlags = 0;
+	winrt::com_ptr<ID3D11Buffer> readBackBuffer;
+	hr = d3dDevice->CreateBuffer(&bd, nullptr, readBackBuffer.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateBuffer 失败", hr);
+		return false;
+	}
+
+	winrt::com_ptr<ID3D11ComputeShader> tileChangeCS;
+	hr = d3dDevice->CreateComputeShader(
+		TileChangeCS, sizeof(TileChangeCS), nullptr, tileChangeCS.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateComputeShader 失败", hr);
+		return false;
+	}
+
+	// TileChangeCS 取代 DuplicateFrameCS，每个线程组处理一块
+	_resultBuffer = std::move(resultBuffer);
+	_resultBufferUav = resultBufferUav;
+	_readBackBuffer = std::move(readBackBuffer);
+	_dupFrameCS = std::move(tileChangeCS);
+	_dispatchCount = { _tileChangeMap.TileCountX(), _tileChangeMap.TileCountY() };
+	_isTileChangeMapEnabled = true;
+
+	return true;
+}
+
+bool FrameSourceBase::_ReadTileChangeMap() noexcept {
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+
+	D3D11_MAPPED_SUBRESOURCE ms;
+	HRESULT hr = d3dDC->Map(_readBackBuffer.get(), 0, D3D11_MAP_READ, 0, &ms);
+	if (FAILED(hr)) {
+		// 视为整帧都已变化
+		return false;
+	}
+
+	std::memcpy(_tileChangeMap.Data(), ms.pData, _tileChangeMap.WordCount() * 4);
+	d3dDC->Unmap(_readBackBuffer.get(), 0);
+
+	_isTileChangeMapValid = true;
+	return _tileChangeMap.IsEmpty();
+}
+
+void FrameSourceBase::_UpdatePrevFrame() noexcept {
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+
+	if (!_isTileChangeMapValid) {
+		d3dDC->CopyResource(_prevFrame.get(), _output.get());
+		return;
+	}
+
+	// 未变化的块和 _prevFrame 相同，只需复制变化的块
+	_tileChangeMap.MergeDirtyRects(_changedRects);
+	for (const DirtyRect& rect : _changedRects) {
+		const D3D11_BOX box{ rect.left, rect.top, 0, rect.right, rect.bottom, 1 };
+		d3dDC->CopySubresourceRegion(_prevFrame.get(), 0, rect.left, rect.top, 0, _output.get(), 0, &box);
+	}
+}
+
+bool FrameSourceBase::_IsDuplicateFrame() {
+	_DispatchDuplicateFrameCheck();
+	// 立即取回结果会使 CPU 等待 GPU
+	return _isTileChangeMapEnabled ? _ReadTileChangeMap() : _ReadDuplicateCheckResult();
+}
+
+void FrameSourceBase::_CheckDuplicateFrameAsync() noexcept {
+	_DispatchDuplicateFrameCheck();
+
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+
+	{
+		// 解除 _resultBuffer 的 UAV 绑定才能作为 SRV 读取
+		ID3D11UnorderedAccessView* uav = nullptr;
+		d3dDC->CSSetUnorderedAccessViews(0, 1, &uav, nullptr);
+	}
+
+	// 不是重复帧时绘制一个像素，以此设置遮挡谓词
+	d3dDC->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_POINTLIST);
+	d3dDC->IASetInputLayout(nullptr);
+	d3dDC->VSSetShader(_dupFramePredicateVS.get(), nullptr, 0);
+	{
+		ID3D11ShaderResourceView* srv = _resultBufferSrv.get();
+		d3dDC->VSSetShaderResources(0, 1, &srv);
+	}
+	d3dDC->PSSetShader(nullptr, nullptr, 0);
+	{
+		const D3D11_VIEWPORT vp{ .Width = 1.0f, .Height = 1.0f, .MaxDepth = 1.0f };
+		d3dDC->RSSetViewports(1, &vp);
+		ID3D11RenderTargetView* rtv = _predicateTargetRtv.get();
+		d3dDC->OMSetRenderTargets(1, &rtv, nullptr);
+	}
+
+	d3dDC->Begin(_dupFramePredicate.get());
+	d3dDC->Draw(1, 0);
+	d3dDC->End(_dupFramePredicate.get());
+
+	{
+		ID3D11ShaderResourceView* srv = nullptr;
+		d3dDC->VSSetShaderResources(0, 1, &srv);
+		ID3D11RenderTargetView* rtv = nullptr;
+		d3dDC->OMSetRenderTargets(1, &rtv, nullptr);
+	}
+
+	// 重复帧无需复制
+	d3dDC->SetPredication(_dupFramePredicate.get(), FALSE);
+	d3dDC->CopyResource(_prevFrame.get(), _output.get());
+	d3dDC->SetPredication(nullptr, FALSE);
+
+	_isDuplicateCheckPending = true;
+}
+
+bool FrameSourceBase::ResolveDuplicateCheck() noexcept {
+	assert(_isDuplicateCheckPending);
+	_isDuplicateCheckPending = false;
+
+	// 渲染已完成，因此不会阻塞
+	const bool isDuplicate = _ReadDuplicateCheckResult();
+	_lastDuplicateCheckResult = isDuplicate
+		? DuplicateFrameCheckResult::Duplicate : DuplicateFrameCheckResult::Unique;
+
+	if (_duplicateFramePredictor) {
+		_duplicateFramePredictor->OnChecked(isDuplicate);
+	}
+
+	return isDuplicate;
+}
+
 }
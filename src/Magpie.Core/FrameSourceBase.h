@@ -1,4 +1,6 @@
 #pragma once
+#include "DuplicateFramePredictor.h"
+#include "TileChangeMap.h"
 
 namespace Magpie {
 
@@ -6,9 +8,10 @@ class DeviceResources;
 class BackendDescriptorStore;
 
 enum class FrameSourceWaitType {
+	// 需要轮询，帧率限制为屏幕刷新率
 	NoWait,
-	WaitForMessage,
-	WaitForFrame
+	// 有新帧时后端线程会收到消息
+	WaitForMessage
 };
 
 enum class FrameSourceState {
@@ -17,6 +20,16 @@ enum class FrameSourceState {
 	Error
 };
 
+// 最近一次 Update 对重复帧的判断
+enum class DuplicateFrameCheckResult {
+	// 没有新帧或未启用重复帧检测
+	NotChecked,
+	// 动态检测跳过了检查
+	Skipped,
+	Unique,
+	Duplicate
+};
+
 class FrameSourceBase {
 public:
 	FrameSourceBase() noexcept;
@@ -41,6 +54,40 @@ public:
 
 	std::pair<uint32_t, uint32_t> GetStatisticsForDynamicDetection() const noexcept;
 
+	// 最近一次从源获取到帧的时间，重复帧也会更新
+	std::chrono::steady_clock::time_point CaptureTime() const noexcept {
+		return _captureTime;
+	}
+
+	DuplicateFrameCheckResult LastDuplicateCheckResult() const noexcept {
+		return _lastDuplicateCheckResult;
+	}
+
+	// 异步检查重复帧时 Update 不等待检查结果，而是返回 NewFrame 并提供此谓词，渲染效果时应以
+	// SetPredication(predicate, FALSE) 使 GPU 跳过重复帧。没有待定的检查时返回 nullptr。
+	ID3D11Predicate* DuplicateFramePredicate() const noexcept {
+		return _isDuplicateCheckPending ? _dupFramePredicate.get() : nullptr;
+	}
+
+	// 渲染完成后调用以取得异步检查的结果，此时不会阻塞。返回是否为重复帧
+	bool ResolveDuplicateCheck() noexcept;
+
+	// 渲染失败时调用，放弃待定的检查，结果不报告给重复帧预测器
+	void CancelDuplicateCheck() noexcept {
+		_isDuplicateCheckPending = false;
+		_lastDuplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
+	}
+
+	// 启用块级变化检测时，如果最近一次 Update 返回 NewFrame 时检查了重复帧，返回相对前一帧变化的块。
+	// 返回 nullptr 时应视为整帧都已变化。
+	const TileChangeMap* ChangedTiles() const noexcept {
+		return _isTileChangeMapValid ? &_tileChangeMap : nullptr;
+	}
+
+	// 最近一次 Update 返回 NewFrame 时当前帧相对前一帧变化的区域。优先使用块级变化检测的结果，
+	// 其次是捕获 API 提供的脏矩形，都没有时为整个帧
+	void GetDirtyRegion(DirtyRegion& region) const;
+
 	virtual const char* Name() const noexcept = 0;
 
 	virtual bool IsScreenCapture() const noexcept = 0;
@@ -84,6 +131,10 @@ protected:
 	winrt::com_ptr<ID3D11ComputeShader> _dupFrameCS;
 	std::pair<uint32_t, uint32_t> _dispatchCount;
 
+	// 由 _Update 填充，单位为 _output 中的像素。_hasDirtyRects 为 false 时应视为整个帧都已变化
+	std::vector<DirtyRect> _dirtyRects;
+	bool _hasDirtyRects = false;
+
 	bool _roundCornerDisabled = false;
 	bool _windowResizingDisabled = false;
 
@@ -92,14 +143,43 @@ private:
 
 	bool _IsDuplicateFrame();
 
+	void _DispatchDuplicateFrameCheck() noexcept;
+
+	bool _InitAsyncDuplicateFrameCheck() noexcept;
+
+	void _CheckDuplicateFrameAsync() noexcept;
+
+	bool _ReadDuplicateCheckResult() noexcept;
+
+	bool _InitTileChangeMap() noexcept;
+
+	// 返回是否为重复帧
+	bool _ReadTileChangeMap() noexcept;
+
+	// 检查重复帧后将当前帧复制到 _prevFrame，如果有块级变化信息则只复制变化的块
+	void _UpdatePrevFrame() noexcept;
+
 	// 用于检查重复帧
 	winrt::com_ptr<ID3D11Texture2D> _prevFrame;
 	winrt::com_ptr<ID3D11ShaderResourceView> _prevFrameSrv;
-	uint16_t _nextSkipCount;
-	uint16_t _framesLeft;
+	// 异步检查重复帧时使用
+	winrt::com_ptr<ID3D11ShaderResourceView> _resultBufferSrv;
+	winrt::com_ptr<ID3D11VertexShader> _dupFramePredicateVS;
+	winrt::com_ptr<ID3D11Texture2D> _predicateTarget;
+	winrt::com_ptr<ID3D11RenderTargetView> _predicateTargetRtv;
+	winrt::com_ptr<ID3D11Predicate> _dupFramePredicate;
+	bool _isDuplicateCheckPending = false;
+	// 块级变化检测时使用
+	TileChangeMap _tileChangeMap;
+	std::vector<DirtyRect> _changedRects;
+	bool _isTileChangeMapEnabled = false;
+	bool _isTileChangeMapValid = false;
+	// 动态检测重复帧时使用
+	std::unique_ptr<DuplicateFramePredictor> _duplicateFramePredictor;
 	// (预测错误帧数, 总计跳过帧数)
 	std::atomic<std::pair<uint32_t, uint32_t>> _statistics;
-	bool _isCheckingForDuplicateFrame = true;
+	std::chrono::steady_clock::time_point _captureTime;
+	DuplicateFrameCheckResult _lastDuplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
 };
 
 }
@@ -0,0 +1,293 @@
+#include "pch.h"
+#include "FrameTraceRecorder.h"
+#include "Logger.h"
+#include "StrHelper.h"
+#include "CommonSharedConstants.h"
+
+using namespace std::chrono;
+
+namespace Magpie {
+
+// 超过此时间仍未补全的记录将直接写入
+static constexpr milliseconds MAX_PENDING_TIME = 1s;
+// 缓冲区超过此大小时写入文件，避免每帧都执行 IO
+static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+static const char* StepTimerStatusToString(StepTimerStatus status) noexcept {
+	switch (status) {
+	case StepTimerStatus::WaitForNewFrame:
+		return "new";
+	case StepTimerStatus::WaitForFPSLimiter:
+		return "fps_limited";
+	case StepTimerStatus::ForceNewFrame:
+		return "forced";
+	default:
+		return "";
+	}
+}
+
+static const char* SourceStateToString(const std::optional<FrameSourceState>& state) noexcept {
+	if (!state) {
+		// 没有调用 FrameSourceBase::Update
+		return "";
+	}
+
+	switch (*state) {
+	case FrameSourceState::NewFrame:
+		return "new";
+	case FrameSourceState::Waiting:
+		return "waiting";
+	case FrameSourceState::Error:
+		return "error";
+	default:
+		return "";
+	}
+}
+
+static const char* DuplicateCheckResultToString(DuplicateFrameCheckResult result) noexcept {
+	switch (result) {
+	case DuplicateFrameCheckResult::NotChecked:
+		return "none";
+	case DuplicateFrameCheckResult::Skipped:
+		return "skipped";
+	case DuplicateFrameCheckResult::Unique:
+		return "unique";
+	case DuplicateFrameCheckResult::Duplicate:
+		return "duplicate";
+	default:
+		return "";
+	}
+}
+
+FrameTraceRecorder::~FrameTraceRecorder() noexcept {
+	if (!_file) {
+		return;
+	}
+
+	// 写入所有剩余的记录
+	_ApplyPresents();
+	for (const _Record& record : _pendingRecords) {
+		_WriteRecord(record);
+	}
+	_Flush();
+
+	Logger::Get().Info(fmt::format("已记录 {} 帧", _nextFrameIdx - 1));
+}
+
+void FrameTraceRecorder::AddEffect(std::string_view name, uint32_t passCount) noexcept {
+	assert(!_file);
+	_effects.emplace_back(name, passCount);
+}
+
+bool FrameTraceRecorder::Initialize() noexcept {
+	if (_wfopen_s(_file.put(), CommonSharedConstants::FRAME_TRACE_PATH, L"wb") || !_file) {
+		Logger::Get().Error(StrHelper::Concat("打开文件 ",
+			StrHelper::UTF16ToUTF8(CommonSharedConstants::FRAME_TRACE_PATH), " 失败"));
+		return false;
+	}
+
+	_buffer = "frame,step_timer,source,duplicate,frame_begin,capture,render_start,render_end,present";
+	for (const auto& [name, _] : _effects) {
+		// 效果名不会包含引号，但可能包含逗号
+		fmt::format_to(std::back_inserter(_buffer), ",\"{}\"", name);
+	}
+	_buffer.push_back('\n');
+	_buffer.reserve(FLUSH_THRESHOLD + 1024);
+
+	// 序号从 1 开始，0 保留给 EffectsProfiler 的默认值
+	_nextFrameIdx = 1;
+	_startTime = steady_clock::now();
+
+	Logger::Get().Info(StrHelper::Concat("开始记录帧时间线: ",
+		StrHelper::UTF16ToUTF8(CommonSharedConstants::FRAME_TRACE_PATH)));
+	return true;
+}
+
+void FrameTraceRecorder::OnFrameBegin(StepTimerStatus status) noexcept {
+	if (!_file) {
+		return;
+	}
+
+	_curRecord = {};
+	_curRecord.frameIdx = _nextFrameIdx++;
+	_curRecord.frameBegin = steady_clock::now();
+	_curRecord.stepTimerStatus = status;
+}
+
+void FrameTraceRecorder::OnFrameCaptured(
+	FrameSourceState state,
+	DuplicateFrameCheckResult duplicateCheckResult,
+	steady_clock::time_point captureTime
+) noexcept {
+	if (!_file) {
+		return;
+	}
+
+	_curRecord.sourceState = state;
+	_curRecord.duplicateCheckResult = duplicateCheckResult;
+	// 重复帧也是新捕获的帧
+	if (state == FrameSourceState::NewFrame || duplicateCheckResult == DuplicateFrameCheckResult::Duplicate) {
+		_curRecord.capture = captureTime;
+	}
+}
+
+void FrameTraceRecorder::OnRenderBegin() noexcept {
+	if (!_file) {
+		return;
+	}
+
+	_curRecord.renderStart = steady_clock::now();
+}
+
+void FrameTraceRecorder::OnRenderEnd(uint64_t presentKey, steady_clock::time_point renderEnd) noexcept {
+	if (!_file) {
+		return;
+	}
+
+	_curRecord.presentKey = presentKey;
+	_curRecord.renderEnd = renderEnd;
+}
+
+void FrameTraceRecorder::OnFrameEnd() noexcept {
+	if (!_file) {
+		return;
+	}
+
+	_pendingRecords.push_back(std::move(_curRecord));
+
+	_ApplyPresents();
+
+	// 按顺序写入已补全的记录
+	const steady_clock::time_point now = steady_clock::now();
+	while (!_pendingRecords.empty() && _IsRecordComplete(_pendingRecords.front(), now)) {
+		_WriteRecord(_pendingRecords.front());
+		_pendingRecords.pop_front();
+	}
+}
+
+void FrameTraceRecorder::OnGpuTimings(uint64_t frameIdx, std::span<const float> passTimings) noexcept {
+	if (!_file) {
+		return;
+	}
+
+	_lastGpuFrameIdx = frameIdx;
+
+	// 当前帧可能还未加入 _pendingRecords
+	_Record* record = nullptr;
+	if (_curRecord.frameIdx == frameIdx) {
+		record = &_curRecord;
+	} else {
+		auto it = std::find_if(_pendingRecords.begin(), _pendingRecords.end(),
+			[frameIdx](const _Record& r) { return r.frameIdx == frameIdx; });
+		if (it == _pendingRecords.end()) {
+			// 记录已超时写入
+			return;
+		}
+		record = &*it;
+	}
+
+	// 将通道用时累加为效果用时
+	record->effectTimings.resize(_effects.size());
+	uint32_t passIdx = 0;
+	for (size_t i = 0; i < _effects.size(); ++i) {
+		float total = 0.0f;
+		for (uint32_t j = 0; j < _effects[i].second; ++j) {
+			total += passTimings[passIdx++];
+		}
+		record->effectTimings[i] = total;
+	}
+}
+
+void FrameTraceRecorder::OnFramePresented(uint64_t presentKey, steady_clock::time_point presentTime) noexcept {
+	if (!_file) {
+		return;
+	}
+
+	auto lock = _presentLock.lock_exclusive();
+	_presents.emplace_back(presentKey, presentTime);
+}
+
+void FrameTraceRecorder::_ApplyPresents() noexcept {
+	SmallVector<std::pair<uint64_t, steady_clock::time_point>> presents;
+	{
+		auto lock = _presentLock.lock_exclusive();
+		presents.swap(_presents);
+	}
+
+	for (const auto& [key, time] : presents) {
+		_lastPresentKey = std::max(_lastPresentKey, key);
+
+		auto it = std::find_if(_pendingRecords.begin(), _pendingRecords.end(),
+			[key](const _Record& r) { return r.presentKey == key; });
+		if (it != _pendingRecords.end()) {
+			it->present = time;
+		}
+	}
+}
+
+bool FrameTraceRecorder::_IsRecordComplete(const _Record& record, steady_clock::time_point now) const noexcept {
+	if (now - record.frameBegin > MAX_PENDING_TIME) {
+		return true;
+	}
+
+	if (record.presentKey == 0) {
+		// 没有渲染的帧无需等待
+		return true;
+	}
+
+	// 前端总是呈现最新的帧，更晚的帧已呈现说明这一帧被丢弃
+	if (record.present == steady_clock::time_point{} && record.presentKey > _lastPresentKey) {
+		return false;
+	}
+
+	// EffectsProfiler 按顺序报告，更晚的帧已有结果说明这一帧没有被测量
+	if (record.effectTimings.empty() && record.frameIdx > _lastGpuFrameIdx) {
+		return false;
+	}
+
+	return true;
+}
+
+void FrameTraceRecorder::_WriteRecord(const _Record& record) noexcept {
+	auto appendTime = [&](steady_clock::time_point time) {
+		_buffer.push_back(',');
+		if (time != steady_clock::time_point{}) {
+			fmt::format_to(std::back_inserter(_buffer), "{:.3f}",
+				duration_cast<nanoseconds>(time - _startTime).count() / 1e6);
+		}
+	};
+
+	fmt::format_to(std::back_inserter(_buffer), "{},{},{},{}", record.frameIdx,
+		StepTimerStatusToString(record.stepTimerStatus),
+		SourceStateToString(record.sourceState),
+		DuplicateCheckResultToString(record.duplicateCheckResult));
+	appendTime(record.frameBegin);
+	appendTime(record.capture);
+	appendTime(record.renderStart);
+	appendTime(record.renderEnd);
+	appendTime(record.present);
+
+	if (record.effectTimings.empty()) {
+		_buffer.append(_effects.size(), ',');
+	} else {
+		for (float timing : record.effectTimings) {
+			fmt::format_to(std::back_inserter(_buffer), ",{:.4f}", timing);
+		}
+	}
+	_buffer.push_back('\n');
+
+	if (_buffer.size() >= FLUSH_THRESHOLD) {
+		_Flush();
+	}
+}
+
+void FrameTraceRecorder::_Flush() noexcept {
+	if (_buffer.empty()) {
+		return;
+	}
+
+	fwrite(_buffer.data(), 1, _buffer.size(), _file.get());
+	_buffer.clear();
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <deque>
+#include "SmallVector.h"
+#include "StepTimer.h"
+#include "FrameSourceBase.h"
+
+namespace Magpie {
+
+// 将后端每次循环的时间线记录到 CSV 中，供 FrameTraceAnalyzer 等工具离线分析。
+// 一帧的 GPU 用时和呈现时间要在数帧后才能得到，因此记录先暂存，补全后按顺序写入。
+// 除 OnFramePresented 外都只能由后端线程调用。
+class FrameTraceRecorder {
+public:
+	FrameTraceRecorder() = default;
+	FrameTraceRecorder(const FrameTraceRecorder&) = delete;
+	FrameTraceRecorder(FrameTraceRecorder&&) = delete;
+
+	~FrameTraceRecorder() noexcept;
+
+	// 应在 Initialize 之前添加所有效果
+	void AddEffect(std::string_view name, uint32_t passCount) noexcept;
+
+	bool Initialize() noexcept;
+
+	bool IsRecording() const noexcept {
+		return (bool)_file;
+	}
+
+	// 当前帧的序号，用于匹配 EffectsProfiler 的结果
+	uint64_t FrameIndex() const noexcept {
+		return _curRecord.frameIdx;
+	}
+
+	void OnFrameBegin(StepTimerStatus status) noexcept;
+
+	void OnFrameCaptured(
+		FrameSourceState state,
+		DuplicateFrameCheckResult duplicateCheckResult,
+		std::chrono::steady_clock::time_point captureTime
+	) noexcept;
+
+	void OnRenderBegin() noexcept;
+
+	// presentKey 为写入共享纹理时使用的键，前端以此报告呈现
+	void OnRenderEnd(uint64_t presentKey, std::chrono::steady_clock::time_point renderEnd) noexcept;
+
+	void OnFrameEnd() noexcept;
+
+	// 由 EffectsProfiler 的回调调用
+	void OnGpuTimings(uint64_t frameIdx, std::span<const float> passTimings) noexcept;
+
+	// 由前端线程调用
+	void OnFramePresented(uint64_t presentKey, std::chrono::steady_clock::time_point presentTime) noexcept;
+
+private:
+	struct _Record {
+		uint64_t frameIdx = 0;
+		// 0 表示这一帧没有渲染
+		uint64_t presentKey = 0;
+		std::chrono::steady_clock::time_point frameBegin;
+		std::chrono::steady_clock::time_point capture;
+		std::chrono::steady_clock::time_point renderStart;
+		std::chrono::steady_clock::time_point renderEnd;
+		std::chrono::steady_clock::time_point present;
+		// 每个效果的 GPU 用时，为空表示没有测量结果
+		SmallVector<float> effectTimings;
+		StepTimerStatus stepTimerStatus = StepTimerStatus::WaitForNewFrame;
+		std::optional<FrameSourceState> sourceState;
+		DuplicateFrameCheckResult duplicateCheckResult = DuplicateFrameCheckResult::NotChecked;
+	};
+
+	void _ApplyPresents() noexcept;
+
+	bool _IsRecordComplete(const _Record& record, std::chrono::steady_clock::time_point now) const noexcept;
+
+	void _WriteRecord(const _Record& record) noexcept;
+
+	void _Flush() noexcept;
+
+	// 只能由后端线程访问
+	SmallVector<std::pair<std::string, uint32_t>> _effects;
+	_Record _curRecord;
+	uint64_t _nextFrameIdx = 0;
+	std::deque<_Record> _pendingRecords;
+	// EffectsProfiler 最近一次报告的帧，更早的帧不会再有结果
+	uint64_t _lastGpuFrameIdx = 0;
+	uint64_t _lastPresentKey = 0;
+
+	// 由 _presentLock 保护
+	wil::srwlock _presentLock;
+	SmallVector<std::pair<uint64_t, std::chrono::steady_clock::time_point>> _presents;
+
+	wil::unique_file _file;
+	std::string _buffer;
+	std::chrono::steady_clock::time_point _startTime;
+};
+
+}
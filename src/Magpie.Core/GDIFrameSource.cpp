@@ -39,42 +39,55 @@ bool GDIFrameSource::_Initialize() noexcept {
 		return false;
 	}
 
+	const uint32_t width = uint32_t(_frameRect.right - _frameRect.left);
+	const uint32_t height = uint32_t(_frameRect.bottom - _frameRect.top);
+
 	_output = DirectXHelper::CreateTexture2D(
 		_deviceResources->GetD3DDevice(),
 		DXGI_FORMAT_B8G8R8A8_UNORM,
-		_frameRect.right - _frameRect.left,
-		_frameRect.bottom - _frameRect.top,
-		D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET,
-		D3D11_USAGE_DEFAULT,
-		D3D11_RESOURCE_MISC_GDI_COMPATIBLE
+		width,
+		height,
+		D3D11_BIND_SHADER_RESOURCE
 	);
 	if (!_output) {
 		Logger::Get().Error("创建纹理失败");
 		return false;
 	}
 
-	_dxgiSurface = _output.try_as<IDXGISurface1>();
-	if (!_dxgiSurface) {
-		Logger::Get().Error("从 Texture2D 获取 IDXGISurface1 失败");
+	_hdcMem.reset(CreateCompatibleDC(NULL));
+	if (!_hdcMem) {
+		Logger::Get().Win32Error("CreateCompatibleDC 失败");
 		return false;
 	}
 
+	const BITMAPINFO bi{
+		.bmiHeader = {
+			.biSize = sizeof(BITMAPINFOHEADER),
+			.biWidth = (LONG)width,
+			// 自上而下
+			.biHeight = -(LONG)height,
+			.biPlanes = 1,
+			.biBitCount = 32,
+			.biCompression = BI_RGB
+		}
+	};
+	for (uint32_t i = 0; i < 2; ++i) {
+		void* pixels = nullptr;
+		_bitmaps[i].reset(CreateDIBSection(_hdcMem.get(), &bi, DIB_RGB_COLORS, &pixels, NULL, 0));
+		if (!_bitmaps[i]) {
+			Logger::Get().Win32Error("CreateDIBSection 失败");
+			return false;
+		}
+		_pixels[i] = (const uint8_t*)pixels;
+	}
+
+	_tileChangeMap.Initialize(width, height);
+
 	Logger::Get().Info("GDIFrameSource 初始化完成");
 	return true;
 }
 
 FrameSourceState GDIFrameSource::_Update() noexcept {
-	HDC hdcDest;
-	HRESULT hr = _dxgiSurface->GetDC(TRUE, &hdcDest);
-	if (FAILED(hr)) {
-		Logger::Get().ComError("从 Texture2D 获取 IDXGISurface1 失败", hr);
-		return FrameSourceState::Error;
-	}
-
-	auto se = wil::scope_exit([&]() {
-		_dxgiSurface->ReleaseDC(nullptr);
-	});
-
 	const HWND hwndSrc = ScalingWindow::Get().HwndSrc();
 	wil::unique_hdc_window hdcSrc(wil::window_dc(GetDCEx(hwndSrc, NULL, DCX_WINDOW), hwndSrc));
 	if (!hdcSrc) {
@@ -82,14 +95,79 @@ FrameSourceState GDIFrameSource::_Update() noexcept {
 		return FrameSourceState::Error;
 	}
 
-	if (!BitBlt(hdcDest, 0, 0, _frameRect.right - _frameRect.left, _frameRect.bottom - _frameRect.top,
-		hdcSrc.get(), _frameRect.left, _frameRect.top, SRCCOPY)
-	) {
+	SelectObject(_hdcMem.get(), _bitmaps[_curBuffer].get());
+
+	const uint32_t width = uint32_t(_frameRect.right - _frameRect.left);
+	const uint32_t height = uint32_t(_frameRect.bottom - _frameRect.top);
+	if (!BitBlt(_hdcMem.get(), 0, 0, width, height, hdcSrc.get(), _frameRect.left, _frameRect.top, SRCCOPY)) {
 		Logger::Get().Win32Error("BitBlt 失败");
 		return FrameSourceState::Error;
 	}
 
+	// 确保 BitBlt 已写入缓冲区
+	GdiFlush();
+
+	if (!_FindChangedTiles()) {
+		// 保留前一帧以便下次比较
+		return FrameSourceState::Waiting;
+	}
+
+	const uint8_t* pixels = _pixels[_curBuffer];
+	const uint32_t rowPitch = width * 4;
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+
+	if (_hasPrevFrame) {
+		// 只上传变化的部分
+		_tileChangeMap.MergeDirtyRects(_dirtyRects);
+		for (const DirtyRect& rect : _dirtyRects) {
+			const D3D11_BOX box{ rect.left, rect.top, 0, rect.right, rect.bottom, 1 };
+			d3dDC->UpdateSubresource(_output.get(), 0, &box,
+				pixels + rect.top * rowPitch + rect.left * 4, rowPitch, 0);
+		}
+		_hasDirtyRects = true;
+	} else {
+		d3dDC->UpdateSubresource(_output.get(), 0, nullptr, pixels, rowPitch, 0);
+		_hasPrevFrame = true;
+	}
+
+	_curBuffer = 1 - _curBuffer;
 	return FrameSourceState::NewFrame;
 }
 
+bool GDIFrameSource::_FindChangedTiles() noexcept {
+	if (!_hasPrevFrame) {
+		return true;
+	}
+
+	const uint32_t width = uint32_t(_frameRect.right - _frameRect.left);
+	const uint32_t height = uint32_t(_frameRect.bottom - _frameRect.top);
+	const uint32_t rowPitch = width * 4;
+	const uint8_t* cur = _pixels[_curBuffer];
+	const uint8_t* prev = _pixels[1 - _curBuffer];
+
+	_tileChangeMap.Clear();
+	bool hasChange = false;
+
+	for (uint32_t ty = 0; ty < _tileChangeMap.TileCountY(); ++ty) {
+		const uint32_t top = ty * TileChangeMap::TILE_SIZE;
+		const uint32_t bottom = std::min(top + TileChangeMap::TILE_SIZE, height);
+
+		for (uint32_t tx = 0; tx < _tileChangeMap.TileCountX(); ++tx) {
+			const uint32_t left = tx * TileChangeMap::TILE_SIZE;
+			const uint32_t rowBytes = (std::min(left + TileChangeMap::TILE_SIZE, width) - left) * 4;
+
+			for (uint32_t y = top; y < bottom; ++y) {
+				const size_t offset = (size_t)y * rowPitch + left * 4;
+				if (std::memcmp(cur + offset, prev + offset, rowBytes) != 0) {
+					_tileChangeMap.SetDirty(tx, ty);
+					hasChange = true;
+					break;
+				}
+			}
+		}
+	}
+
+	return hasChange;
+}
+
 }
@@ -3,6 +3,8 @@
 
 namespace Magpie {
 
+// BitBlt 到 CPU 上的缓冲区，和前一帧逐块比较，只上传变化的部分。没有变化时返回 Waiting，
+// 效果无需渲染。
 class GDIFrameSource final : public FrameSourceBase {
 public:
 	virtual ~GDIFrameSource() {}
@@ -33,8 +35,20 @@ protected:
 	}
 
 private:
+	// 将当前帧和前一帧比较，返回是否有变化的块
+	bool _FindChangedTiles() noexcept;
+
 	RECT _frameRect{};
-	winrt::com_ptr<IDXGISurface1> _dxgiSurface;
+
+	// 两个缓冲区交替作为当前帧和前一帧，_output 的内容总是和前一帧相同
+	std::array<wil::unique_hbitmap, 2> _bitmaps;
+	std::array<const uint8_t*, 2> _pixels{};
+	// 必须在 _bitmaps 之前销毁
+	wil::unique_hdc _hdcMem;
+	uint32_t _curBuffer = 0;
+	bool _hasPrevFrame = false;
+
+	TileChangeMap _tileChangeMap;
 };
 
 }
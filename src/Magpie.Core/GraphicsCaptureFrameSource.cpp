@@ -70,17 +70,24 @@ bool GraphicsCaptureFrameSource::_Initialize() noexcept {
 		}
 	}
 
-	_output = DirectXHelper::CreateTexture2D(
+	_copyTarget = DirectXHelper::CreateTexture2D(
 		d3dDevice,
 		DXGI_FORMAT_B8G8R8A8_UNORM,
 		_frameBox.right - _frameBox.left,
 		_frameBox.bottom - _frameBox.top,
 		D3D11_BIND_SHADER_RESOURCE
 	);
-	if (!_output) {
+	if (!_copyTarget) {
 		Logger::Get().Error("创建纹理失败");
 		return false;
 	}
+	// 零复制模式下在获取到第一帧前也作为输出
+	_output = _copyTarget;
+
+	if (ScalingWindow::Get().Options().IsZeroCopyCaptureEnabled()) {
+		_isZeroCopy = _CanUseZeroCopy();
+		Logger::Get().Info(_isZeroCopy ? "已启用零复制捕获" : "无法使用零复制捕获");
+	}
 
 	if (!_StartCapture()) {
 		Logger::Get().Error("_StartCapture 失败");
@@ -116,11 +123,51 @@ FrameSourceState GraphicsCaptureFrameSource::_Update() noexcept {
 		return FrameSourceState::Error;
 	}
 
+	if (_isZeroCopy) {
+		D3D11_TEXTURE2D_DESC desc;
+		withFrame->GetDesc(&desc);
+
+		if ((desc.BindFlags & D3D11_BIND_SHADER_RESOURCE) &&
+			desc.Width == _frameBox.right && desc.Height == _frameBox.bottom) {
+			// 上一帧已渲染完毕，可以归还帧缓冲池
+			if (_heldFrame) {
+				_heldFrame.Close();
+			}
+			_heldFrame = std::move(frame);
+			_output = std::move(withFrame);
+			return FrameSourceState::NewFrame;
+		}
+
+		Logger::Get().Warn("帧的纹理无法直接作为输出，回落到复制");
+		_isZeroCopy = false;
+		if (_heldFrame) {
+			_heldFrame.Close();
+			_heldFrame = nullptr;
+		}
+		_output = _copyTarget;
+	}
+
 	_deviceResources->GetD3DDC()->CopySubresourceRegion(_output.get(), 0, 0, 0, 0, withFrame.get(), 0, &_frameBox);
 
 	return FrameSourceState::NewFrame;
 }
 
+bool GraphicsCaptureFrameSource::_CanUseZeroCopy() const noexcept {
+	// 效果总是从 (0,0) 开始读取整个输入
+	if (_frameBox.left != 0 || _frameBox.top != 0) {
+		return false;
+	}
+
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+
+	// 这些功能都会复制帧，直接读取帧缓冲池中的纹理没有收益
+	if (options.IsCaptureThreadEnabled()) {
+		return false;
+	}
+
+	return options.Is3DGameMode() || options.duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Never;
+}
+
 void GraphicsCaptureFrameSource::OnCursorVisibilityChanged(bool isVisible, bool onDestory) noexcept {
 	// 显示光标时必须重启捕获
 	if (isVisible) {
@@ -408,7 +455,8 @@ bool GraphicsCaptureFrameSource::_StartCapture() noexcept {
 		_captureFramePool = winrt::Direct3D11CaptureFramePool::Create(
 			_wrappedD3DDevice,
 			winrt::DirectXPixelFormat::B8G8R8A8UIntNormalized,
-			1,	// 帧的缓存数量
+			// 帧的缓存数量。零复制模式下总是持有一帧，需要额外的缓存接收新帧
+			_isZeroCopy ? 2 : 1,
 			{ (int)_frameBox.right, (int)_frameBox.bottom } // 帧的尺寸为包含源窗口的最小尺寸
 		);
 
@@ -451,6 +499,11 @@ bool GraphicsCaptureFrameSource::_StartCapture() noexcept {
 }
 
 void GraphicsCaptureFrameSource::_StopCapture() noexcept {
+	// _output 仍引用纹理，因此效果可以继续读取
+	if (_heldFrame) {
+		_heldFrame.Close();
+		_heldFrame = nullptr;
+	}
 	if (_captureSession) {
 		_captureSession.Close();
 		_captureSession = nullptr;
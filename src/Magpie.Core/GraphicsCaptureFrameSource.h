@@ -52,6 +52,9 @@ private:
 
 	void _RemoveOwnerFromAltTabList(HWND hwndSrc) noexcept;
 
+	// 检查是否可以直接将帧缓冲池中的纹理作为输出
+	bool _CanUseZeroCopy() const noexcept;
+
 	LONG_PTR _originalSrcExStyle = 0;
 	LONG_PTR _originalOwnerExStyle = 0;
 	winrt::com_ptr<ITaskbarList> _taskbarList;
@@ -60,6 +63,12 @@ private:
 
 	bool _isScreenCapture = false;
 
+	// 零复制模式下 _output 为最新一帧的纹理，这一帧被持有直到获取到下一帧，即效果读取完毕后。
+	// 帧中的纹理不符合要求时回落到复制到 _copyTarget
+	bool _isZeroCopy = false;
+	winrt::com_ptr<ID3D11Texture2D> _copyTarget;
+	winrt::Windows::Graphics::Capture::Direct3D11CaptureFrame _heldFrame{ nullptr };
+
 	winrt::Windows::Graphics::Capture::GraphicsCaptureItem _captureItem{ nullptr };
 	winrt::Windows::Graphics::Capture::Direct3D11CaptureFramePool _captureFramePool{ nullptr };
 	winrt::Windows::Graphics::Capture::GraphicsCaptureSession _captureSession{ nullptr };
@@ -9,7 +9,9 @@
 #include "Logger.h"
 #include "Win32Helper.h"
 #include "ScalingWindow.h"
-#include "CursorManager.h"
+#include "DirectXHelper.h"
+#include "shaders/SimpleVS.h"
+#include "shaders/SimplePS.h"
 
 namespace Magpie {
 
@@ -40,6 +42,13 @@ bool ImGuiImpl::Initialize(DeviceResources* deviceResources) noexcept {
 		return false;
 	}
 
+	_deviceResources = deviceResources;
+
+	if (!_CreateCacheResources()) {
+		Logger::Get().Error("_CreateCacheResources 失败");
+		return false;
+	}
+
 	return true;
 }
 
@@ -56,6 +65,7 @@ void ImGuiImpl::NewFrame() noexcept {
 
 	// Update OS mouse position
 	_UpdateMousePos();
+	_hasNewInput = false;
 
 	// 不接受键盘输入
 	if (io.WantCaptureKeyboard) {
@@ -92,21 +102,113 @@ void ImGuiImpl::NewFrame() noexcept {
 }
 
 void ImGuiImpl::Draw() noexcept {
-	const RECT& scalingRect = ScalingWindow::Get().WndRect();
-	const RECT& destRect = ScalingWindow::Get().Renderer().DestRect();
-
 	ImGui::Render();
 	ImDrawData& drawData = *ImGui::GetDrawData();
-	drawData.DisplayPos = ImVec2(
-		float(scalingRect.left - destRect.left),
-		float(scalingRect.top - destRect.top)
-	);
-	drawData.DisplaySize = ImVec2(
-		float(destRect.right - scalingRect.left),
-		float(destRect.bottom - scalingRect.top)
-	);
 
+	if (!_cacheTexture && !_CreateCacheTexture()) {
+		// 回退到直接渲染到当前渲染目标
+		const RECT& scalingRect = ScalingWindow::Get().WndRect();
+		const RECT& destRect = ScalingWindow::Get().Renderer().DestRect();
+		drawData.DisplayPos = ImVec2(
+			float(scalingRect.left - destRect.left),
+			float(scalingRect.top - destRect.top)
+		);
+		drawData.DisplaySize = ImVec2(
+			float(destRect.right - scalingRect.left),
+			float(destRect.bottom - scalingRect.top)
+		);
+
+		_backend.RenderDrawData(drawData);
+		return;
+	}
+
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+
+	// 渲染到缓存纹理后需还原渲染目标
+	winrt::com_ptr<ID3D11RenderTargetView> curRtv;
+	d3dDC->OMGetRenderTargets(1, curRtv.put(), nullptr);
+
+	static constexpr FLOAT TRANSPARENT_BLACK[4]{};
+	d3dDC->ClearRenderTargetView(_cacheRtv.get(), TRANSPARENT_BLACK);
+	{
+		ID3D11RenderTargetView* t = _cacheRtv.get();
+		d3dDC->OMSetRenderTargets(1, &t, nullptr);
+	}
+
+	// 缓存纹理和输出区域尺寸相同
+	drawData.DisplayPos = ImVec2();
+	drawData.DisplaySize = ImGui::GetIO().DisplaySize;
 	_backend.RenderDrawData(drawData);
+
+	{
+		ID3D11RenderTargetView* t = curRtv.get();
+		d3dDC->OMSetRenderTargets(1, &t, nullptr);
+	}
+
+	DrawCached();
+}
+
+void ImGuiImpl::DrawCached() noexcept {
+	if (!_cacheTexture) {
+		return;
+	}
+
+	const RECT& scalingRect = ScalingWindow::Get().WndRect();
+	const RECT& destRect = ScalingWindow::Get().Renderer().DestRect();
+
+	ID3D11DeviceContext4* d3dDC = _deviceResources->GetD3DDC();
+	d3dDC->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	d3dDC->IASetInputLayout(_cacheIL.get());
+	{
+		ID3D11Buffer* vtxBuffer = _cacheVtxBuffer.get();
+		UINT stride = sizeof(float) * 4;
+		UINT offset = 0;
+		d3dDC->IASetVertexBuffers(0, 1, &vtxBuffer, &stride, &offset);
+	}
+	d3dDC->VSSetShader(_cacheVS.get(), nullptr, 0);
+
+	{
+		const D3D11_VIEWPORT vp{
+			.TopLeftX = float(destRect.left - scalingRect.left),
+			.TopLeftY = float(destRect.top - scalingRect.top),
+			.Width = float(destRect.right - destRect.left),
+			.Height = float(destRect.bottom - destRect.top),
+			.MinDepth = 0.0f,
+			.MaxDepth = 1.0f
+		};
+		d3dDC->RSSetViewports(1, &vp);
+		d3dDC->RSSetState(nullptr);
+	}
+
+	d3dDC->PSSetShader(_cachePS.get(), nullptr, 0);
+	{
+		ID3D11ShaderResourceView* t = _cacheSrv.get();
+		d3dDC->PSSetShaderResources(0, 1, &t);
+	}
+	{
+		ID3D11SamplerState* t = _deviceResources->GetSampler(
+			D3D11_FILTER_MIN_MAG_MIP_POINT, D3D11_TEXTURE_ADDRESS_CLAMP);
+		d3dDC->PSSetSamplers(0, 1, &t);
+	}
+	d3dDC->OMSetBlendState(_cacheBlendState.get(), nullptr, 0xffffffff);
+
+	d3dDC->Draw(4, 0);
+
+	// 解除绑定，下次渲染 ImGui 时缓存纹理将作为渲染目标
+	{
+		ID3D11ShaderResourceView* t = nullptr;
+		d3dDC->PSSetShaderResources(0, 1, &t);
+	}
+}
+
+bool ImGuiImpl::HasNewInput() const noexcept {
+	// 拖拽时即使光标不动也应重新渲染
+	if (_hasNewInput || ImGui::IsAnyMouseDown()) {
+		return true;
+	}
+
+	const ImVec2 mousePos = _CalcMousePos();
+	return mousePos.x != _lastMousePos.x || mousePos.y != _lastMousePos.y;
 }
 
 void ImGuiImpl::Tooltip(const char* content, float maxWidth) noexcept {
@@ -136,33 +238,144 @@ void ImGuiImpl::Tooltip(const char* content, float maxWidth) noexcept {
 	ImGui::End();
 }
 
-void ImGuiImpl::_UpdateMousePos() noexcept {
-	ImGuiIO& io = ImGui::GetIO();
-	io.MousePos = ImVec2(-FLT_MAX, -FLT_MAX);
-
+ImVec2 ImGuiImpl::_CalcMousePos() const noexcept {
 	const CursorManager& cursorManager = ScalingWindow::Get().CursorManager();
 
 	if (cursorManager.IsCursorCapturedOnForeground()) {
 		// 光标被前台窗口捕获时应避免造成光标跳跃
-		return;
+		return ImVec2(-FLT_MAX, -FLT_MAX);
 	}
 
 	const POINT cursorPos = cursorManager.CursorPos();
 	if (cursorPos.x == std::numeric_limits<LONG>::max()) {
 		// 无光标
-		return;
+		return ImVec2(-FLT_MAX, -FLT_MAX);
 	}
 	
 	const RECT& scalingRect = ScalingWindow::Get().WndRect();
 	const RECT& destRect = ScalingWindow::Get().Renderer().DestRect();
 
-	io.MousePos.x = float(cursorPos.x + scalingRect.left - destRect.left);
-	io.MousePos.y = float(cursorPos.y + scalingRect.top - destRect.top);
+	return ImVec2(
+		float(cursorPos.x + scalingRect.left - destRect.left),
+		float(cursorPos.y + scalingRect.top - destRect.top)
+	);
+}
+
+void ImGuiImpl::_UpdateMousePos() noexcept {
+	_lastMousePos = _CalcMousePos();
+	ImGui::GetIO().MousePos = _lastMousePos;
+}
+
+bool ImGuiImpl::_CreateCacheResources() noexcept {
+	ID3D11Device5* d3dDevice = _deviceResources->GetD3DDevice();
+
+	HRESULT hr = d3dDevice->CreateVertexShader(SimpleVS, std::size(SimpleVS), nullptr, _cacheVS.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateVertexShader 失败", hr);
+		return false;
+	}
+
+	static constexpr D3D11_INPUT_ELEMENT_DESC LOCAL_LAYOUT[] = {
+		{ "SV_POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	};
+	hr = d3dDevice->CreateInputLayout(
+		LOCAL_LAYOUT, (UINT)std::size(LOCAL_LAYOUT), SimpleVS, std::size(SimpleVS), _cacheIL.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateInputLayout 失败", hr);
+		return false;
+	}
+
+	// 覆盖整个视口的矩形，视口即为输出区域
+	static constexpr float VERTICES[] = {
+		-1.0f, 1.0f, 0.0f, 0.0f,
+		1.0f, 1.0f, 1.0f, 0.0f,
+		-1.0f, -1.0f, 0.0f, 1.0f,
+		1.0f, -1.0f, 1.0f, 1.0f
+	};
+	{
+		const D3D11_BUFFER_DESC bd{
+			.ByteWidth = sizeof(VERTICES),
+			.Usage = D3D11_USAGE_IMMUTABLE,
+			.BindFlags = D3D11_BIND_VERTEX_BUFFER
+		};
+		const D3D11_SUBRESOURCE_DATA initData{ .pSysMem = VERTICES };
+		hr = d3dDevice->CreateBuffer(&bd, &initData, _cacheVtxBuffer.put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateBuffer 失败", hr);
+			return false;
+		}
+	}
+
+	hr = d3dDevice->CreatePixelShader(SimplePS, std::size(SimplePS), nullptr, _cachePS.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreatePixelShader 失败", hr);
+		return false;
+	}
+
+	{
+		// FinalColor = ScreenColor * (1 - CacheColor.a) + CacheColor
+		D3D11_BLEND_DESC desc{
+			.RenderTarget{
+				D3D11_RENDER_TARGET_BLEND_DESC{
+					.BlendEnable = true,
+					.SrcBlend = D3D11_BLEND_ONE,
+					.DestBlend = D3D11_BLEND_INV_SRC_ALPHA,
+					.BlendOp = D3D11_BLEND_OP_ADD,
+					.SrcBlendAlpha = D3D11_BLEND_ONE,
+					.DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA,
+					.BlendOpAlpha = D3D11_BLEND_OP_ADD,
+					.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL
+				}
+			}
+		};
+		hr = d3dDevice->CreateBlendState(&desc, _cacheBlendState.put());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("CreateBlendState 失败", hr);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ImGuiImpl::_CreateCacheTexture() noexcept {
+	ID3D11Device5* d3dDevice = _deviceResources->GetD3DDevice();
+	const SIZE outputSize = Win32Helper::GetSizeOfRect(ScalingWindow::Get().Renderer().DestRect());
+
+	_cacheTexture = DirectXHelper::CreateTexture2D(
+		d3dDevice,
+		DXGI_FORMAT_R8G8B8A8_UNORM,
+		outputSize.cx,
+		outputSize.cy,
+		D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE
+	);
+	if (!_cacheTexture) {
+		Logger::Get().Error("创建叠加层缓存纹理失败");
+		return false;
+	}
+
+	HRESULT hr = d3dDevice->CreateRenderTargetView(_cacheTexture.get(), nullptr, _cacheRtv.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateRenderTargetView 失败", hr);
+		_cacheTexture = nullptr;
+		return false;
+	}
+
+	hr = d3dDevice->CreateShaderResourceView(_cacheTexture.get(), nullptr, _cacheSrv.put());
+	if (FAILED(hr)) {
+		Logger::Get().ComError("CreateShaderResourceView 失败", hr);
+		_cacheTexture = nullptr;
+		_cacheRtv = nullptr;
+		return false;
+	}
+
+	return true;
 }
 
 void ImGuiImpl::ClearStates() noexcept {
 	ImGuiIO& io = ImGui::GetIO();
-	io.MousePos = ImVec2(-FLT_MAX, -FLT_MAX);
+	io.MousePos = _lastMousePos = ImVec2(-FLT_MAX, -FLT_MAX);
 	std::fill(std::begin(io.MouseDown), std::end(io.MouseDown), false);
 
 	CursorManager& cursorManager = ScalingWindow::Get().CursorManager();
@@ -178,6 +391,9 @@ void ImGuiImpl::ClearStates() noexcept {
 		ImGui::NewFrame();
 		ImGui::EndFrame();
 	}
+
+	// 缓存纹理已过时
+	_hasNewInput = true;
 }
 
 void ImGuiImpl::MessageHandler(UINT msg, WPARAM wParam, LPARAM /*lParam*/) noexcept {
@@ -191,6 +407,8 @@ void ImGuiImpl::MessageHandler(UINT msg, WPARAM wParam, LPARAM /*lParam*/) noexc
 		return;
 	}
 
+	_hasNewInput = true;
+
 	// 缩放窗口不会收到双击消息
 	switch (msg) {
 	case WM_LBUTTONDOWN:
@@ -19,8 +19,15 @@ public:
 
 	void NewFrame() noexcept;
 
+	// 将 ImGui 渲染到缓存纹理，然后绘制缓存纹理
 	void Draw() noexcept;
 
+	// ImGui 的状态没有变化时直接绘制缓存纹理，无需重新渲染 ImGui
+	void DrawCached() noexcept;
+
+	// 自上次 NewFrame 后是否有新的输入，包括光标移动
+	bool HasNewInput() const noexcept;
+
 	void ClearStates() noexcept;
 
 	void MessageHandler(UINT msg, WPARAM wParam, LPARAM lParam) noexcept;
@@ -28,10 +35,30 @@ public:
 	// 将提示窗口限制在屏幕内
 	static void Tooltip(const char* content, float maxWidth = -1.0f) noexcept;
 private:
+	ImVec2 _CalcMousePos() const noexcept;
+
 	void _UpdateMousePos() noexcept;
 
+	bool _CreateCacheResources() noexcept;
+
+	bool _CreateCacheTexture() noexcept;
+
+	DeviceResources* _deviceResources = nullptr;
 	ImGuiBackend _backend;
 
+	// 保存 ImGui 的渲染结果，RGB 通道已预乘 alpha
+	winrt::com_ptr<ID3D11Texture2D> _cacheTexture;
+	winrt::com_ptr<ID3D11RenderTargetView> _cacheRtv;
+	winrt::com_ptr<ID3D11ShaderResourceView> _cacheSrv;
+	winrt::com_ptr<ID3D11VertexShader> _cacheVS;
+	winrt::com_ptr<ID3D11InputLayout> _cacheIL;
+	winrt::com_ptr<ID3D11Buffer> _cacheVtxBuffer;
+	winrt::com_ptr<ID3D11PixelShader> _cachePS;
+	winrt::com_ptr<ID3D11BlendState> _cacheBlendState;
+
+	ImVec2 _lastMousePos{ -FLT_MAX, -FLT_MAX };
+	bool _hasNewInput = true;
+
 	uint32_t _handlerId = 0;
 
 	HANDLE _hHookThread = NULL;
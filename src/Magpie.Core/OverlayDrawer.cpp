@@ -16,8 +16,6 @@
 #include "ScalingWindow.h"
 #include <ShlObj.h>
 
-using namespace std::chrono;
-
 namespace Magpie {
 
 static const char* COLOR_INDICATOR = "■";
@@ -205,7 +203,7 @@ bool OverlayDrawer::Initialize(DeviceResources* deviceResources) noexcept {
 	for (const Renderer::EffectInfo& info : effectInfos) {
 		passCount += (uint32_t)info.passNames.size();
 	}
-	_effectTimingsStatistics.resize(passCount);
+	_effectStatistics.resize(passCount);
 	_lastestAvgEffectTimings.resize(passCount);
 
 	return true;
@@ -214,7 +212,7 @@ bool OverlayDrawer::Initialize(DeviceResources* deviceResources) noexcept {
 void OverlayDrawer::Draw(
 	uint32_t count,
 	uint32_t fps,
-	const SmallVector<float>& effectTimings
+	std::span<const TimingStatistics::Summary> effectStatistics
 ) noexcept {
 	bool isShowFPS = ScalingWindow::Get().Options().IsShowFPS();
 
@@ -222,12 +220,49 @@ void OverlayDrawer::Draw(
 		return;
 	}
 
+	bool needRebuild = _isUIVisiable && _UpdateEffectTimings(effectStatistics);
+
 	if (_isFirstFrame) {
 		// 刚显示时需连续渲染两帧才能显示
 		_isFirstFrame = false;
 		++count;
+		needRebuild = true;
+	}
+
+	if (_isLayoutDirty || fps != _lastFPS || _imguiImpl.HasNewInput()) {
+		needRebuild = true;
+	}
+
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	if (_isUIVisiable && options.IsStatisticsForDynamicDetectionEnabled() &&
+		options.duplicateFrameDetectionMode == DuplicateFrameDetectionMode::Dynamic) {
+		const std::pair<uint32_t, uint32_t> statistics =
+			ScalingWindow::Get().Renderer().FrameSource().GetStatisticsForDynamicDetection();
+		if (statistics != _lastDynamicDetectionStatistics) {
+			_lastDynamicDetectionStatistics = statistics;
+			needRebuild = true;
+		}
+	}
+
+	if (_isUIVisiable) {
+		const Renderer& renderer = ScalingWindow::Get().Renderer();
+		const uint32_t version = renderer.LatencyTracker().StatisticsVersion();
+		if (version != _lastLatencyStatisticsVersion) {
+			_lastLatencyStatisticsVersion = version;
+			_UpdateWaitTimes(renderer.FrameTimer());
+			needRebuild = true;
+		}
+	}
+
+	if (!needRebuild) {
+		// 叠加层的内容没有变化，直接使用上次的渲染结果
+		_imguiImpl.DrawCached();
+		return;
 	}
 
+	_isLayoutDirty = false;
+	_lastFPS = fps;
+
 	// 很多时候需要多次渲染避免呈现中间状态，但最多只渲染 10 次
 	for (int i = 0; i < 10; ++i) {
 		_imguiImpl.NewFrame();
@@ -237,7 +272,7 @@ void OverlayDrawer::Draw(
 		}
 
 		if (_isUIVisiable) {
-			if (_DrawUI(effectTimings, fps)) {
+			if (_DrawUI(fps)) {
 				++count;
 			}
 		}
@@ -260,6 +295,7 @@ void OverlayDrawer::SetUIVisibility(bool value, bool noSetForeground) noexcept {
 		return;
 	}
 	_isUIVisiable = value;
+	_isLayoutDirty = true;
 
 	if (value) {
 		if (ScalingWindow::Get().Options().Is3DGameMode()) {
@@ -577,7 +613,8 @@ bool OverlayDrawer::_DrawTimingItem(
 	const char* text,
 	const ImColor* color,
 	float time,
-	bool isExpanded
+	bool isExpanded,
+	const TimingStatistics::Summary* statistics
 ) const noexcept {
 	ImGui::TableNextRow();
 	ImGui::TableNextColumn();
@@ -647,6 +684,17 @@ bool OverlayDrawer::_DrawTimingItem(
 		ImGui::PopStyleColor();
 	}
 
+	// 悬停于用时上时显示统计窗口内的分布
+	if (statistics && statistics->count > 0 && ImGui::IsItemHovered()) {
+		const std::string content = fmt::format(
+			"min: {:.3f} ms\nmean: {:.3f} ms\np50: {:.3f} ms\np95: {:.3f} ms\np99: {:.3f} ms\nmax: {:.3f} ms\n({} frames)",
+			statistics->min, statistics->mean, statistics->p50,
+			statistics->p95, statistics->p99, statistics->max, statistics->count);
+		ImGui::PushFont(_fontMonoNumbers);
+		ImGuiImpl::Tooltip(content.c_str(), 500 * _dpiScale);
+		ImGui::PopFont();
+	}
+
 	ImGui::PopID();
 
 	return isHovered;
@@ -672,7 +720,9 @@ int OverlayDrawer::_DrawEffectTimings(
 		effectName.c_str(),
 		(!singleEffect && !showPasses) ? &colors[0] : nullptr,
 		drawInfo.totalTime,
-		showPasses
+		showPasses,
+		// 多个通道的百分位数无法相加，因此只有单通道的效果显示统计
+		drawInfo.passStatistics.size() == 1 ? &drawInfo.passStatistics[0] : nullptr
 	)) {
 		result = 0;
 	}
@@ -685,7 +735,9 @@ int OverlayDrawer::_DrawEffectTimings(
 				itemId,
 				drawInfo.info->passNames[j].c_str(),
 				&colors[j],
-				drawInfo.passTimings[j]
+				drawInfo.passTimings[j],
+				false,
+				&drawInfo.passStatistics[j]
 			)) {
 				result = (int)j;
 			}
@@ -829,51 +881,58 @@ void OverlayDrawer::_DrawFPS(uint32_t fps) noexcept {
 	ImGui::PopStyleVar();
 }
 
+// 返回 true 表示显示的渲染时间已更新
+bool OverlayDrawer::_UpdateEffectTimings(std::span<const TimingStatistics::Summary> effectStatistics) noexcept {
+	// effectStatistics 为空表示没有新的统计结果
+	if (effectStatistics.empty()) {
+		return false;
+	}
+
+	const uint32_t passCount = (uint32_t)_effectStatistics.size();
+	assert(effectStatistics.size() == passCount);
+
+	bool updated = false;
+	for (uint32_t i = 0; i < passCount; ++i) {
+		const TimingStatistics::Summary& statistics = effectStatistics[i];
+		// 统计窗口内没有样本时保留上次的结果
+		if (statistics.count == 0) {
+			continue;
+		}
+
+		_effectStatistics[i] = statistics;
+		_lastestAvgEffectTimings[i] = statistics.mean;
+		updated = true;
+	}
+
+	return updated;
+}
+
+void OverlayDrawer::_UpdateWaitTimes(const StepTimer& stepTimer) noexcept {
+	using namespace std::chrono;
+
+	const steady_clock::time_point now = steady_clock::now();
+	const nanoseconds sleepTime = stepTimer.SleepTime();
+	const nanoseconds spinTime = stepTimer.SpinTime();
+
+	if (_lastWaitTimeSampleTime != steady_clock::time_point{}) {
+		const float seconds = duration<float>(now - _lastWaitTimeSampleTime).count();
+		_sleepTimePerSecond = duration<float, std::milli>(sleepTime - _lastSleepTime).count() / seconds;
+		_spinTimePerSecond = duration<float, std::milli>(spinTime - _lastSpinTime).count() / seconds;
+	}
+
+	_lastWaitTimeSampleTime = now;
+	_lastSleepTime = sleepTime;
+	_lastSpinTime = spinTime;
+}
+
 // 返回 true 表示应再渲染一次
-bool OverlayDrawer::_DrawUI(const SmallVector<float>& effectTimings, uint32_t fps) noexcept {
+bool OverlayDrawer::_DrawUI(uint32_t fps) noexcept {
 	const ScalingOptions& options = ScalingWindow::Get().Options();
 	const Renderer& renderer = ScalingWindow::Get().Renderer();
 
-	const uint32_t passCount = (uint32_t)_effectTimingsStatistics.size();
+	const uint32_t passCount = (uint32_t)_lastestAvgEffectTimings.size();
 
 	bool needRedraw = false;
-	
-	// effectTimings 为空表示后端没有渲染新的帧
-	if (!effectTimings.empty()) {
-		steady_clock::time_point now = steady_clock::now();
-		if (_lastUpdateTime == steady_clock::time_point{}) {
-			// 后端渲染的第一帧
-			_lastUpdateTime = now;
-
-			for (uint32_t i = 0; i < passCount; ++i) {
-				_lastestAvgEffectTimings[i] = effectTimings[i];
-			}
-		} else {
-			if (now - _lastUpdateTime > 500ms) {
-				// 更新间隔不少于 500ms，而不是 500ms 更新一次
-				_lastUpdateTime = now;
-
-				for (uint32_t i = 0; i < passCount; ++i) {
-					auto& [total, count] = _effectTimingsStatistics[i];
-					if (count > 0) {
-						_lastestAvgEffectTimings[i] = total / count;
-					}
-
-					count = 0;
-					total = 0;
-				}
-			}
-
-			for (uint32_t i = 0; i < passCount; ++i) {
-				auto& [total, count] = _effectTimingsStatistics[i];
-				// 有时会跳过某些效果的渲染，即渲染时间为 0，这时不应计入
-				if (effectTimings[i] > 1e-3) {
-					++count;
-					total += effectTimings[i];
-				}
-			}
-		}
-	}
 
 #ifdef _DEBUG
 	ImGui::ShowDemoWindow();
@@ -929,6 +988,7 @@ bool OverlayDrawer::_DrawUI(const SmallVector<float>& effectTimings, uint32_t fp
 
 				uint32_t nPass = (uint32_t)effectTiming.info->passNames.size();
 				effectTiming.passTimings = { _lastestAvgEffectTimings.begin() + idx, nPass };
+				effectTiming.passStatistics = { _effectStatistics.begin() + idx, nPass };
 				idx += nPass;
 
 				for (float t : effectTiming.passTimings) {
@@ -1163,6 +1223,39 @@ bool OverlayDrawer::_DrawUI(const SmallVector<float>& effectTimings, uint32_t fp
 			}
 		}
 	}
+
+	// 端到端延迟，均从捕获开始计算
+	const std::string& latencyStr = _GetResourceString(L"Overlay_Profiler_Latency");
+	if (ImGui::CollapsingHeader(latencyStr.c_str())) {
+		static constexpr std::array<const wchar_t*, (size_t)FrameLatencyTracker::Stage::COUNT> STAGE_KEYS{
+			L"Overlay_Profiler_Latency_Render",
+			L"Overlay_Profiler_Latency_Publish",
+			L"Overlay_Profiler_Latency_Copy",
+			L"Overlay_Profiler_Latency_Present"
+		};
+
+		const auto& statistics = renderer.LatencyTracker().GetStatistics();
+
+		if (ImGui::BeginTable("latency", 1, ImGuiTableFlags_PadOuterX)) {
+			ImGui::TableSetupColumn(nullptr, ImGuiTableColumnFlags_WidthStretch | ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_NoReorder);
+
+			int itemId = 0;
+			for (size_t i = 0; i < statistics.size(); ++i) {
+				_DrawTimingItem(itemId, _GetResourceString(STAGE_KEYS[i]).c_str(),
+					nullptr, statistics[i].mean, false, &statistics[i]);
+			}
+
+			// 只在限制帧率时有意义，用于权衡计时器余量和忙等待占用的 CPU
+			if (_sleepTimePerSecond > 0 || _spinTimePerSecond > 0) {
+				_DrawTimingItem(itemId, _GetResourceString(L"Overlay_Profiler_Latency_LimiterSleep").c_str(),
+					nullptr, _sleepTimePerSecond);
+				_DrawTimingItem(itemId, _GetResourceString(L"Overlay_Profiler_Latency_LimiterSpin").c_str(),
+					nullptr, _spinTimePerSecond);
+			}
+
+			ImGui::EndTable();
+		}
+	}
 	
 	ImGui::End();
 	return needRedraw;
@@ -20,7 +20,7 @@ public:
 	void Draw(
 		uint32_t count,
 		uint32_t fps,
-		const SmallVector<float>& effectTimings
+		std::span<const TimingStatistics::Summary> effectStatistics
 	) noexcept;
 
 	bool IsUIVisible() const noexcept {
@@ -39,6 +39,7 @@ private:
 	struct _EffectDrawInfo {
 		const Renderer::EffectInfo* info = nullptr;
 		std::span<const float> passTimings;
+		std::span<const TimingStatistics::Summary> passStatistics;
 		float totalTime = 0.0f;
 	};
 
@@ -47,7 +48,8 @@ private:
 		const char* text,
 		const ImColor* color,
 		float time,
-		bool isExpanded = false
+		bool isExpanded = false,
+		const TimingStatistics::Summary* statistics = nullptr
 	) const noexcept;
 
 	int _DrawEffectTimings(
@@ -70,7 +72,11 @@ private:
 
 	void _DrawFPS(uint32_t fps) noexcept;
 
-	bool _DrawUI(const SmallVector<float>& effectTimings, uint32_t fps) noexcept;
+	bool _UpdateEffectTimings(std::span<const TimingStatistics::Summary> effectStatistics) noexcept;
+
+	void _UpdateWaitTimes(const StepTimer& stepTimer) noexcept;
+
+	bool _DrawUI(uint32_t fps) noexcept;
 
 	const std::string& _GetResourceString(const std::wstring_view& key) noexcept;
 
@@ -80,9 +86,8 @@ private:
 	ImFont* _fontMonoNumbers = nullptr;	// 普通 UI 文字，但数字部分是等宽的，只支持 ASCII
 	ImFont* _fontFPS = nullptr;	// FPS
 
-	std::chrono::steady_clock::time_point _lastUpdateTime{};
-	// (总计时间, 帧数)
-	SmallVector<std::pair<float, uint32_t>, 0> _effectTimingsStatistics;
+	// 由 EffectsProfiler 统计，每 500ms 更新一次
+	SmallVector<TimingStatistics::Summary, 0> _effectStatistics;
 	SmallVector<float> _lastestAvgEffectTimings;
 
 	SmallVector<uint32_t> _timelineColors;
@@ -95,8 +100,22 @@ private:
 
 	winrt::ResourceLoader _resourceLoader{ nullptr };
 
+	// 用于检查是否需要重新渲染 ImGui
+	uint32_t _lastFPS = std::numeric_limits<uint32_t>::max();
+	std::pair<uint32_t, uint32_t> _lastDynamicDetectionStatistics;
+	uint32_t _lastLatencyStatisticsVersion = 0;
+
+	// 帧率限制器每秒睡眠和忙等待的毫秒数，和延迟统计同时更新
+	std::chrono::steady_clock::time_point _lastWaitTimeSampleTime;
+	std::chrono::nanoseconds _lastSleepTime{};
+	std::chrono::nanoseconds _lastSpinTime{};
+	float _sleepTimePerSecond = 0.0f;
+	float _spinTimePerSecond = 0.0f;
+
 	bool _isUIVisiable = false;
 	bool _isFirstFrame = true;
+	// 显示或隐藏 UI 等情况需要重新渲染 ImGui
+	bool _isLayoutDirty = true;
 };
 
 }
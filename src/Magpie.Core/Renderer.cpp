@@ -11,6 +11,7 @@
 #include "DesktopDuplicationFrameSource.h"
 #include "GDIFrameSource.h"
 #include "DwmSharedSurfaceFrameSource.h"
+#include "FileFrameSource.h"
 #include "DirectXHelper.h"
 #include <dispatcherqueue.h>
 #include "ScalingWindow.h"
@@ -20,6 +21,17 @@
 
 namespace Magpie {
 
+static bool IsBenchmarkReportEnabled() noexcept {
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	return options.IsBenchmarkMode() && options.benchmarkFrames > 0;
+}
+
+// 记录帧时间线和性能测试时需要每帧的 GPU 用时，因此也要一直启用 EffectsProfiler
+static bool IsEffectsProfilerAlwaysOn() noexcept {
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	return options.IsEffectsProfilerAlwaysOn() || options.IsFrameTraceEnabled() || IsBenchmarkReportEnabled();
+}
+
 Renderer::Renderer() noexcept {}
 
 Renderer::~Renderer() noexcept {
@@ -132,6 +144,11 @@ ScalingError Renderer::Initialize() noexcept {
 		return ScalingError::ScalingFailedGeneral;
 	}
 
+	if (!_latencyTracker.Initialize(ScalingWindow::Get().Options().IsFrameLatencyExportEnabled())) {
+		// 导出失败不影响缩放
+		Logger::Get().Error("初始化 FrameLatencyTracker 失败");
+	}
+
 	if (ScalingWindow::Get().Options().IsShowFPS()) {
 		_overlayDrawer.reset(new OverlayDrawer());
 		if (!_overlayDrawer->Initialize(&_frontendResources)) {
@@ -150,7 +167,9 @@ ScalingError Renderer::Initialize() noexcept {
 
 void Renderer::OnCursorVisibilityChanged(bool isVisible, bool onDestory) {
 	_backendThreadDispatcher.TryEnqueue([this, isVisible, onDestory]() {
-		if (_frameSource) {
+		if (_captureThread) {
+			_captureThread->OnCursorVisibilityChanged(isVisible, onDestory);
+		} else if (_frameSource) {
 			_frameSource->OnCursorVisibilityChanged(isVisible, onDestory);
 		}
 	});
@@ -285,6 +304,8 @@ void Renderer::_FrontendRender() noexcept {
 		);
 	}
 
+	_latencyTracker.OnFrameCopied();
+
 	_frontendSharedTextureMutex->ReleaseSync(_lastAccessMutexKey);
 
 	// 叠加层和光标都绘制到 back buffer
@@ -299,7 +320,7 @@ void Renderer::_FrontendRender() noexcept {
 		_overlayDrawer->Draw(
 			2,
 			_stepTimer.FPS(),
-			_overlayDrawer->IsUIVisible() ? _effectsProfiler.GetTimings() : SmallVector<float>()
+			_overlayDrawer->IsUIVisible() ? _effectsProfiler.GetStatistics() : std::span<const TimingStatistics::Summary>()
 		);
 	}
 
@@ -309,6 +330,20 @@ void Renderer::_FrontendRender() noexcept {
 	// 两个垂直同步之间允许渲染数帧，SyncInterval = 0 只呈现最新的一帧，旧帧被丢弃
 	_swapChain->Present(0, 0);
 
+	const std::chrono::steady_clock::time_point presentTime = std::chrono::steady_clock::now();
+
+	if (ScalingWindow::Get().Options().IsLowLatencyPacingEnabled()) {
+		// 低延迟模式下后端将呈现目标对齐到垂直同步。窗口化时可能失败，后端会退而使用固定的帧间隔
+		DXGI_FRAME_STATISTICS stats;
+		if (SUCCEEDED(_swapChain->GetFrameStatistics(&stats)) && stats.SyncQPCTime.QuadPart != 0) {
+			_stepTimer.OnVBlank(stats.SyncQPCTime.QuadPart);
+		}
+	}
+
+	if (const uint64_t frameId = _latencyTracker.OnFramePresented(presentTime)) {
+		_frameTraceRecorder.OnFramePresented(frameId, presentTime);
+	}
+
 	// 丢弃渲染目标的内容
 	d3dDC->DiscardView(_backBufferRtv.get());
 }
@@ -367,13 +402,11 @@ void Renderer::SetOverlayVisibility(bool value, bool noSetForeground) noexcept {
 		}
 		_overlayDrawer->SetUIVisibility(true);
 
-		_backendThreadDispatcher.TryEnqueue([this]() {
-			uint32_t passCount = 0;
-			for (const EffectInfo& info : _effectInfos) {
-				passCount += (uint32_t)info.passNames.size();
-			}
-			_effectsProfiler.Start(_backendResources.GetD3DDevice(), passCount);
-		});
+		if (!IsEffectsProfilerAlwaysOn()) {
+			_backendThreadDispatcher.TryEnqueue([this]() {
+				_StartEffectsProfiler();
+			});
+		}
 	} else {
 		if (_overlayDrawer) {
 			if (!_overlayDrawer->IsUIVisible()) {
@@ -382,54 +415,134 @@ void Renderer::SetOverlayVisibility(bool value, bool noSetForeground) noexcept {
 			_overlayDrawer->SetUIVisibility(false, noSetForeground);
 		}
 
-		_backendThreadDispatcher.TryEnqueue([this]() {
-			_effectsProfiler.Stop();
-		});
+		if (!IsEffectsProfilerAlwaysOn()) {
+			_backendThreadDispatcher.TryEnqueue([this]() {
+				_effectsProfiler.Stop();
+			});
+		}
 	}
 
 	// 立即渲染一帧
 	_FrontendRender();
 }
 
+// 某些捕获方式不会限制捕获帧率，这时应将捕获帧率限制为屏幕刷新率
+static std::optional<float> GetSrcMonitorRefreshRate() noexcept {
+	const HWND hwndSrc = ScalingWindow::Get().HwndSrc();
+	HMONITOR hMon = MonitorFromWindow(hwndSrc, MONITOR_DEFAULTTONEAREST);
+	if (!hMon) {
+		return std::nullopt;
+	}
+
+	MONITORINFOEX mi{ sizeof(MONITORINFOEX) };
+	GetMonitorInfo(hMon, &mi);
+
+	DEVMODE dm{ .dmSize = sizeof(DEVMODE) };
+	EnumDisplaySettings(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm);
+
+	if (dm.dmDisplayFrequency == 0) {
+		return std::nullopt;
+	}
+
+	Logger::Get().Info(fmt::format("屏幕刷新率: {}", dm.dmDisplayFrequency));
+	return float(dm.dmDisplayFrequency);
+}
+
 bool Renderer::_InitFrameSource() noexcept {
-	switch (ScalingWindow::Get().Options().captureMethod) {
-	case CaptureMethod::GraphicsCapture:
-		_frameSource = std::make_unique<GraphicsCaptureFrameSource>();
-		break;
-	case CaptureMethod::DesktopDuplication:
-		_frameSource = std::make_unique<DesktopDuplicationFrameSource>();
-		break;
-	case CaptureMethod::GDI:
-		_frameSource = std::make_unique<GDIFrameSource>();
-		break;
-	case CaptureMethod::DwmSharedSurface:
-		_frameSource = std::make_unique<DwmSharedSurfaceFrameSource>();
-		break;
-	default:
-		Logger::Get().Error("未知的捕获模式");
-		return false;
+	std::unique_ptr<FrameSourceBase> frameSource;
+	const ScalingOptions& options = ScalingWindow::Get().Options();
+	if (options.IsFramePlaybackEnabled() || options.IsSyntheticFramesEnabled()) {
+		// 回放帧录像或生成的图案代替捕获
+		frameSource = std::make_unique<FileFrameSource>(options.IsSyntheticFramesEnabled());
+	} else {
+		switch (options.captureMethod) {
+		case CaptureMethod::GraphicsCapture:
+			frameSource = std::make_unique<GraphicsCaptureFrameSource>();
+			break;
+		case CaptureMethod::DesktopDuplication:
+			frameSource = std::make_unique<DesktopDuplicationFrameSource>();
+			break;
+		case CaptureMethod::GDI:
+			frameSource = std::make_unique<GDIFrameSource>();
+			break;
+		case CaptureMethod::DwmSharedSurface:
+			frameSource = std::make_unique<DwmSharedSurfaceFrameSource>();
+			break;
+		default:
+			Logger::Get().Error("未知的捕获模式");
+			return false;
+		}
 	}
 
-	Logger::Get().Info(StrHelper::Concat("当前捕获模式: ", _frameSource->Name()));
+	Logger::Get().Info(StrHelper::Concat("当前捕获模式: ", frameSource->Name()));
 
-	if (!_frameSource->Initialize(_backendResources, _backendDescriptorStore)) {
-		Logger::Get().Error("初始化 FrameSource 失败");
-		_backendInitError = ScalingError::CaptureFailed;
-		return false;
+	if (options.IsCaptureThreadEnabled()) {
+		// 需要轮询的捕获方式由捕获线程限制帧率
+		const std::optional<float> maxCaptureRate = frameSource->WaitType() == FrameSourceWaitType::NoWait
+			? GetSrcMonitorRefreshRate() : std::nullopt;
+
+		_captureThread = std::make_unique<CaptureThread>();
+		if (!_captureThread->Initialize(std::move(frameSource), _backendResources, maxCaptureRate)) {
+			Logger::Get().Error("初始化 CaptureThread 失败");
+			_backendInitError = ScalingError::CaptureFailed;
+			return false;
+		}
+	} else {
+		_frameSource = std::move(frameSource);
+		if (!_frameSource->Initialize(_backendResources, _backendDescriptorStore)) {
+			Logger::Get().Error("初始化 FrameSource 失败");
+			_backendInitError = ScalingError::CaptureFailed;
+			return false;
+		}
 	}
 
-	const RECT& srcRect = _frameSource->SrcRect();
+	const RECT& srcRect = FrameSource().SrcRect();
 	Logger::Get().Info(fmt::format("源窗口边界: {},{},{},{}",
 		srcRect.left, srcRect.top, srcRect.right, srcRect.bottom));
 
 	// 由于 DPI 缩放，捕获尺寸和边界矩形尺寸不一定相同
 	D3D11_TEXTURE2D_DESC desc;
-	_frameSource->GetOutput()->GetDesc(&desc);
+	_GetFrameSourceOutput()->GetDesc(&desc);
 	Logger::Get().Info(fmt::format("捕获尺寸: {}x{}", desc.Width, desc.Height));
 
+	if (options.IsFrameRecordingEnabled()) {
+		if (options.IsFramePlaybackEnabled()) {
+			// 两者使用同一个文件
+			Logger::Get().Warn("回放帧录像时不能录制");
+		} else if (!_frameRecorder.Initialize(_backendResources.GetD3DDevice(), _GetFrameSourceOutput())) {
+			// 录制失败不影响缩放
+			Logger::Get().Error("初始化 FrameRecorder 失败");
+		}
+	}
+
 	return true;
 }
 
+ID3D11Texture2D* Renderer::_GetFrameSourceOutput() noexcept {
+	return _captureThread ? _captureThread->GetOutput() : _frameSource->GetOutput();
+}
+
+FrameSourceState Renderer::_UpdateFrameSource() noexcept {
+	return _captureThread ? _captureThread->Update() : _frameSource->Update();
+}
+
+std::chrono::steady_clock::time_point Renderer::_CaptureTime() const noexcept {
+	return _captureThread ? _captureThread->CaptureTime() : _frameSource->CaptureTime();
+}
+
+DuplicateFrameCheckResult Renderer::_LastDuplicateCheckResult() const noexcept {
+	return _captureThread ? _captureThread->LastDuplicateCheckResult() : _frameSource->LastDuplicateCheckResult();
+}
+
+ID3D11Predicate* Renderer::_DuplicateFramePredicate() const noexcept {
+	return _captureThread ? nullptr : _frameSource->DuplicateFramePredicate();
+}
+
+void Renderer::_ReleaseFrameSource() noexcept {
+	_captureThread.reset();
+	_frameSource.reset();
+}
+
 // 单位为微秒
 template <typename Fn>
 static int Measure(const Fn& func) noexcept {
@@ -520,7 +633,7 @@ ID3D11Texture2D* Renderer::_BuildEffects() noexcept {
 
 	_effectDrawers.resize(effects.size());
 
-	ID3D11Texture2D* inOutTexture = _frameSource->GetOutput();
+	ID3D11Texture2D* inOutTexture = _GetFrameSourceOutput();
 	for (uint32_t i = 0; i < effectCount; ++i) {
 		if (!_effectDrawers[i].Initialize(
 			effectDescs[i],
@@ -665,7 +778,7 @@ void Renderer::_BackendThreadProc() noexcept {
 
 	ID3D11Texture2D* outputTexture = _InitBackend();
 	if (!outputTexture) {
-		_frameSource.reset();
+		_ReleaseFrameSource();
 		// 通知前端初始化失败
 		_sharedTextureHandle.store(INVALID_HANDLE_VALUE, std::memory_order_release);
 		_sharedTextureHandle.notify_one();
@@ -679,18 +792,19 @@ void Renderer::_BackendThreadProc() noexcept {
 	}
 
 	StepTimerStatus stepTimerStatus = StepTimerStatus::WaitForNewFrame;
-	const bool waitMsgForNewFrame =
+	// 捕获线程放入新帧后会发送消息
+	const bool waitMsgForNewFrame = _captureThread ||
 		_frameSource->WaitType() == FrameSourceWaitType::WaitForMessage;
 
 	MSG msg;
 	while (true) {
 		stepTimerStatus = _stepTimer.WaitForNextFrame(
 			waitMsgForNewFrame && stepTimerStatus != StepTimerStatus::WaitForFPSLimiter);
+		_frameTraceRecorder.OnFrameBegin(stepTimerStatus);
 
 		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
 			if (msg.message == WM_QUIT) {
-				// 不能在前端线程释放
-				_frameSource.reset();
+				_ReleaseFrameSource();
 				return;
 			}
 
@@ -698,11 +812,14 @@ void Renderer::_BackendThreadProc() noexcept {
 		}
 
 		if (stepTimerStatus == StepTimerStatus::WaitForFPSLimiter) {
+			_frameTraceRecorder.OnFrameEnd();
 			// 新帧消息可能已被处理，之后的 WaitForNextFrame 不要等待消息，直到状态变化
 			continue;
 		}
 
-		switch (_frameSource->Update()) {
+		const FrameSourceState frameSourceState = _UpdateFrameSource();
+
+		switch (frameSourceState) {
 		case FrameSourceState::Waiting:
 			if (stepTimerStatus != StepTimerStatus::ForceNewFrame) {
 				break;
@@ -711,8 +828,21 @@ void Renderer::_BackendThreadProc() noexcept {
 			// 强制帧
 			[[fallthrough]];
 		case FrameSourceState::NewFrame:
-			_stepTimer.PrepareForRender();
-			_BackendRender(outputTexture);
+			if (frameSourceState == FrameSourceState::NewFrame && _frameRecorder.IsRecording()) {
+				_frameRecorder.OnNewFrame(_backendResources.GetD3DDC(), _GetFrameSourceOutput(), _CaptureTime());
+			}
+
+			if (_DuplicateFramePredicate()) {
+				// 异步检查重复帧时渲染完成才能确定是否为新帧
+				if (_BackendRender(outputTexture)) {
+					_stepTimer.PrepareForRender();
+					_stepTimer.OnFrameRendered();
+				}
+			} else {
+				_stepTimer.PrepareForRender();
+				_BackendRender(outputTexture);
+				_stepTimer.OnFrameRendered();
+			}
 			break;
 		case FrameSourceState::Error:
 			// 捕获出错，退出缩放
@@ -725,12 +855,41 @@ void Renderer::_BackendThreadProc() noexcept {
 				DispatchMessage(&msg);
 			}
 
-			_frameSource.reset();
+			_ReleaseFrameSource();
 			return;
 		}
+
+		// 异步检查重复帧的结果在渲染后才能得到
+		_frameTraceRecorder.OnFrameCaptured(frameSourceState,
+			_LastDuplicateCheckResult(), _CaptureTime());
+
+		if (ScalingWindow::Get().Options().IsCadenceLockingEnabled()) {
+			_UpdateCadence();
+		}
+
+		_frameTraceRecorder.OnFrameEnd();
 	}
 }
 
+void Renderer::_UpdateCadence() noexcept {
+	switch (_LastDuplicateCheckResult()) {
+	case DuplicateFrameCheckResult::NotChecked:
+		return;
+	case DuplicateFrameCheckResult::Skipped:
+		_cadenceDetector.OnFrameChecked(_CaptureTime(), std::nullopt);
+		break;
+	case DuplicateFrameCheckResult::Unique:
+		_cadenceDetector.OnFrameChecked(_CaptureTime(), false);
+		break;
+	case DuplicateFrameCheckResult::Duplicate:
+		_cadenceDetector.OnFrameChecked(_CaptureTime(), true);
+		break;
+	}
+
+	_stepTimer.SetNextFrameTime(_cadenceDetector.IsLocked()
+		? _cadenceDetector.NextFrameTime() : std::chrono::steady_clock::time_point{});
+}
+
 ID3D11Texture2D* Renderer::_InitBackend() noexcept {
 	// 创建 DispatcherQueue
 	{
@@ -763,21 +922,8 @@ ID3D11Texture2D* Renderer::_InitBackend() noexcept {
 
 	{
 		std::optional<float> maxFrameRate;
-		if (_frameSource->WaitType() == FrameSourceWaitType::NoWait) {
-			// 某些捕获方式不会限制捕获帧率，因此将捕获帧率限制为屏幕刷新率
-			const HWND hwndSrc = ScalingWindow::Get().HwndSrc();
-			if (HMONITOR hMon = MonitorFromWindow(hwndSrc, MONITOR_DEFAULTTONEAREST)) {
-				MONITORINFOEX mi{ sizeof(MONITORINFOEX) };
-				GetMonitorInfo(hMon, &mi);
-
-				DEVMODE dm{ .dmSize = sizeof(DEVMODE) };
-				EnumDisplaySettings(mi.szDevice, ENUM_CURRENT_SETTINGS, &dm);
-
-				if (dm.dmDisplayFrequency > 0) {
-					Logger::Get().Info(fmt::format("屏幕刷新率: {}", dm.dmDisplayFrequency));
-					maxFrameRate = float(dm.dmDisplayFrequency);
-				}
-			}
+		if (!_captureThread && _frameSource->WaitType() == FrameSourceWaitType::NoWait) {
+			maxFrameRate = GetSrcMonitorRefreshRate();
 		}
 
 		const ScalingOptions& options = ScalingWindow::Get().Options();
@@ -791,7 +937,7 @@ ID3D11Texture2D* Renderer::_InitBackend() noexcept {
 		// 和无限大效果相同。
 		const float minFrameRate = options.IsBenchmarkMode()
 			? std::numeric_limits<float>::max() : options.minFrameRate;
-		_stepTimer.Initialize(minFrameRate, maxFrameRate);
+		_stepTimer.Initialize(minFrameRate, maxFrameRate, options.IsLowLatencyPacingEnabled());
 	}
 
 	ID3D11Texture2D* outputTexture = _BuildEffects();
@@ -799,6 +945,40 @@ ID3D11Texture2D* Renderer::_InitBackend() noexcept {
 		return nullptr;
 	}
 
+	if (ScalingWindow::Get().Options().IsFrameTraceEnabled()) {
+		for (const EffectInfo& info : _effectInfos) {
+			_frameTraceRecorder.AddEffect(info.name, (uint32_t)info.passNames.size());
+		}
+
+		if (!_frameTraceRecorder.Initialize()) {
+			// 记录失败不影响缩放
+			Logger::Get().Error("初始化 FrameTraceRecorder 失败");
+		}
+	}
+
+	if (IsBenchmarkReportEnabled()) {
+		_InitBenchmarkRecorder(outputTexture);
+	}
+
+	if (_frameTraceRecorder.IsRecording() || _benchmarkRecorder.IsRunning()) {
+		_effectsProfiler.SetTimingsCallback([this](uint64_t frameIdx, std::span<const float> passTimings) {
+			_frameTraceRecorder.OnGpuTimings(frameIdx, passTimings);
+
+			if (_benchmarkRecorder.OnGpuTimings(passTimings)) {
+				// 性能测试完成，停止缩放
+				_benchmarkRecorder.WriteReport();
+				ScalingWindow::Get().Dispatcher().TryEnqueue([]() {
+					ScalingWindow::Get().Destroy();
+				});
+			}
+		});
+	}
+
+	if (IsEffectsProfilerAlwaysOn()) {
+		// 查询结果延迟数帧取回，开销很小，可以一直启用
+		_StartEffectsProfiler();
+	}
+
 	HRESULT hr = d3dDevice->CreateFence(
 		_fenceValue, D3D11_FENCE_FLAG_NONE, IID_PPV_ARGS(&_d3dFence));
 	if (FAILED(hr)) {
@@ -821,60 +1001,125 @@ ID3D11Texture2D* Renderer::_InitBackend() noexcept {
 		return nullptr;
 	}
 	
-	_srcRect = _frameSource->SrcRect();
+	_srcRect = FrameSource().SrcRect();
 	_sharedTextureHandle.store(sharedHandle, std::memory_order_release);
 	_sharedTextureHandle.notify_one();
 
 	return outputTexture;
 }
 
-void Renderer::_BackendRender(ID3D11Texture2D* effectsOutput) noexcept {
+bool Renderer::_BackendRender(ID3D11Texture2D* effectsOutput) noexcept {
 	ID3D11DeviceContext4* d3dDC = _backendResources.GetD3DDC();
-	d3dDC->ClearState();
 
-	if (ID3D11Buffer* t = _dynamicCB.get()) {
-		_UpdateDynamicConstants();
-		d3dDC->CSSetConstantBuffers(1, 1, &t);
-	}
+	// 异步检查重复帧时由 GPU 跳过重复帧的渲染，无需等待检查结果
+	ID3D11Predicate* dupFramePredicate = _DuplicateFramePredicate();
+	// 出错时也要结束待定的检查，否则下一帧会使用过时的谓词
+	auto cancelDupCheckGuard = wil::scope_exit([&]() {
+		if (dupFramePredicate) {
+			_frameSource->CancelDuplicateCheck();
+		}
+	});
+	HRESULT hr;
 
-	_effectsProfiler.OnBeginEffects(d3dDC);
+	const auto submitStart = std::chrono::steady_clock::now();
 
-	for (const EffectDrawer& effectDrawer : _effectDrawers) {
-		effectDrawer.Draw(_effectsProfiler);
-	}
+	{
+		// 启用捕获线程时防止捕获线程在渲染期间修改管线状态
+		auto contextLock = _backendResources.LockContext();
 
-	_effectsProfiler.OnEndEffects(d3dDC);
+		d3dDC->ClearState();
 
-	HRESULT hr = d3dDC->Signal(_d3dFence.get(), ++_fenceValue);
-	if (FAILED(hr)) {
-		Logger::Get().ComError("Signal 失败", hr);
-		return;
-	}
+		if (dupFramePredicate) {
+			d3dDC->SetPredication(dupFramePredicate, FALSE);
+		}
 
-	hr = _d3dFence->SetEventOnCompletion(_fenceValue, _fenceEvent.get());
-	if (FAILED(hr)) {
-		Logger::Get().ComError("SetEventOnCompletion 失败", hr);
-		return;
+		if (ID3D11Buffer* t = _dynamicCB.get()) {
+			// 异步检查重复帧时 PrepareForRender 在渲染后执行，且只在确定为新帧时执行，因此此时
+			// 帧数尚未增加。提前加一使效果看到的帧数序列和同步检查时相同
+			_UpdateDynamicConstants(dupFramePredicate ? _stepTimer.FrameCount() + 1 : _stepTimer.FrameCount());
+			d3dDC->CSSetConstantBuffers(1, 1, &t);
+		}
+
+		_frameTraceRecorder.OnRenderBegin();
+		_effectsProfiler.OnBeginEffects(d3dDC, _frameTraceRecorder.FrameIndex());
+
+		// 只渲染受变化的区域影响的部分
+		DirtyRegion dirtyRegion;
+		if (_captureThread) {
+			_captureThread->GetDirtyRegion(dirtyRegion);
+		} else {
+			_frameSource->GetDirtyRegion(dirtyRegion);
+		}
+
+		if (_frameSource) {
+			// 零复制捕获时每帧的输入纹理可能不同
+			_effectDrawers[0].SetInput(_frameSource->GetOutput());
+		}
+
+		DirtyRegion nextDirtyRegion;
+		for (EffectDrawer& effectDrawer : _effectDrawers) {
+			effectDrawer.Draw(_effectsProfiler, dirtyRegion, nextDirtyRegion);
+			std::swap(dirtyRegion, nextDirtyRegion);
+		}
+
+		_effectsProfiler.OnEndEffects(d3dDC);
+
+		if (dupFramePredicate) {
+			d3dDC->SetPredication(nullptr, FALSE);
+		}
+
+		hr = d3dDC->Signal(_d3dFence.get(), ++_fenceValue);
+		if (FAILED(hr)) {
+			Logger::Get().ComError("Signal 失败", hr);
+			return false;
+		}
+
+		hr = _d3dFence->SetEventOnCompletion(_fenceValue, _fenceEvent.get());
+		if (FAILED(hr)) {
+			Logger::Get().ComError("SetEventOnCompletion 失败", hr);
+			return false;
+		}
+
+		d3dDC->Flush();
 	}
 
-	d3dDC->Flush();
+	const auto submitEnd = std::chrono::steady_clock::now();
 
 	// 等待渲染完成
 	_fenceEvent.wait();
 
-	// 查询效果的渲染时间
+	FrameTimestamps timestamps{
+		.capture = _CaptureTime(),
+		.renderEnd = std::chrono::steady_clock::now()
+	};
+
+	// 取回已完成的渲染时间查询，不会阻塞
 	_effectsProfiler.QueryTimings(d3dDC);
 
+	if (dupFramePredicate) {
+		cancelDupCheckGuard.release();
+
+		if (_frameSource->ResolveDuplicateCheck()) {
+			// 重复帧，GPU 已跳过效果的渲染，无需呈现
+			return false;
+		}
+	}
+
 	// 渲染完成后再更新 _sharedTextureMutexKey，否则前端必须等待，降低光标流畅度
 	const uint64_t key = ++_sharedTextureMutexKey;
 	hr = _backendSharedTextureMutex->AcquireSync(key - 1, INFINITE);
 	if (FAILED(hr)) {
 		Logger::Get().ComError("AcquireSync 失败", hr);
-		return;
+		return false;
 	}
 
 	d3dDC->CopyResource(_backendSharedTexture.get(), effectsOutput);
 
+	// 前端获取共享纹理后才能读取，因此总能取得和纹理内容对应的时间戳
+	timestamps.publish = std::chrono::steady_clock::now();
+	_latencyTracker.OnFramePublished(key, timestamps);
+	_frameTraceRecorder.OnRenderEnd(key, timestamps.renderEnd);
+
 	_backendSharedTextureMutex->ReleaseSync(key);
 
 	// 根据 https://learn.microsoft.com/en-us/windows/win32/api/d3d11/nf-d3d11-id3d11device-opensharedresource，
@@ -883,9 +1128,41 @@ void Renderer::_BackendRender(ID3D11Texture2D* effectsOutput) noexcept {
 
 	// 唤醒前台线程
 	PostMessage(ScalingWindow::Get().Handle(), WM_NULL, 0, 0);
+
+	_benchmarkRecorder.OnFrameRendered(submitEnd - submitStart);
+	return true;
+}
+
+void Renderer::_StartEffectsProfiler() noexcept {
+	if (_effectsProfiler.IsStarted()) {
+		return;
+	}
+
+	uint32_t passCount = 0;
+	for (const EffectInfo& info : _effectInfos) {
+		passCount += (uint32_t)info.passNames.size();
+	}
+	_effectsProfiler.Start(_backendResources.GetD3DDevice(), passCount,
+		ScalingWindow::Get().Options().effectsProfilerWindow);
+}
+
+void Renderer::_InitBenchmarkRecorder(ID3D11Texture2D* effectsOutput) noexcept {
+	D3D11_TEXTURE2D_DESC inputDesc;
+	_GetFrameSourceOutput()->GetDesc(&inputDesc);
+	D3D11_TEXTURE2D_DESC outputDesc;
+	effectsOutput->GetDesc(&outputDesc);
+
+	std::vector<std::pair<std::string, std::vector<std::string>>> effects;
+	effects.reserve(_effectInfos.size());
+	for (const EffectInfo& info : _effectInfos) {
+		effects.emplace_back(info.name, info.passNames);
+	}
+
+	_benchmarkRecorder.Initialize(FrameSource().Name(), inputDesc.Width, inputDesc.Height,
+		outputDesc.Width, outputDesc.Height, effects, ScalingWindow::Get().Options().benchmarkFrames);
 }
 
-bool Renderer::_UpdateDynamicConstants() const noexcept {
+bool Renderer::_UpdateDynamicConstants(uint32_t frameCount) const noexcept {
 	// cbuffer __CB2 : register(b1) { uint __frameCount; };
 
 	ID3D11DeviceContext4* d3dDC = _backendResources.GetD3DDC();
@@ -895,7 +1172,6 @@ bool Renderer::_UpdateDynamicConstants() const noexcept {
 	if (SUCCEEDED(hr)) {
 		// 避免使用 *(uint32_t*)ms.pData，见
 		// https://learn.microsoft.com/en-us/windows/win32/api/d3d11/nf-d3d11-id3d11devicecontext-map
-		const uint32_t frameCount = _stepTimer.FrameCount();
 		std::memcpy(ms.pData, &frameCount, 4);
 		d3dDC->Unmap(_dynamicCB.get(), 0);
 	} else {
@@ -6,6 +6,12 @@
 #include "CursorDrawer.h"
 #include "StepTimer.h"
 #include "EffectsProfiler.h"
+#include "FrameLatencyTracker.h"
+#include "FrameTraceRecorder.h"
+#include "FrameRecorder.h"
+#include "BenchmarkRecorder.h"
+#include "CadenceDetector.h"
+#include "CaptureThread.h"
 #include "ScalingError.h"
 
 namespace Magpie {
@@ -38,7 +44,7 @@ public:
 	}
 
 	const FrameSourceBase& FrameSource() const noexcept {
-		return *_frameSource;
+		return _captureThread ? _captureThread->FrameSource() : *_frameSource;
 	}
 
 	void OnCursorVisibilityChanged(bool isVisible, bool onDestory);
@@ -54,6 +60,16 @@ public:
 		return _effectInfos;
 	}
 
+	// 只能由前端线程访问
+	const FrameLatencyTracker& LatencyTracker() const noexcept {
+		return _latencyTracker;
+	}
+
+	// 前端线程只能读取 FPS 和等待用时
+	const StepTimer& FrameTimer() const noexcept {
+		return _stepTimer;
+	}
+
 private:
 	bool _CreateSwapChain() noexcept;
 
@@ -61,17 +77,40 @@ private:
 
 	void _BackendThreadProc() noexcept;
 
+	// 学习源内容的帧率，跳过必然重复的帧
+	void _UpdateCadence() noexcept;
+
 	ID3D11Texture2D* _InitBackend() noexcept;
 
 	bool _InitFrameSource() noexcept;
 
+	// 以下根据是否使用捕获线程转发给 _captureThread 或 _frameSource
+	ID3D11Texture2D* _GetFrameSourceOutput() noexcept;
+
+	FrameSourceState _UpdateFrameSource() noexcept;
+
+	std::chrono::steady_clock::time_point _CaptureTime() const noexcept;
+
+	DuplicateFrameCheckResult _LastDuplicateCheckResult() const noexcept;
+
+	// 使用捕获线程时总是返回 nullptr，因为捕获线程中同步检查重复帧
+	ID3D11Predicate* _DuplicateFramePredicate() const noexcept;
+
+	// 不能在前端线程释放
+	void _ReleaseFrameSource() noexcept;
+
 	ID3D11Texture2D* _BuildEffects() noexcept;
 
 	HANDLE _CreateSharedTexture(ID3D11Texture2D* effectsOutput) noexcept;
 
-	void _BackendRender(ID3D11Texture2D* effectsOutput) noexcept;
+	// 返回是否呈现了新帧
+	bool _BackendRender(ID3D11Texture2D* effectsOutput) noexcept;
 
-	bool _UpdateDynamicConstants() const noexcept;
+	void _StartEffectsProfiler() noexcept;
+
+	void _InitBenchmarkRecorder(ID3D11Texture2D* effectsOutput) noexcept;
+
+	bool _UpdateDynamicConstants(uint32_t frameCount) const noexcept;
 
 	static LRESULT CALLBACK _LowLevelKeyboardHook(int nCode, WPARAM wParam, LPARAM lParam);
 
@@ -93,6 +132,10 @@ private:
 	winrt::com_ptr<ID3D11Texture2D> _frontendSharedTexture;
 	winrt::com_ptr<IDXGIKeyedMutex> _frontendSharedTextureMutex;
 	RECT _destRect{};
+
+	// 前端线程和后端线程都会访问，见 FrameLatencyTracker 和 FrameTraceRecorder
+	FrameLatencyTracker _latencyTracker;
+	FrameTraceRecorder _frameTraceRecorder;
 	
 	std::thread _backendThread;
 
@@ -101,11 +144,16 @@ private:
 	// 只能由后台线程访问
 	DeviceResources _backendResources;
 	Magpie::BackendDescriptorStore _backendDescriptorStore;
+	// 启用捕获线程时 _frameSource 为空，捕获源由 _captureThread 拥有
 	std::unique_ptr<FrameSourceBase> _frameSource;
+	std::unique_ptr<CaptureThread> _captureThread;
 	std::vector<EffectDrawer> _effectDrawers;
 
 	StepTimer _stepTimer;
+	CadenceDetector _cadenceDetector;
 	EffectsProfiler _effectsProfiler;
+	FrameRecorder _frameRecorder;
+	BenchmarkRecorder _benchmarkRecorder;
 
 	winrt::com_ptr<ID3D11Fence> _d3dFence;
 	uint64_t _fenceValue = 0;
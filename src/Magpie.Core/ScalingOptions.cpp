@@ -57,6 +57,18 @@ void ScalingOptions::Log() const noexcept {
 	IsAdjustCursorSpeed: {}
 	IsDrawCursor: {}
 	IsDirectFlipDisabled: {}
+	IsEffectsProfilerAlwaysOn: {}
+	IsFrameLatencyExportEnabled: {}
+	IsFrameTraceEnabled: {}
+	IsLowLatencyPacingEnabled: {}
+	IsCadenceLockingEnabled: {}
+	IsAsyncDuplicateFrameCheckEnabled: {}
+	IsTileChangeMapEnabled: {}
+	IsCaptureThreadEnabled: {}
+	IsZeroCopyCaptureEnabled: {}
+	IsFrameRecordingEnabled: {}
+	IsFramePlaybackEnabled: {}
+	IsSyntheticFramesEnabled: {}
 	cropping: {},{},{},{}
 	graphicsCardId:
 		idx: {}
@@ -65,10 +77,13 @@ void ScalingOptions::Log() const noexcept {
 	minFrameRate: {}
 	maxFrameRate: {}
 	cursorScaling: {}
+	effectsProfilerWindow: {}
+	benchmarkFrames: {}
 	captureMethod: {}
 	multiMonitorUsage: {}
 	cursorInterpolationMode: {}
 	duplicateFrameDetectionMode: {}
+	duplicateFramePredictorPolicy: {}
 	effects: {})",
 		IsDebugMode(),
 		IsBenchmarkMode(),
@@ -89,6 +104,18 @@ void ScalingOptions::Log() const noexcept {
 		IsAdjustCursorSpeed(),
 		IsDrawCursor(),
 		IsDirectFlipDisabled(),
+		IsEffectsProfilerAlwaysOn(),
+		IsFrameLatencyExportEnabled(),
+		IsFrameTraceEnabled(),
+		IsLowLatencyPacingEnabled(),
+		IsCadenceLockingEnabled(),
+		IsAsyncDuplicateFrameCheckEnabled(),
+		IsTileChangeMapEnabled(),
+		IsCaptureThreadEnabled(),
+		IsZeroCopyCaptureEnabled(),
+		IsFrameRecordingEnabled(),
+		IsFramePlaybackEnabled(),
+		IsSyntheticFramesEnabled(),
 		cropping.Left, cropping.Top, cropping.Right, cropping.Bottom,
 		graphicsCardId.idx,
 		graphicsCardId.vendorId,
@@ -96,10 +123,13 @@ void ScalingOptions::Log() const noexcept {
 		minFrameRate,
 		maxFrameRate.has_value() ? *maxFrameRate : 0.0f,
 		cursorScaling,
+		effectsProfilerWindow,
+		benchmarkFrames,
 		(int)captureMethod,
 		(int)multiMonitorUsage,
 		(int)cursorInterpolationMode,
 		(int)duplicateFrameDetectionMode,
+		(int)duplicateFramePredictorPolicy,
 		LogEffects(effects)
 	));
 }
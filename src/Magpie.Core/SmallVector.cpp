@@ -9,8 +9,10 @@
  // This file implements the SmallVector class.
  //
  //===----------------------------------------------------------------------===//
-#include "pch.h"
+// 不使用预编译头，只能使用标准库
 #include "SmallVector.h"
+#include <stdexcept>
+#include <string>
 
 namespace Magpie {
 
@@ -1,11 +1,33 @@
 #include "pch.h"
 #include "StepTimer.h"
+#include "Logger.h"
 
 using namespace std::chrono;
 
 namespace Magpie {
 
-void StepTimer::Initialize(float minFrameRate, std::optional<float> maxFrameRate) noexcept {
+// 低延迟模式下预测的用时在最近数帧的最大用时基础上再增加此余量，用于前端复制和呈现以及计时器误差
+static constexpr nanoseconds PACING_MARGIN = 1ms;
+// 计时器余量的范围
+static constexpr nanoseconds MIN_TIMER_MARGIN = 100us;
+static constexpr nanoseconds MAX_TIMER_MARGIN = 2ms;
+// 忙等待时每执行此数量的 YieldProcessor 检查一次是否结束
+static constexpr uint32_t SPIN_BURST = 64;
+
+StepTimer::~StepTimer() noexcept {
+	const nanoseconds sleepTime = SleepTime();
+	const nanoseconds spinTime = SpinTime();
+	if (sleepTime.count() == 0 && spinTime.count() == 0) {
+		return;
+	}
+
+	Logger::Get().Info(fmt::format("等待用时: 睡眠 {:.1f} ms, 忙等待 {:.1f} ms, 计时器余量 {} us",
+		duration_cast<microseconds>(sleepTime).count() / 1000.0f,
+		duration_cast<microseconds>(spinTime).count() / 1000.0f,
+		duration_cast<microseconds>(_timerMargin).count()));
+}
+
+void StepTimer::Initialize(float minFrameRate, std::optional<float> maxFrameRate, bool lowLatencyPacing) noexcept {
 	assert(minFrameRate >= 0);
 	if (minFrameRate > 0) {
 		_maxInterval = duration_cast<nanoseconds>(duration<float>(1 / minFrameRate));
@@ -20,6 +42,8 @@ void StepTimer::Initialize(float minFrameRate, std::optional<float> maxFrameRate
 			// 确保最大帧间隔是最小帧间隔的整数倍，这能使帧间隔保持稳定，代价是实际最小帧率可能比要求的稍高一点
 			_maxInterval = _maxInterval / _minInterval * _minInterval;
 		}
+
+		_isLowLatencyPacing = lowLatencyPacing;
 	}
 }
 
@@ -32,7 +56,25 @@ void StepTimer::Initialize(float minFrameRate, std::optional<float> maxFrameRate
 // ────────▼─────────┬────────┬──────▼─────────
 //    wait │ capture │ render │ wait │ capture
 //
+// 限制最大帧率时渲染完成后的 wait 会增加延迟，因为画面要在交换链中等到下一次垂直同步才能显示。
+// 低延迟模式下根据最近数帧的用时推迟开始捕获的时间，使渲染恰好在呈现目标（即垂直同步）前完成：
+//
+//    vblank                               vblank
+//      │                                    │
+// ─────▼───────────────────┬─────────┬──────▼──
+//      │        wait       │ capture │ render │
+//                          └─ 呈现目标 - 预测用时
+//
 StepTimerStatus StepTimer::WaitForNextFrame(bool waitMsgForNewFrame) noexcept {
+	const StepTimerStatus status = _WaitForNextFrame(waitMsgForNewFrame);
+	if (status != StepTimerStatus::WaitForFPSLimiter) {
+		// 可能开始捕获，从这里开始计算一帧的用时
+		_workStartTime = steady_clock::now();
+	}
+	return status;
+}
+
+StepTimerStatus StepTimer::_WaitForNextFrame(bool waitMsgForNewFrame) noexcept {
 	// 不断更新 _nextFrameStartTime 直到新帧到达
 	_nextFrameStartTime = steady_clock::now();
 
@@ -55,6 +97,21 @@ StepTimerStatus StepTimer::WaitForNextFrame(bool waitMsgForNewFrame) noexcept {
 	// 没有新帧也应更新 FPS。作为性能优化，强制帧无需更新，因为 PrepareForRender 必定会执行
 	_UpdateFPS(_nextFrameStartTime);
 
+	if (_nextFrameStartTime < _cadenceNextFrameTime) {
+		// 内容帧率较低，在此之前捕获到的必然是重复帧
+		_WaitForMsgAndTimer(_cadenceNextFrameTime - _nextFrameStartTime);
+		return StepTimerStatus::WaitForFPSLimiter;
+	}
+
+	if (_isLowLatencyPacing) {
+		if (std::optional<time_point<steady_clock>> startTime = _CalcPacedStartTime(_nextFrameStartTime)) {
+			_WaitForMsgAndTimer(*startTime - _nextFrameStartTime);
+			return StepTimerStatus::WaitForFPSLimiter;
+		}
+	}
+
+	// 低延迟模式下也要检查。推迟开始时间只会使帧间隔更长，但渲染太慢或最近有一帧用时很长时
+	// _CalcPacedStartTime 不推迟，此时仍应遵守最大帧率
 	if (delta < _minInterval) {
 		_WaitForMsgAndTimer(_minInterval - delta);
 		return StepTimerStatus::WaitForFPSLimiter;
@@ -75,7 +132,11 @@ StepTimerStatus StepTimer::WaitForNextFrame(bool waitMsgForNewFrame) noexcept {
 
 void StepTimer::PrepareForRender() noexcept {
 	// 进入新一帧，计算此帧的开始时间
-	if (_HasMinInterval()) {
+	if (_isLowLatencyPacing) {
+		// 帧间隔由呈现目标决定，无需修正
+		_thisFrameStartTime = _nextFrameStartTime;
+		_lastPresentTarget = _curPresentTarget;
+	} else if (_HasMinInterval()) {
 		// 限制最大帧率时帧间隔必须是最小帧间隔的整数倍，_nextFrameStartTime 需要稍微向前修正。
 		// 出于同样的原因，最大帧间隔应是最小帧间隔的整数倍。
 		_thisFrameStartTime = _nextFrameStartTime -
@@ -90,26 +151,124 @@ void StepTimer::PrepareForRender() noexcept {
 	_UpdateFPS(steady_clock::now());
 }
 
-void StepTimer::_WaitForMsgAndTimer(std::chrono::nanoseconds time) noexcept {
-	if (time > 1ms) {
+void StepTimer::OnFrameRendered() noexcept {
+	if (!_isLowLatencyPacing) {
+		return;
+	}
+
+	_frameCosts[_frameCostIdx] = steady_clock::now() - _workStartTime;
+	_frameCostIdx = (_frameCostIdx + 1) % (uint32_t)_frameCosts.size();
+}
+
+void StepTimer::OnVBlank(int64_t syncQPCTime) noexcept {
+	static const int64_t freq = []() {
+		LARGE_INTEGER li;
+		QueryPerformanceFrequency(&li);
+		return li.QuadPart;
+	}();
+
+	// 和 MSVC 中 steady_clock 的实现相同，分两部分计算以避免溢出
+	const int64_t whole = (syncQPCTime / freq) * std::nano::den;
+	const int64_t part = (syncQPCTime % freq) * std::nano::den / freq;
+	_vblankTime.store(whole + part, std::memory_order_relaxed);
+}
+
+std::optional<time_point<steady_clock>> StepTimer::_CalcPacedStartTime(time_point<steady_clock> now) noexcept {
+	// 宁可早完成也不要错过呈现目标，因此使用最近数帧的最大用时
+	const nanoseconds predictedCost = *std::max_element(_frameCosts.begin(), _frameCosts.end()) + PACING_MARGIN;
+	if (predictedCost >= _minInterval) {
+		// 渲染太慢，推迟没有意义
+		_curPresentTarget = {};
+		return std::nullopt;
+	}
+
+	// 呈现目标对齐到垂直同步，未知时对齐到上一帧的呈现目标
+	time_point<steady_clock> anchor = now;
+	if (const nanoseconds::rep vblankTime = _vblankTime.load(std::memory_order_relaxed)) {
+		anchor = time_point<steady_clock>(nanoseconds(vblankTime));
+	} else if (_lastPresentTarget != time_point<steady_clock>{}) {
+		anchor = _lastPresentTarget;
+	}
+
+	time_point<steady_clock> earliest = now + predictedCost;
+	if (_lastPresentTarget != time_point<steady_clock>{}) {
+		// 两个呈现目标至少相隔最小帧间隔。垂直同步的时间会有少许漂移，因此容许半个帧间隔的误差
+		earliest = std::max(earliest, _lastPresentTarget + _minInterval / 2);
+	}
+
+	// 向上取整到 anchor + k * _minInterval
+	time_point<steady_clock> presentTarget = anchor;
+	if (earliest > anchor) {
+		presentTarget += (earliest - anchor + _minInterval - 1ns) / _minInterval * _minInterval;
+	}
+
+	const time_point<steady_clock> startTime = presentTarget - predictedCost;
+	if (startTime > now) {
+		return startTime;
+	}
+
+	_curPresentTarget = presentTarget;
+	return std::nullopt;
+}
+
+void StepTimer::_WaitForMsgAndTimer(nanoseconds time) noexcept {
+	const time_point<steady_clock> now = steady_clock::now();
+
+	if (time > _timerMargin) {
 		if (!_hTimer) {
 			_hTimer.reset(CreateWaitableTimerEx(nullptr, nullptr,
 				CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS));
 		}
 
 		// Sleep 精度太低，我们使用 WaitableTimer 睡眠。负值表示相对时间
+		const nanoseconds sleepTime = time - _timerMargin;
 		LARGE_INTEGER liDueTime{
-			.QuadPart = (time - 1ms).count() / -100
+			.QuadPart = sleepTime.count() / -100
 		};
 		SetWaitableTimerEx(_hTimer.get(), &liDueTime, 0, NULL, NULL, 0, 0);
 
 		// 新消息到达则中止等待
 		HANDLE hTimer = _hTimer.get();
-		MsgWaitForMultipleObjectsEx(1, &hTimer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
-	} else {
-		// 剩余时间在 1ms 以内则“忙等待”
-		Sleep(0);
+		const DWORD waitResult = MsgWaitForMultipleObjectsEx(1, &hTimer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+		const time_point<steady_clock> wakeTime = steady_clock::now();
+		_sleepTime.fetch_add((wakeTime - now).count(), std::memory_order_relaxed);
+
+		if (waitResult == WAIT_OBJECT_0) {
+			// 只有计时器到期才能用于校准
+			_UpdateTimerMargin(wakeTime - (now + sleepTime));
+		}
+
+		// 由调用者重新计算剩余时间
+		return;
 	}
+
+	// 剩余时间在余量以内则忙等待。YieldProcessor 在 x64 上即 _mm_pause，可以降低功耗并让出超线程的资源
+	const time_point<steady_clock> deadline = now + time;
+	time_point<steady_clock> cur;
+	do {
+		for (uint32_t i = 0; i < SPIN_BURST; ++i) {
+			YieldProcessor();
+		}
+
+		cur = steady_clock::now();
+		// 新消息到达则中止等待
+	} while (cur < deadline && HIWORD(GetQueueStatus(QS_ALLINPUT)) == 0);
+
+	_spinTime.fetch_add((cur - now).count(), std::memory_order_relaxed);
+}
+
+void StepTimer::_UpdateTimerMargin(nanoseconds overshoot) noexcept {
+	// 使用指数移动平均估计超时的均值和平均偏差，余量取均值加四倍偏差，可以覆盖绝大多数情况
+	static constexpr float ALPHA = 1.0f / 16;
+
+	const float sample = duration_cast<duration<float, std::micro>>(overshoot).count();
+	_overshootMean += (sample - _overshootMean) * ALPHA;
+	_overshootDeviation += (std::abs(sample - _overshootMean) - _overshootDeviation) * ALPHA;
+
+	const nanoseconds margin = duration_cast<nanoseconds>(
+		duration<float, std::micro>(_overshootMean + 4 * _overshootDeviation));
+	_timerMargin = std::clamp(margin, MIN_TIMER_MARGIN, MAX_TIMER_MARGIN);
 }
 
 void StepTimer::_UpdateFPS(time_point<steady_clock> now) noexcept {
@@ -16,12 +16,26 @@ public:
 	StepTimer(const StepTimer&) = delete;
 	StepTimer(StepTimer&&) = delete;
 
-	void Initialize(float minFrameRate, std::optional<float> maxFrameRate) noexcept;
+	~StepTimer() noexcept;
+
+	// lowLatencyPacing 只在限制最大帧率时有效
+	void Initialize(float minFrameRate, std::optional<float> maxFrameRate, bool lowLatencyPacing) noexcept;
 
 	StepTimerStatus WaitForNextFrame(bool waitMsgForNewFrame) noexcept;
 
 	void PrepareForRender() noexcept;
 
+	// 渲染完成后调用，用于预测下一帧的用时
+	void OnFrameRendered() noexcept;
+
+	// 下一次捕获不早于此时间，用于跳过必然重复的帧。传入默认值取消限制
+	void SetNextFrameTime(std::chrono::time_point<std::chrono::steady_clock> time) noexcept {
+		_cadenceNextFrameTime = time;
+	}
+
+	// 从前端线程调用，syncQPCTime 为最近一次垂直同步的 QPC 时间
+	void OnVBlank(int64_t syncQPCTime) noexcept;
+
 	uint32_t FrameCount() const noexcept {
 		return _frameCount;
 	}
@@ -31,18 +45,45 @@ public:
 		return _framesPerSecond.load(std::memory_order_relaxed);
 	}
 
+	// 从前端线程调用。等待帧率限制时睡眠和忙等待的总用时，忙等待期间一直占用 CPU
+	std::chrono::nanoseconds SleepTime() const noexcept {
+		return std::chrono::nanoseconds(_sleepTime.load(std::memory_order_relaxed));
+	}
+
+	std::chrono::nanoseconds SpinTime() const noexcept {
+		return std::chrono::nanoseconds(_spinTime.load(std::memory_order_relaxed));
+	}
+
 private:
 	bool _HasMinInterval() const noexcept;
 	bool _HasMaxInterval() const noexcept;
 
+	StepTimerStatus _WaitForNextFrame(bool waitMsgForNewFrame) noexcept;
+
+	// 返回应开始捕获的时间，为空表示无需推迟
+	std::optional<std::chrono::time_point<std::chrono::steady_clock>> _CalcPacedStartTime(
+		std::chrono::time_point<std::chrono::steady_clock> now) noexcept;
+
 	void _WaitForMsgAndTimer(std::chrono::nanoseconds time) noexcept;
 
+	void _UpdateTimerMargin(std::chrono::nanoseconds overshoot) noexcept;
+
 	void _UpdateFPS(std::chrono::time_point<std::chrono::steady_clock> now) noexcept;
 
 	std::chrono::nanoseconds _minInterval{};
 	std::chrono::nanoseconds _maxInterval{ std::numeric_limits<std::chrono::nanoseconds::rep>::max() };
 	wil::unique_event_nothrow _hTimer;
 
+	// 计时器的唤醒时间总是稍晚于预定时间，因此提前此余量唤醒，剩余时间忙等待。
+	// 余量根据实测的超时不断修正，初始值为 1ms。
+	std::chrono::nanoseconds _timerMargin = std::chrono::milliseconds(1);
+	// 超时的指数移动平均值和平均偏差，单位为微秒
+	float _overshootMean = 0.0f;
+	float _overshootDeviation = 250.0f;
+	// 睡眠和忙等待的总用时，只由后端线程写入。叠加层显示每秒的用时，缩放结束时记录到日志
+	std::atomic<std::chrono::nanoseconds::rep> _sleepTime = 0;
+	std::atomic<std::chrono::nanoseconds::rep> _spinTime = 0;
+
 	std::chrono::time_point<std::chrono::steady_clock> _thisFrameStartTime;
 	std::chrono::time_point<std::chrono::steady_clock> _nextFrameStartTime;
 	std::chrono::time_point<std::chrono::steady_clock> _lastSecondTime;
@@ -50,6 +91,21 @@ private:
 	uint32_t _frameCount = 0;
 	std::atomic<uint32_t> _framesPerSecond = 0;
 	uint32_t _framesThisSecond = 0;
+
+	// 低延迟模式下推迟捕获和渲染，使其恰好在下一次呈现前完成
+	bool _isLowLatencyPacing = false;
+	// 本次循环开始捕获的时间
+	std::chrono::time_point<std::chrono::steady_clock> _workStartTime;
+	// 最近数帧捕获和渲染的用时，环形缓冲区
+	std::array<std::chrono::nanoseconds, 32> _frameCosts{};
+	uint32_t _frameCostIdx = 0;
+	// 当前帧和上一帧的呈现目标
+	std::chrono::time_point<std::chrono::steady_clock> _curPresentTarget;
+	std::chrono::time_point<std::chrono::steady_clock> _lastPresentTarget;
+	// 由 SetNextFrameTime 设置
+	std::chrono::time_point<std::chrono::steady_clock> _cadenceNextFrameTime;
+	// 最近一次垂直同步的时间，由前端线程写入。0 表示未知
+	std::atomic<std::chrono::nanoseconds::rep> _vblankTime = 0;
 };
 
 }
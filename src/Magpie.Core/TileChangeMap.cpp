@@ -0,0 +1,81 @@
+// 不使用预编译头，只能使用标准库
+#include "TileChangeMap.h"
+#include <algorithm>
+#include <bit>
+
+namespace Magpie {
+
+void TileChangeMap::Initialize(uint32_t width, uint32_t height) noexcept {
+	_width = width;
+	_height = height;
+	_tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	_tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	_bits.assign((_tileCountX * _tileCountY + 31) / 32, 0);
+}
+
+void TileChangeMap::Clear() noexcept {
+	std::fill(_bits.begin(), _bits.end(), 0);
+}
+
+bool TileChangeMap::IsEmpty() const noexcept {
+	return std::all_of(_bits.begin(), _bits.end(), [](uint32_t word) { return word == 0; });
+}
+
+uint32_t TileChangeMap::DirtyCount() const noexcept {
+	uint32_t count = 0;
+	for (uint32_t word : _bits) {
+		count += (uint32_t)std::popcount(word);
+	}
+	return count;
+}
+
+void TileChangeMap::MergeDirtyRects(std::vector<DirtyRect>& rects) const {
+	rects.clear();
+
+	// 以块为单位合并，最后转换为像素。openRects 为下边界在上一行的矩形在 rects 中的索引，按 left 排序
+	std::vector<size_t> openRects;
+	std::vector<size_t> nextOpenRects;
+
+	for (uint32_t y = 0; y < _tileCountY; ++y) {
+		nextOpenRects.clear();
+		size_t openIdx = 0;
+
+		uint32_t x = 0;
+		while (x < _tileCountX) {
+			if (!IsDirty(x, y)) {
+				++x;
+				continue;
+			}
+
+			const uint32_t left = x;
+			do {
+				++x;
+			} while (x < _tileCountX && IsDirty(x, y));
+
+			while (openIdx < openRects.size() && rects[openRects[openIdx]].left < left) {
+				++openIdx;
+			}
+
+			if (openIdx < openRects.size() && rects[openRects[openIdx]].left == left &&
+				rects[openRects[openIdx]].right == x) {
+				// 向下延伸
+				rects[openRects[openIdx]].bottom = y + 1;
+				nextOpenRects.push_back(openRects[openIdx]);
+			} else {
+				nextOpenRects.push_back(rects.size());
+				rects.push_back({ left, y, x, y + 1 });
+			}
+		}
+
+		std::swap(openRects, nextOpenRects);
+	}
+
+	for (DirtyRect& rect : rects) {
+		rect.left *= TILE_SIZE;
+		rect.top *= TILE_SIZE;
+		rect.right = std::min(rect.right * TILE_SIZE, _width);
+		rect.bottom = std::min(rect.bottom * TILE_SIZE, _height);
+	}
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "DirtyRegionPlanner.h"
+
+namespace Magpie {
+
+// 以 64x64 的块为单位记录帧中哪些部分相对前一帧发生了变化。位图由 TileChangeCS 在 GPU 上生成，
+// 每块占一位，按行优先排列。注意此头文件和 TileChangeMap.cpp 只能使用标准库。
+class TileChangeMap {
+public:
+	static constexpr uint32_t TILE_SIZE = 64;
+
+	void Initialize(uint32_t width, uint32_t height) noexcept;
+
+	uint32_t TileCountX() const noexcept {
+		return _tileCountX;
+	}
+
+	uint32_t TileCountY() const noexcept {
+		return _tileCountY;
+	}
+
+	// 位图占用的 uint32_t 个数
+	uint32_t WordCount() const noexcept {
+		return (uint32_t)_bits.size();
+	}
+
+	// 用于从 GPU 取回位图
+	uint32_t* Data() noexcept {
+		return _bits.data();
+	}
+
+	bool IsDirty(uint32_t x, uint32_t y) const noexcept {
+		const uint32_t idx = y * _tileCountX + x;
+		return _bits[idx >> 5] & (1u << (idx & 31));
+	}
+
+	void SetDirty(uint32_t x, uint32_t y) noexcept {
+		const uint32_t idx = y * _tileCountX + x;
+		_bits[idx >> 5] |= 1u << (idx & 31);
+	}
+
+	void Clear() noexcept;
+
+	bool IsEmpty() const noexcept;
+
+	uint32_t DirtyCount() const noexcept;
+
+	// 将变化的块合并为矩形以减少复制次数。每行中连续的块合并为一个矩形，如果和上一行的矩形
+	// 左右边界相同则向下延伸。结果已裁剪到帧的范围，按 top 和 left 排序
+	void MergeDirtyRects(std::vector<DirtyRect>& rects) const;
+
+private:
+	std::vector<uint32_t> _bits;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	uint32_t _tileCountX = 0;
+	uint32_t _tileCountY = 0;
+};
+
+}
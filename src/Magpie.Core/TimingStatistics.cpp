@@ -0,0 +1,97 @@
+// 不使用预编译头，只能使用标准库
+#include "TimingStatistics.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Magpie {
+
+void TimingStatistics::Initialize(uint32_t windowSize) noexcept {
+	assert(windowSize > 0);
+	_samples.resize(windowSize);
+	Clear();
+}
+
+void TimingStatistics::Add(float value) noexcept {
+	if (_samples.empty()) {
+		return;
+	}
+
+	if (_count == _samples.size()) {
+		// 窗口已满，移除最旧的样本
+		const float oldest = _samples[_nextIdx];
+		--_bins[_BinIndex(oldest)];
+		_sum -= oldest;
+	} else {
+		++_count;
+	}
+
+	_samples[_nextIdx] = value;
+	++_bins[_BinIndex(value)];
+	_sum += value;
+
+	if (++_nextIdx == _samples.size()) {
+		_nextIdx = 0;
+	}
+}
+
+void TimingStatistics::Clear() noexcept {
+	_bins.fill(0);
+	_nextIdx = 0;
+	_count = 0;
+	_sum = 0.0;
+}
+
+TimingStatistics::Summary TimingStatistics::Summarize() const noexcept {
+	if (_count == 0) {
+		return {};
+	}
+
+	Summary result;
+	result.count = _count;
+	result.mean = float(_sum / _count);
+
+	// 最小值和最大值不从直方图估计。窗口未满时有效的样本位于 [0, _count)
+	const auto [minIt, maxIt] = std::minmax_element(_samples.begin(), _samples.begin() + _count);
+	result.min = *minIt;
+	result.max = *maxIt;
+
+	result.p50 = _Percentile(0.5f, result.min, result.max);
+	result.p95 = _Percentile(0.95f, result.min, result.max);
+	result.p99 = _Percentile(0.99f, result.min, result.max);
+
+	return result;
+}
+
+uint32_t TimingStatistics::_BinIndex(float value) noexcept {
+	if (!(value > MIN_VALUE)) {
+		// 也处理了 NaN
+		return 0;
+	}
+
+	const uint32_t idx = (uint32_t)(std::log10(value / MIN_VALUE) * BINS_PER_DECADE);
+	return std::min(idx, BIN_COUNT - 1);
+}
+
+// 区间在对数尺度上的中点
+float TimingStatistics::_BinValue(uint32_t idx) noexcept {
+	return MIN_VALUE * std::pow(10.0f, (idx + 0.5f) / BINS_PER_DECADE);
+}
+
+float TimingStatistics::_Percentile(float p, float minValue, float maxValue) const noexcept {
+	// 第 rank 小的样本所在的区间，rank 从 1 开始
+	const uint32_t rank = std::max((uint32_t)std::ceil(p * _count), 1u);
+
+	uint32_t accumulated = 0;
+	for (uint32_t i = 0; i < BIN_COUNT; ++i) {
+		accumulated += _bins[i];
+		if (accumulated >= rank) {
+			// 最小值和最大值是精确的，估计值不应超出它们
+			return std::clamp(_BinValue(i), minValue, maxValue);
+		}
+	}
+
+	return maxValue;
+}
+
+}
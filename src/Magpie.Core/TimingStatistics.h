@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Magpie {
+
+// 统计最近若干个样本的分布。百分位数通过固定大小的对数直方图估计，因此添加样本和移除
+// 过期样本都是 O(1) 的，相对误差约为 1.5%。
+// 注意此头文件和 TimingStatistics.cpp 只能使用标准库。
+class TimingStatistics {
+public:
+	struct Summary {
+		float min = 0.0f;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+		uint32_t count = 0;
+	};
+
+	TimingStatistics() = default;
+
+	void Initialize(uint32_t windowSize) noexcept;
+
+	void Add(float value) noexcept;
+
+	void Clear() noexcept;
+
+	Summary Summarize() const noexcept;
+
+	uint32_t WindowSize() const noexcept {
+		return (uint32_t)_samples.size();
+	}
+
+private:
+	// 直方图覆盖 [1e-3, 1e3)，每个数量级 80 个区间，超出范围的样本计入两端的区间
+	static constexpr float MIN_VALUE = 1e-3f;
+	static constexpr uint32_t BINS_PER_DECADE = 80;
+	static constexpr uint32_t BIN_COUNT = BINS_PER_DECADE * 6;
+
+	static uint32_t _BinIndex(float value) noexcept;
+
+	static float _BinValue(uint32_t idx) noexcept;
+
+	float _Percentile(float p, float minValue, float maxValue) const noexcept;
+
+	std::array<uint32_t, BIN_COUNT> _bins{};
+	// 环形缓冲区，用于在窗口滑动时移除最旧的样本
+	std::vector<float> _samples;
+	uint32_t _nextIdx = 0;
+	uint32_t _count = 0;
+	// 使用 double 避免反复加减带来的累积误差
+	double _sum = 0.0;
+};
+
+}
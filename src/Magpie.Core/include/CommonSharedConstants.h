@@ -20,10 +20,17 @@ struct CommonSharedConstants {
 
 	static constexpr const char* LOG_PATH = "logs\\magpie.log";
 	static constexpr const char* REGISTER_TOUCH_HELPER_LOG_PATH = "logs\\register_touch_helper.log";
+	static constexpr const wchar_t* FRAME_LATENCY_PATH = L"logs\\frame_latency.csv";
+	static constexpr const wchar_t* FRAME_TRACE_PATH = L"logs\\frame_trace.csv";
+	// 录制捕获到的帧和回放都使用此文件，格式见 FrameRecording
+	static constexpr const wchar_t* FRAME_RECORDING_PATH = L"logs\\frames.mpfr";
+	static constexpr const wchar_t* BENCHMARK_REPORT_PATH = L"logs\\benchmark.json";
 	static constexpr const wchar_t* CONFIG_DIR = L"config\\";
 	static constexpr const wchar_t* CONFIG_FILENAME = L"config.json";
 	static constexpr const wchar_t* SOURCES_DIR = L"sources\\";
 	static constexpr const wchar_t* EFFECTS_DIR = L"effects\\";
+	// 构建时生成的内置效果包，格式见 EffectBundle
+	static constexpr const wchar_t* BUILTIN_EFFECTS_BUNDLE_PATH = L"effects\\BuiltinEffects.bin";
 	static constexpr const wchar_t* ASSETS_DIR = L"assets\\";
 	static constexpr const wchar_t* CACHE_DIR = L"cache\\";
 	static constexpr const wchar_t* UPDATE_DIR = L"update\\";
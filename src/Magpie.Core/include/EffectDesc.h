@@ -1,10 +1,11 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <string>
 #include <variant>
+#include <vector>
 #include "SmallVector.h"
 
-struct ID3D10Blob;
-typedef ID3D10Blob ID3DBlob;
-
 namespace Magpie {
 
 enum class EffectIntermediateTextureFormat {
@@ -76,19 +77,34 @@ struct EffectPassFlags {
 };
 
 struct EffectPassDesc {
-	winrt::com_ptr<ID3DBlob> cso;
+	// 编译出的计算着色器字节码
+	std::vector<uint8_t> cso;
 	SmallVector<uint32_t> inputs;
 	SmallVector<uint32_t> outputs;
 	std::array<uint32_t, 3> numThreads{};
 	std::pair<uint32_t, uint32_t> blockSize{};
 	std::string desc;
 	uint32_t flags = 0;	// EffectPassFlags
+	// 由 RADIUS 指定，小于 0 表示未指定
+	int32_t sampleRadius = -1;
 };
 
 struct EffectFlags {
 	static constexpr uint32_t InlineParams = 1;
 };
 
+struct EffectCompilerFlags {
+	// 会影响编译出的字节码的标志放在低 16 位中，这样组织是为了便于缓存
+	static constexpr uint32_t InlineParams = 1;
+	static constexpr uint32_t NoFP16 = 1 << 1;
+
+	// 只解析输出尺寸和参数，供用户界面使用
+	static constexpr uint32_t NoCompile = 1 << 16;
+	static constexpr uint32_t NoCache = 1 << 17;
+	static constexpr uint32_t SaveSources = 1 << 18;
+	static constexpr uint32_t WarningsAreErrors = 1 << 19;
+};
+
 struct EffectDesc {
 	std::string name;
 	std::string sortName;	// 仅供 UI 使用
@@ -63,6 +63,22 @@ struct ScalingFlags {
 	static constexpr uint32_t BenchmarkMode = 1 << 20;
 };
 
+// 开发者选项中用于性能分析和试验的开关，和 ScalingFlags 分开存放，为用户可见的选项保留空间
+struct DeveloperFlags {
+	static constexpr uint32_t EffectsProfilerAlwaysOn = 1;
+	static constexpr uint32_t ExportFrameLatency = 1 << 1;
+	static constexpr uint32_t RecordFrameTrace = 1 << 2;
+	static constexpr uint32_t LowLatencyPacing = 1 << 3;
+	static constexpr uint32_t CadenceLocking = 1 << 4;
+	static constexpr uint32_t AsyncDuplicateFrameCheck = 1 << 5;
+	static constexpr uint32_t TileChangeMap = 1 << 6;
+	static constexpr uint32_t CaptureThread = 1 << 7;
+	static constexpr uint32_t ZeroCopyCapture = 1 << 8;
+	static constexpr uint32_t RecordFrames = 1 << 9;
+	static constexpr uint32_t PlaybackFrames = 1 << 10;
+	static constexpr uint32_t SyntheticFrames = 1 << 11;
+};
+
 enum class ScalingType {
 	Normal,		// Scale 表示缩放倍数
 	Fit,		// Scale 表示相对于屏幕能容纳的最大等比缩放的比例
@@ -88,6 +104,13 @@ enum class DuplicateFrameDetectionMode {
 	Never
 };
 
+// 动态检测重复帧时决定是否检查的策略，见 DuplicateFramePredictor
+enum class DuplicateFramePredictorPolicy {
+	Heuristic,
+	ExponentialBackoff,
+	Learned
+};
+
 struct ScalingOptions {
 	DEFINE_FLAG_ACCESSOR(IsDebugMode, ScalingFlags::DebugMode, flags)
 	DEFINE_FLAG_ACCESSOR(IsBenchmarkMode, ScalingFlags::BenchmarkMode, flags)
@@ -108,13 +131,30 @@ struct ScalingOptions {
 	DEFINE_FLAG_ACCESSOR(IsAdjustCursorSpeed, ScalingFlags::AdjustCursorSpeed, flags)
 	DEFINE_FLAG_ACCESSOR(IsDrawCursor, ScalingFlags::DrawCursor, flags)
 	DEFINE_FLAG_ACCESSOR(IsDirectFlipDisabled, ScalingFlags::DisableDirectFlip, flags)
+	DEFINE_FLAG_ACCESSOR(IsEffectsProfilerAlwaysOn, DeveloperFlags::EffectsProfilerAlwaysOn, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsFrameLatencyExportEnabled, DeveloperFlags::ExportFrameLatency, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsFrameTraceEnabled, DeveloperFlags::RecordFrameTrace, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsLowLatencyPacingEnabled, DeveloperFlags::LowLatencyPacing, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsCadenceLockingEnabled, DeveloperFlags::CadenceLocking, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsAsyncDuplicateFrameCheckEnabled, DeveloperFlags::AsyncDuplicateFrameCheck, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsTileChangeMapEnabled, DeveloperFlags::TileChangeMap, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsCaptureThreadEnabled, DeveloperFlags::CaptureThread, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsZeroCopyCaptureEnabled, DeveloperFlags::ZeroCopyCapture, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsFrameRecordingEnabled, DeveloperFlags::RecordFrames, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsFramePlaybackEnabled, DeveloperFlags::PlaybackFrames, developerFlags)
+	DEFINE_FLAG_ACCESSOR(IsSyntheticFramesEnabled, DeveloperFlags::SyntheticFrames, developerFlags)
 
 	Cropping cropping{};
 	uint32_t flags = ScalingFlags::AdjustCursorSpeed | ScalingFlags::DrawCursor;	// ScalingFlags
+	uint32_t developerFlags = 0;	// DeveloperFlags
 	GraphicsCardId graphicsCardId;
 	float minFrameRate = 0.0f;
 	std::optional<float> maxFrameRate;
 	float cursorScaling = 1.0f;
+	// 效果渲染用时的统计窗口，单位为帧
+	uint32_t effectsProfilerWindow = 300;
+	// 测试模式下记录这么多帧后写入性能测试报告并停止缩放，0 表示不运行性能测试
+	uint32_t benchmarkFrames = 0;
 	CaptureMethod captureMethod = CaptureMethod::GraphicsCapture;
 	MultiMonitorUsage multiMonitorUsage = MultiMonitorUsage::Closest;
 	CursorInterpolationMode cursorInterpolationMode = CursorInterpolationMode::NearestNeighbor;
@@ -122,6 +162,7 @@ struct ScalingOptions {
 	std::vector<EffectOption> effects;
 
 	DuplicateFrameDetectionMode duplicateFrameDetectionMode = DuplicateFrameDetectionMode::Dynamic;
+	DuplicateFramePredictorPolicy duplicateFramePredictorPolicy = DuplicateFramePredictorPolicy::Heuristic;
 
 	void Log() const noexcept;
 };
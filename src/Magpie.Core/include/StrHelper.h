@@ -1,8 +1,9 @@
 #pragma once
+#include <cctype>
+#include <cwctype>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <cwctype>
-#include <wtypes.h>	// BSTR
 #include "SmallVector.h"
 
 namespace Magpie {
@@ -0,0 +1,7 @@
+// 将 DuplicateFrameCS 的结果转换为遮挡谓词：不是重复帧时绘制一个像素
+Buffer<uint> result : register(t0);
+
+float4 main() : SV_POSITION {
+	// 重复帧时将顶点置于视口外，不会产生任何像素
+	return result[0] ? float4(0, 0, 0.5f, 1) : float4(2, 2, 0.5f, 1);
+}
@@ -0,0 +1,46 @@
+// 每个线程组比较一个 64x64 的块，变化的块在位图中置位
+RWBuffer<uint> result : register(u0);
+
+Texture2D tex1 : register(t0);
+Texture2D tex2 : register(t1);
+
+SamplerState sam : register(s0);
+
+groupshared uint isDirty;
+
+[numthreads(8, 8, 1)]
+void main(uint3 tid : SV_GroupThreadID, uint3 gid : SV_GroupID, uint gi : SV_GroupIndex) {
+	uint width, height;
+	tex1.GetDimensions(width, height);
+
+	if (gi == 0) {
+		isDirty = 0;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	// 每个线程检查 8x8 的像素，每次 Gather 2x2
+	const uint2 origin = (gid.xy << 6) + (tid.xy << 3);
+	const float2 invSize = 1 / float2(width, height);
+
+	bool changed = false;
+	[unroll]
+	for (uint i = 0; i < 4; ++i) {
+		[unroll]
+		for (uint j = 0; j < 4; ++j) {
+			const float2 pos = (origin + uint2(j, i) * 2 + 1) * invSize;
+			changed = changed || any(tex1.GatherRed(sam, pos) != tex2.GatherRed(sam, pos))
+				|| any(tex1.GatherGreen(sam, pos) != tex2.GatherGreen(sam, pos))
+				|| any(tex1.GatherBlue(sam, pos) != tex2.GatherBlue(sam, pos));
+		}
+	}
+
+	if (changed) {
+		InterlockedOr(isDirty, 1u);
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if (gi == 0 && isDirty) {
+		const uint tileIdx = gid.y * ((width + 63) >> 6) + gid.x;
+		InterlockedOr(result[tileIdx >> 5], 1u << (tileIdx & 31));
+	}
+}
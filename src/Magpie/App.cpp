@@ -108,6 +108,47 @@ App::App() {
 	});
 }
 
+struct BenchmarkArguments {
+	std::wstring profileName;
+	uint32_t frameCount = 0;
+	bool useSyntheticFrames = false;
+};
+
+// 格式为 -benchmark <帧数> [-synthetic] [配置名]，不是性能测试或格式错误时返回 std::nullopt
+static std::optional<BenchmarkArguments> ParseBenchmarkArguments(const wchar_t* arguments) noexcept {
+	if (!arguments || !std::wstring_view(arguments).starts_with(L"-benchmark"sv)) {
+		return std::nullopt;
+	}
+
+	int argc = 0;
+	wil::unique_hlocal_ptr<wchar_t*[]> argv(CommandLineToArgvW(arguments, &argc));
+	if (!argv || argc < 2 || argv[0] != L"-benchmark"sv) {
+		Logger::Get().Error("性能测试参数无效");
+		return std::nullopt;
+	}
+
+	BenchmarkArguments result;
+
+	wchar_t* end;
+	const unsigned long frameCount = std::wcstoul(argv[1], &end, 10);
+	if (*end != L'\0' || frameCount == 0 || frameCount > std::numeric_limits<uint32_t>::max()) {
+		Logger::Get().Error("性能测试的帧数无效");
+		return std::nullopt;
+	}
+	result.frameCount = (uint32_t)frameCount;
+
+	int i = 2;
+	if (i < argc && argv[i] == L"-synthetic"sv) {
+		result.useSyntheticFrames = true;
+		++i;
+	}
+	if (i < argc) {
+		result.profileName = argv[i];
+	}
+
+	return result;
+}
+
 bool App::Initialize(const wchar_t* arguments) {
 	// 提高时钟分辨率
 	IncreaseTimerResolution();
@@ -182,6 +223,19 @@ bool App::Initialize(const wchar_t* arguments) {
 	_isShowNotifyIconChangedRevoker = AppSettings::Get().IsShowNotifyIconChanged(
 		auto_revoke, [](bool value) { NotifyIconService::Get().IsShow(value); });
 
+	if (std::optional<BenchmarkArguments> benchmarkArgs = ParseBenchmarkArguments(arguments)) {
+		// 性能测试不显示主窗口，结束后自动退出
+		if (!ScalingService::Get().StartBenchmark(
+			benchmarkArgs->profileName, benchmarkArgs->frameCount, benchmarkArgs->useSyntheticFrames)) {
+			Logger::Get().Error("启动性能测试失败");
+			_Uninitialize();
+			return false;
+		}
+
+		AdaptersService::Get().StartMonitor();
+		return true;
+	}
+
 	// 不显示托盘图标时忽略 -t 参数
 	if (!notifyIconService.IsShow() || arguments != L"-t"sv) {
 		if (!_mainWindow->Create()) {
@@ -122,6 +122,8 @@ static void WriteProfile(rapidjson::PrettyWriter<rapidjson::StringBuffer>& write
 	writer.Double(profile.customCursorScaling);
 	writer.Key("cursorInterpolationMode");
 	writer.Uint((uint32_t)profile.cursorInterpolationMode);
+	writer.Key("duplicateFramePredictor");
+	writer.Uint((uint32_t)profile.duplicateFramePredictorPolicy);
 
 	writer.Key("croppingEnabled");
 	writer.Bool(profile.isCroppingEnabled);
@@ -381,6 +383,20 @@ void AppSettings::IsDeveloperMode(bool value) noexcept {
 		_duplicateFrameDetectionMode = DuplicateFrameDetectionMode::Dynamic;
 		_isStatisticsForDynamicDetectionEnabled = false;
 		_isFP16Disabled = false;
+		_isEffectsProfilerAlwaysOn = false;
+		_effectsProfilerWindow = 300;
+		_benchmarkFrames = 0;
+		_isFrameLatencyExportEnabled = false;
+		_isFrameTraceEnabled = false;
+		_isLowLatencyPacingEnabled = false;
+		_isCadenceLockingEnabled = false;
+		_isAsyncDuplicateFrameCheckEnabled = false;
+		_isTileChangeMapEnabled = false;
+		_isCaptureThreadEnabled = false;
+		_isZeroCopyCaptureEnabled = false;
+		_isFrameRecordingEnabled = false;
+		_isFramePlaybackEnabled = false;
+		_isSyntheticFramesEnabled = false;
 	}
 
 	SaveAsync();
@@ -523,6 +539,34 @@ bool AppSettings::_Save(const _AppSettingsData& data) noexcept {
 	writer.Double(data._minFrameRate);
 	writer.Key("disableFP16");
 	writer.Bool(data._isFP16Disabled);
+	writer.Key("effectsProfilerAlwaysOn");
+	writer.Bool(data._isEffectsProfilerAlwaysOn);
+	writer.Key("effectsProfilerWindow");
+	writer.Uint(data._effectsProfilerWindow);
+	writer.Key("benchmarkFrames");
+	writer.Uint(data._benchmarkFrames);
+	writer.Key("exportFrameLatency");
+	writer.Bool(data._isFrameLatencyExportEnabled);
+	writer.Key("recordFrameTrace");
+	writer.Bool(data._isFrameTraceEnabled);
+	writer.Key("lowLatencyPacing");
+	writer.Bool(data._isLowLatencyPacingEnabled);
+	writer.Key("cadenceLocking");
+	writer.Bool(data._isCadenceLockingEnabled);
+	writer.Key("asyncDuplicateFrameCheck");
+	writer.Bool(data._isAsyncDuplicateFrameCheckEnabled);
+	writer.Key("tileChangeMap");
+	writer.Bool(data._isTileChangeMapEnabled);
+	writer.Key("captureThread");
+	writer.Bool(data._isCaptureThreadEnabled);
+	writer.Key("zeroCopyCapture");
+	writer.Bool(data._isZeroCopyCaptureEnabled);
+	writer.Key("recordFrames");
+	writer.Bool(data._isFrameRecordingEnabled);
+	writer.Key("playbackFrames");
+	writer.Bool(data._isFramePlaybackEnabled);
+	writer.Key("syntheticFrames");
+	writer.Bool(data._isSyntheticFramesEnabled);
 
 	ScalingModesService::Get().Export(writer);
 
@@ -688,6 +732,23 @@ void AppSettings::_LoadSettings(const rapidjson::GenericObject<true, rapidjson::
 	JsonHelper::ReadBool(root, "enableStatisticsForDynamicDetection", _isStatisticsForDynamicDetectionEnabled);
 	JsonHelper::ReadFloat(root, "minFrameRate", _minFrameRate);
 	JsonHelper::ReadBool(root, "disableFP16", _isFP16Disabled);
+	JsonHelper::ReadBool(root, "effectsProfilerAlwaysOn", _isEffectsProfilerAlwaysOn);
+	JsonHelper::ReadUInt(root, "effectsProfilerWindow", _effectsProfilerWindow);
+	if (_effectsProfilerWindow == 0 || _effectsProfilerWindow > 10000) {
+		_effectsProfilerWindow = 300;
+	}
+	JsonHelper::ReadUInt(root, "benchmarkFrames", _benchmarkFrames);
+	JsonHelper::ReadBool(root, "exportFrameLatency", _isFrameLatencyExportEnabled);
+	JsonHelper::ReadBool(root, "recordFrameTrace", _isFrameTraceEnabled);
+	JsonHelper::ReadBool(root, "lowLatencyPacing", _isLowLatencyPacingEnabled);
+	JsonHelper::ReadBool(root, "cadenceLocking", _isCadenceLockingEnabled);
+	JsonHelper::ReadBool(root, "asyncDuplicateFrameCheck", _isAsyncDuplicateFrameCheckEnabled);
+	JsonHelper::ReadBool(root, "tileChangeMap", _isTileChangeMapEnabled);
+	JsonHelper::ReadBool(root, "captureThread", _isCaptureThreadEnabled);
+	JsonHelper::ReadBool(root, "zeroCopyCapture", _isZeroCopyCaptureEnabled);
+	JsonHelper::ReadBool(root, "recordFrames", _isFrameRecordingEnabled);
+	JsonHelper::ReadBool(root, "playbackFrames", _isFramePlaybackEnabled);
+	JsonHelper::ReadBool(root, "syntheticFrames", _isSyntheticFramesEnabled);
 
 	[[maybe_unused]] bool result = ScalingModesService::Get().Import(root, true);
 	assert(result);
@@ -884,6 +945,15 @@ bool AppSettings::_LoadProfile(
 		profile.cursorInterpolationMode = (CursorInterpolationMode)cursorInterpolationMode;
 	}
 
+	{
+		uint32_t duplicateFramePredictorPolicy = (uint32_t)DuplicateFramePredictorPolicy::Heuristic;
+		JsonHelper::ReadUInt(profileObj, "duplicateFramePredictor", duplicateFramePredictorPolicy);
+		if (duplicateFramePredictorPolicy > 2) {
+			duplicateFramePredictorPolicy = (uint32_t)DuplicateFramePredictorPolicy::Heuristic;
+		}
+		profile.duplicateFramePredictorPolicy = (DuplicateFramePredictorPolicy)duplicateFramePredictorPolicy;
+	}
+
 	JsonHelper::ReadBool(profileObj, "croppingEnabled", profile.isCroppingEnabled);
 
 	auto croppingNode = profileObj.FindMember("cropping");
@@ -50,6 +50,10 @@ struct _AppSettingsData {
 		DuplicateFrameDetectionMode::Dynamic;
 
 	float _minFrameRate = 10.0f;
+	// 必须在 1~10000 之间
+	uint32_t _effectsProfilerWindow = 300;
+	// 测试模式下记录这么多帧后生成性能测试报告并停止缩放，0 表示不运行性能测试
+	uint32_t _benchmarkFrames = 0;
 	
 	bool _isPortableMode = false;
 	bool _isAlwaysRunAsAdmin = false;
@@ -70,6 +74,18 @@ struct _AppSettingsData {
 	bool _isCheckForPreviewUpdates = false;
 	bool _isStatisticsForDynamicDetectionEnabled = false;
 	bool _isFP16Disabled = false;
+	bool _isEffectsProfilerAlwaysOn = false;
+	bool _isFrameLatencyExportEnabled = false;
+	bool _isFrameTraceEnabled = false;
+	bool _isLowLatencyPacingEnabled = false;
+	bool _isCadenceLockingEnabled = false;
+	bool _isAsyncDuplicateFrameCheckEnabled = false;
+	bool _isTileChangeMapEnabled = false;
+	bool _isCaptureThreadEnabled = false;
+	bool _isZeroCopyCaptureEnabled = false;
+	bool _isFrameRecordingEnabled = false;
+	bool _isFramePlaybackEnabled = false;
+	bool _isSyntheticFramesEnabled = false;
 };
 
 class AppSettings : private _AppSettingsData {
@@ -303,6 +319,114 @@ public:
 		SaveAsync();
 	}
 
+	bool IsEffectsProfilerAlwaysOn() const noexcept {
+		return _isEffectsProfilerAlwaysOn;
+	}
+
+	void IsEffectsProfilerAlwaysOn(bool value) noexcept {
+		_isEffectsProfilerAlwaysOn = value;
+		SaveAsync();
+	}
+
+	bool IsFrameLatencyExportEnabled() const noexcept {
+		return _isFrameLatencyExportEnabled;
+	}
+
+	void IsFrameLatencyExportEnabled(bool value) noexcept {
+		_isFrameLatencyExportEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsFrameTraceEnabled() const noexcept {
+		return _isFrameTraceEnabled;
+	}
+
+	void IsFrameTraceEnabled(bool value) noexcept {
+		_isFrameTraceEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsLowLatencyPacingEnabled() const noexcept {
+		return _isLowLatencyPacingEnabled;
+	}
+
+	void IsLowLatencyPacingEnabled(bool value) noexcept {
+		_isLowLatencyPacingEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsCadenceLockingEnabled() const noexcept {
+		return _isCadenceLockingEnabled;
+	}
+
+	void IsCadenceLockingEnabled(bool value) noexcept {
+		_isCadenceLockingEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsAsyncDuplicateFrameCheckEnabled() const noexcept {
+		return _isAsyncDuplicateFrameCheckEnabled;
+	}
+
+	void IsAsyncDuplicateFrameCheckEnabled(bool value) noexcept {
+		_isAsyncDuplicateFrameCheckEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsTileChangeMapEnabled() const noexcept {
+		return _isTileChangeMapEnabled;
+	}
+
+	void IsTileChangeMapEnabled(bool value) noexcept {
+		_isTileChangeMapEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsCaptureThreadEnabled() const noexcept {
+		return _isCaptureThreadEnabled;
+	}
+
+	void IsCaptureThreadEnabled(bool value) noexcept {
+		_isCaptureThreadEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsZeroCopyCaptureEnabled() const noexcept {
+		return _isZeroCopyCaptureEnabled;
+	}
+
+	void IsZeroCopyCaptureEnabled(bool value) noexcept {
+		_isZeroCopyCaptureEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsFrameRecordingEnabled() const noexcept {
+		return _isFrameRecordingEnabled;
+	}
+
+	void IsFrameRecordingEnabled(bool value) noexcept {
+		_isFrameRecordingEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsFramePlaybackEnabled() const noexcept {
+		return _isFramePlaybackEnabled;
+	}
+
+	void IsFramePlaybackEnabled(bool value) noexcept {
+		_isFramePlaybackEnabled = value;
+		SaveAsync();
+	}
+
+	bool IsSyntheticFramesEnabled() const noexcept {
+		return _isSyntheticFramesEnabled;
+	}
+
+	void IsSyntheticFramesEnabled(bool value) noexcept {
+		_isSyntheticFramesEnabled = value;
+		SaveAsync();
+	}
+
 	float MinFrameRate() const noexcept {
 		return _minFrameRate;
 	}
@@ -312,6 +436,24 @@ public:
 		SaveAsync();
 	}
 
+	uint32_t EffectsProfilerWindow() const noexcept {
+		return _effectsProfilerWindow;
+	}
+
+	void EffectsProfilerWindow(uint32_t value) noexcept {
+		_effectsProfilerWindow = value;
+		SaveAsync();
+	}
+
+	uint32_t BenchmarkFrames() const noexcept {
+		return _benchmarkFrames;
+	}
+
+	void BenchmarkFrames(uint32_t value) noexcept {
+		_benchmarkFrames = value;
+		SaveAsync();
+	}
+
 	Event<AppTheme> ThemeChanged;
 	Event<winrt::Magpie::ShortcutAction> ShortcutChanged;
 	Event<bool> IsAutoRestoreChanged;
@@ -26,6 +26,7 @@ struct Profile {
 		maxFrameRate = other.maxFrameRate;
 		multiMonitorUsage = other.multiMonitorUsage;
 		cursorInterpolationMode = other.cursorInterpolationMode;
+		duplicateFramePredictorPolicy = other.duplicateFramePredictorPolicy;
 		launchParameters = other.launchParameters;
 		scalingFlags = other.scalingFlags;
 
@@ -62,6 +63,8 @@ struct Profile {
 	GraphicsCardId graphicsCardId;
 	MultiMonitorUsage multiMonitorUsage = MultiMonitorUsage::Closest;
 	CursorInterpolationMode cursorInterpolationMode = CursorInterpolationMode::NearestNeighbor;
+	// 暂无界面，只能通过配置文件修改
+	DuplicateFramePredictorPolicy duplicateFramePredictorPolicy = DuplicateFramePredictorPolicy::Heuristic;
 
 	// 10~1000
 	float maxFrameRate = 60.0f;
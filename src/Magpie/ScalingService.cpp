@@ -7,6 +7,7 @@
 #include "ScalingModesService.h"
 #include "ScalingMode.h"
 #include "Logger.h"
+#include "StrHelper.h"
 #include "EffectsService.h"
 #include "TouchHelper.h"
 #include "ToastService.h"
@@ -112,6 +113,44 @@ void ScalingService::CheckForeground() {
 	_CheckForegroundTimer_Tick(nullptr);
 }
 
+bool ScalingService::StartBenchmark(std::wstring_view profileName, uint32_t frameCount, bool useSyntheticFrames) {
+	const Profile* profile = nullptr;
+	if (profileName.empty()) {
+		profile = &ProfileService::Get().DefaultProfile();
+	} else {
+		ProfileService& profileService = ProfileService::Get();
+		for (uint32_t i = 0, count = profileService.GetProfileCount(); i < count; ++i) {
+			if (profileService.GetProfile(i).name == profileName) {
+				profile = &profileService.GetProfile(i);
+				break;
+			}
+		}
+
+		if (!profile) {
+			Logger::Get().Error(StrHelper::Concat("找不到配置 ", StrHelper::UTF16ToUTF8(profileName)));
+			return false;
+		}
+	}
+
+	HWND hWnd = GetForegroundWindow();
+	if (ScalingError error = _CheckSrcWnd(hWnd, true); error != ScalingError::NoError) {
+		Logger::Get().Error(fmt::format("前台窗口无法缩放: {}", (int)error));
+		return false;
+	}
+
+	Logger::Get().Info(fmt::format("开始性能测试，共 {} 帧{}", frameCount, useSyntheticFrames ? "，使用生成的图案" : ""));
+
+	_benchmarkRun = _BenchmarkRun{ frameCount, useSyntheticFrames };
+	_StartScale(hWnd, *profile);
+	if (_hwndCurSrc != hWnd) {
+		// 缩放选项无效
+		_benchmarkRun.reset();
+		return false;
+	}
+
+	return true;
+}
+
 void ScalingService::_WndToRestore(HWND value) {
 	if (_hwndToRestore == value) {
 		return;
@@ -288,6 +327,13 @@ void ScalingService::_ScalingRuntime_IsRunningChanged(bool isRunning, ScalingErr
 
 			_hwndCurSrc = NULL;
 
+			if (_benchmarkRun) {
+				// 命令行启动的性能测试结束后退出，调用者可以等待进程结束后读取报告
+				_benchmarkRun.reset();
+				App::Get().Quit();
+				return;
+			}
+
 			// 立即检查前台窗口
 			_CheckForegroundTimer_Tick(nullptr);
 		}
@@ -331,6 +377,7 @@ void ScalingService::_StartScale(HWND hWnd, const Profile& profile) {
 		options.maxFrameRate = profile.maxFrameRate;
 	}
 	options.multiMonitorUsage = profile.multiMonitorUsage;
+	options.duplicateFramePredictorPolicy = profile.duplicateFramePredictorPolicy;
 	options.cursorInterpolationMode = profile.cursorInterpolationMode;
 	options.flags = profile.scalingFlags;
 
@@ -385,6 +432,29 @@ void ScalingService::_StartScale(HWND hWnd, const Profile& profile) {
 	options.IsStatisticsForDynamicDetectionEnabled(settings.IsStatisticsForDynamicDetectionEnabled());
 	options.IsInlineParams(settings.IsInlineParams());
 	options.IsFP16Disabled(settings.IsFP16Disabled());
+	options.IsEffectsProfilerAlwaysOn(settings.IsEffectsProfilerAlwaysOn());
+	options.effectsProfilerWindow = settings.EffectsProfilerWindow();
+	options.benchmarkFrames = settings.BenchmarkFrames();
+	options.IsFrameLatencyExportEnabled(settings.IsFrameLatencyExportEnabled());
+	options.IsFrameTraceEnabled(settings.IsFrameTraceEnabled());
+	options.IsLowLatencyPacingEnabled(settings.IsLowLatencyPacingEnabled());
+	options.IsCadenceLockingEnabled(settings.IsCadenceLockingEnabled());
+	options.IsAsyncDuplicateFrameCheckEnabled(settings.IsAsyncDuplicateFrameCheckEnabled());
+	options.IsTileChangeMapEnabled(settings.IsTileChangeMapEnabled());
+	options.IsCaptureThreadEnabled(settings.IsCaptureThreadEnabled());
+	options.IsZeroCopyCaptureEnabled(settings.IsZeroCopyCaptureEnabled());
+	options.IsFrameRecordingEnabled(settings.IsFrameRecordingEnabled());
+	options.IsFramePlaybackEnabled(settings.IsFramePlaybackEnabled());
+	options.IsSyntheticFramesEnabled(settings.IsSyntheticFramesEnabled());
+
+	if (_benchmarkRun) {
+		// 命令行参数优先于开发者选项
+		options.IsBenchmarkMode(true);
+		options.benchmarkFrames = _benchmarkRun->frameCount;
+		if (_benchmarkRun->useSyntheticFrames) {
+			options.IsSyntheticFramesEnabled(true);
+		}
+	}
 	
 	if (options.maxFrameRate) {
 		// 最小帧数不能大于最大帧数
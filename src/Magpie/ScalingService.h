@@ -50,6 +50,11 @@ public:
 	// 强制重新检查前台窗口
 	void CheckForeground();
 
+	// 使用名为 profileName 的配置缩放前台窗口并运行 frameCount 帧的性能测试，缩放结束后退出程序。
+	// profileName 为空时使用默认配置。useSyntheticFrames 为 true 时使用生成的图案代替捕获。
+	// 返回 false 表示无法开始缩放
+	bool StartBenchmark(std::wstring_view profileName, uint32_t frameCount, bool useSyntheticFrames);
+
 	Event<bool> IsTimerOnChanged;
 	Event<double> TimerTick;
 	Event<HWND> WndToRestoreChanged;
@@ -91,6 +96,13 @@ private:
 
 	HWND _hwndCurSrc = NULL;
 	HWND _hwndToRestore = NULL;
+
+	// 由命令行启动的性能测试，见 StartBenchmark
+	struct _BenchmarkRun {
+		uint32_t frameCount = 0;
+		bool useSyntheticFrames = false;
+	};
+	std::optional<_BenchmarkRun> _benchmarkRun;
 	// 1. 避免重复检查同一个窗口
 	// 2. 用户使用热键退出全屏后暂时阻止该窗口自动放大
 	// 可能在线程池中访问，因此增加原子性
@@ -0,0 +1,143 @@
+// BenchmarkCompare.cpp : 比较 Magpie 生成的两份性能测试报告 (logs\benchmark.json)
+// 只使用标准库，在 Linux 上可以直接编译:
+// g++ -std=c++20 -O2 -I../../src/Magpie.Core BenchmarkCompare.cpp ../../src/Magpie.Core/BenchmarkReport.cpp -o BenchmarkCompare
+//
+
+#include "BenchmarkReport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+using namespace Magpie;
+
+static bool ReadReport(const char* path, BenchmarkReport& report) {
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs) {
+		return false;
+	}
+
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	return report.FromJson(ss.str());
+}
+
+// 返回相对变化的百分比
+static double RelativeChange(double base, double current) {
+	return base == 0.0 ? 0.0 : (current - base) * 100.0 / base;
+}
+
+// 返回是否变慢超过 threshold (百分比)
+static bool PrintRow(
+	std::string_view name,
+	const BenchmarkStatistics& base,
+	const BenchmarkStatistics& current,
+	double threshold
+) {
+	const double meanChange = RelativeChange(base.mean, current.mean);
+	const double p95Change = RelativeChange(base.p95, current.p95);
+	// 平均值的变化小于两者的标准差时很可能只是噪声
+	const bool isSignificant = std::abs(current.mean - base.mean) > std::max(base.stddev, current.stddev);
+	const bool isRegression = isSignificant && meanChange > threshold;
+
+	std::printf("%-40.*s %10.4f %10.4f %+8.2f%% %10.4f %10.4f %+8.2f%% %s\n",
+		(int)name.size(), name.data(), base.mean, current.mean, meanChange,
+		base.p95, current.p95, p95Change,
+		isRegression ? "变慢" : (isSignificant && meanChange < -threshold ? "变快" : ""));
+
+	return isRegression;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	// 平均用时增加超过此百分比且超出噪声时视为变慢
+	double threshold = 5.0;
+	const char* paths[2]{};
+	int pathCount = 0;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--threshold" && i + 1 < argc) {
+			threshold = std::stod(argv[++i]);
+		} else if (pathCount < 2) {
+			paths[pathCount++] = argv[i];
+		}
+	}
+
+	if (pathCount != 2) {
+		std::cout << "用法: BenchmarkCompare [--threshold <百分比>] <基准报告> <当前报告>" << std::endl;
+		return 2;
+	}
+
+	BenchmarkReport reports[2];
+	for (int i = 0; i < 2; ++i) {
+		if (!ReadReport(paths[i], reports[i])) {
+			std::cout << "读取 " << paths[i] << " 失败" << std::endl;
+			return 2;
+		}
+	}
+
+	const BenchmarkReport& base = reports[0];
+	const BenchmarkReport& current = reports[1];
+
+	if (base.inputWidth != current.inputWidth || base.inputHeight != current.inputHeight ||
+		base.outputWidth != current.outputWidth || base.outputHeight != current.outputHeight) {
+		std::printf("警告: 尺寸不同 (%ux%u -> %ux%u 和 %ux%u -> %ux%u)\n",
+			base.inputWidth, base.inputHeight, base.outputWidth, base.outputHeight,
+			current.inputWidth, current.inputHeight, current.outputWidth, current.outputHeight);
+	}
+	if (base.frameSource != current.frameSource) {
+		std::printf("警告: 捕获方式不同 (%s 和 %s)\n", base.frameSource.c_str(), current.frameSource.c_str());
+	}
+	std::printf("帧数: %u 和 %u, 阈值: %.2f%%\n\n", base.frameCount, current.frameCount, threshold);
+
+	std::printf("%-40s %10s %10s %9s %10s %10s %9s\n",
+		"项目 (ms)", "基准平均", "当前平均", "变化", "基准 P95", "当前 P95", "变化");
+
+	bool hasRegression = false;
+	hasRegression |= PrintRow("GPU 总用时", base.gpuTime, current.gpuTime, threshold);
+	hasRegression |= PrintRow("CPU 提交用时", base.cpuSubmitTime, current.cpuSubmitTime, threshold);
+	PrintRow("帧间隔", base.frameInterval, current.frameInterval, threshold);
+
+	// 按名字匹配效果和通道，效果链不同时只比较共有的部分
+	for (const BenchmarkEffectResult& baseEffect : base.effects) {
+		auto effectIt = std::find_if(current.effects.begin(), current.effects.end(),
+			[&](const BenchmarkEffectResult& effect) { return effect.name == baseEffect.name; });
+		if (effectIt == current.effects.end()) {
+			std::printf("%s: 只在基准报告中\n", baseEffect.name.c_str());
+			continue;
+		}
+
+		hasRegression |= PrintRow(baseEffect.name, baseEffect.gpuTime, effectIt->gpuTime, threshold);
+
+		for (const BenchmarkPassResult& basePass : baseEffect.passes) {
+			auto passIt = std::find_if(effectIt->passes.begin(), effectIt->passes.end(),
+				[&](const BenchmarkPassResult& pass) { return pass.name == basePass.name; });
+			if (passIt != effectIt->passes.end()) {
+				PrintRow("  " + basePass.name, basePass.gpuTime, passIt->gpuTime, threshold);
+			}
+		}
+	}
+
+	for (const BenchmarkEffectResult& effect : current.effects) {
+		if (std::none_of(base.effects.begin(), base.effects.end(),
+			[&](const BenchmarkEffectResult& baseEffect) { return baseEffect.name == effect.name; })) {
+			std::printf("%s: 只在当前报告中\n", effect.name.c_str());
+		}
+	}
+
+	// 变慢时返回 1，便于在脚本中使用
+	return hasRegression ? 1 : 0;
+}
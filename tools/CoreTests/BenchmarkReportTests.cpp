@@ -0,0 +1,132 @@
+#include "TestHelper.h"
+#include "BenchmarkReport.h"
+
+using namespace Magpie;
+
+// 第 seed 组统计，数值在 4 位小数内可以精确表示
+static BenchmarkStatistics MakeStatistics(uint32_t seed) {
+	return {
+		.mean = 1.25 + seed,
+		.stddev = 0.0625 * seed,
+		.min = 0.5 + seed,
+		.p50 = 1.125 + seed,
+		.p95 = 2.5 + seed,
+		.p99 = 3.75 + seed,
+		.max = 4.0 + seed,
+		.count = 100 + seed
+	};
+}
+
+static bool operator==(const BenchmarkStatistics& l, const BenchmarkStatistics& r) {
+	return l.mean == r.mean && l.stddev == r.stddev && l.min == r.min && l.p50 == r.p50 &&
+		l.p95 == r.p95 && l.p99 == r.p99 && l.max == r.max && l.count == r.count;
+}
+
+static BenchmarkReport MakeReport() {
+	BenchmarkReport report;
+	report.frameSource = "Synthetic";
+	report.inputWidth = 1280;
+	report.inputHeight = 720;
+	report.outputWidth = 3840;
+	report.outputHeight = 2160;
+	report.frameCount = 500;
+	report.gpuTime = MakeStatistics(0);
+	report.cpuSubmitTime = MakeStatistics(1);
+	report.frameInterval = MakeStatistics(2);
+
+	// 名称中包含需要转义的字符和非 ASCII 字符
+	BenchmarkEffectResult& effect1 = report.effects.emplace_back();
+	effect1.name = "FSR\\EASU \"test\"\t\x01";
+	effect1.gpuTime = MakeStatistics(3);
+	effect1.passes.push_back({ "边缘自适应", MakeStatistics(4) });
+	effect1.passes.push_back({ "Pass 2\n", MakeStatistics(5) });
+
+	// 没有通道名
+	BenchmarkEffectResult& effect2 = report.effects.emplace_back();
+	effect2.name = "Bicubic";
+	effect2.gpuTime = MakeStatistics(6);
+
+	return report;
+}
+
+TEST_CASE(BenchmarkReport_RoundTrip) {
+	const BenchmarkReport report = MakeReport();
+	const std::string json = report.ToJson();
+
+	BenchmarkReport parsed;
+	CHECK(parsed.FromJson(json));
+	CHECK(parsed.frameSource == report.frameSource);
+	CHECK(parsed.inputWidth == 1280 && parsed.inputHeight == 720);
+	CHECK(parsed.outputWidth == 3840 && parsed.outputHeight == 2160);
+	CHECK(parsed.frameCount == 500);
+	CHECK(parsed.gpuTime == report.gpuTime);
+	CHECK(parsed.cpuSubmitTime == report.cpuSubmitTime);
+	CHECK(parsed.frameInterval == report.frameInterval);
+
+	CHECK(parsed.effects.size() == 2);
+	if (parsed.effects.size() == 2) {
+		CHECK(parsed.effects[0].name == report.effects[0].name);
+		CHECK(parsed.effects[0].gpuTime == report.effects[0].gpuTime);
+		CHECK(parsed.effects[0].passes.size() == 2);
+		if (parsed.effects[0].passes.size() == 2) {
+			CHECK(parsed.effects[0].passes[0].name == "边缘自适应");
+			CHECK(parsed.effects[0].passes[1].name == "Pass 2\n");
+			CHECK(parsed.effects[0].passes[1].gpuTime == report.effects[0].passes[1].gpuTime);
+		}
+		CHECK(parsed.effects[1].name == "Bicubic");
+		CHECK(parsed.effects[1].passes.empty());
+	}
+
+	// 输出是稳定的，再次写入得到相同的结果
+	CHECK(parsed.ToJson() == json);
+}
+
+TEST_CASE(BenchmarkReport_Precision) {
+	// 写入时保留 4 位小数
+	BenchmarkReport report;
+	report.gpuTime.mean = 1.23456789;
+	report.gpuTime.max = 1e-7;
+
+	BenchmarkReport parsed;
+	CHECK(parsed.FromJson(report.ToJson()));
+	CHECK(std::abs(parsed.gpuTime.mean - 1.2346) < 1e-9);
+	CHECK(parsed.gpuTime.max == 0.0);
+	CHECK(parsed.effects.empty());
+}
+
+TEST_CASE(BenchmarkReport_Invalid) {
+	const std::string json = MakeReport().ToJson();
+	BenchmarkReport parsed;
+
+	// 版本不同
+	std::string otherVersion = json;
+	const size_t pos = otherVersion.find("\"version\": 1,");
+	CHECK(pos != std::string::npos);
+	otherVersion.replace(pos, 13, "\"version\": 2,");
+	CHECK(!parsed.FromJson(otherVersion));
+
+	// 不完整
+	CHECK(!parsed.FromJson(std::string_view(json).substr(0, json.size() / 2)));
+	CHECK(!parsed.FromJson(""));
+	CHECK(!parsed.FromJson("[]"));
+
+	// 末尾有多余的内容
+	CHECK(!parsed.FromJson(json + "}"));
+}
+
+TEST_CASE(BenchmarkStatistics_Compute) {
+	std::vector<float> samples;
+	for (int i = 100; i >= 1; --i) {
+		samples.push_back((float)i);
+	}
+
+	const BenchmarkStatistics stats = BenchmarkStatistics::Compute(samples);
+	CHECK(stats.count == 100);
+	CHECK(stats.min == 1.0 && stats.max == 100.0);
+	CHECK(stats.mean == 50.5);
+	// 最近秩法
+	CHECK(stats.p50 == 50.0 && stats.p95 == 95.0 && stats.p99 == 99.0);
+	CHECK_NEAR(stats.stddev, 28.866070, 1e-6);
+
+	CHECK(BenchmarkStatistics::Compute({}).count == 0);
+}
@@ -0,0 +1,55 @@
+// CoreTests.cpp : Magpie.Core 中平台无关部分的单元测试
+// 只依赖标准库，在 Linux 上可以直接编译，见 README.md
+//
+
+#include "TestHelper.h"
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+std::vector<TestCase>& GetTestCases() noexcept {
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+static uint32_t failureCount = 0;
+
+void ReportFailure(const char* file, int line, const char* expr) noexcept {
+	std::printf("  %s:%d: 检查失败: %s\n", file, line, expr);
+	++failureCount;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	// 可选参数: 只运行名称包含此字符串的测试
+	const std::string_view filter = argc > 1 ? argv[1] : "";
+
+	uint32_t testCount = 0;
+	uint32_t failedTestCount = 0;
+	for (const TestCase& testCase : GetTestCases()) {
+		if (testCase.name.find(filter) == std::string_view::npos) {
+			continue;
+		}
+
+		++testCount;
+		const uint32_t prevFailureCount = failureCount;
+		testCase.func();
+
+		if (failureCount == prevFailureCount) {
+			std::printf("[通过] %s\n", std::string(testCase.name).c_str());
+		} else {
+			std::printf("[失败] %s\n", std::string(testCase.name).c_str());
+			++failedTestCount;
+		}
+	}
+
+	std::printf("\n%u 个测试，%u 个失败\n", testCount, failedTestCount);
+	return failedTestCount == 0 ? 0 : 1;
+}
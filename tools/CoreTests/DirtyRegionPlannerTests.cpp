@@ -0,0 +1,389 @@
+#include "TestHelper.h"
+#include "DirtyRegionPlanner.h"
+#include <random>
+
+namespace Magpie {
+
+// 供 std::vector 比较
+static bool operator==(const DirtyRect& l, const DirtyRect& r) noexcept {
+	return l.left == r.left && l.top == r.top && l.right == r.right && l.bottom == r.bottom;
+}
+
+static bool operator==(const DirtyDispatch& l, const DirtyDispatch& r) noexcept {
+	return l.x == r.x && l.y == r.y && l.width == r.width && l.height == r.height;
+}
+
+}
+
+using namespace Magpie;
+
+static std::vector<DirtyRect> Normalize(std::vector<DirtyRect> rects, uint32_t maxCount = 8) {
+	DirtyRegionPlanner::NormalizeRects(rects, maxCount);
+	return rects;
+}
+
+TEST_CASE(NormalizeRects_Disjoint) {
+	// 不接触的矩形保持不变，按 top 和 left 排序
+	CHECK(Normalize({ { 50, 10, 60, 20 }, { 0, 0, 10, 10 }, { 20, 10, 30, 20 } }) ==
+		std::vector<DirtyRect>{ { 0, 0, 10, 10 }, { 20, 10, 30, 20 }, { 50, 10, 60, 20 } });
+}
+
+TEST_CASE(NormalizeRects_Overlapping) {
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 5, 5, 15, 15 } }) == std::vector<DirtyRect>{ { 0, 0, 15, 15 } });
+	// 包含
+	CHECK(Normalize({ { 0, 0, 100, 100 }, { 10, 10, 20, 20 } }) == std::vector<DirtyRect>{ { 0, 0, 100, 100 } });
+	// 合并后的矩形和第三个矩形重叠，应继续合并
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 30, 0, 40, 40 }, { 5, 5, 35, 10 } }) ==
+		std::vector<DirtyRect>{ { 0, 0, 40, 40 } });
+}
+
+TEST_CASE(NormalizeRects_Touching) {
+	// 共用一条完整的边时合并
+	CHECK(Normalize({ { 10, 0, 20, 10 }, { 0, 0, 10, 10 } }) == std::vector<DirtyRect>{ { 0, 0, 20, 10 } });
+	CHECK(Normalize({ { 0, 10, 10, 20 }, { 0, 0, 10, 10 } }) == std::vector<DirtyRect>{ { 0, 0, 10, 20 } });
+	// 2x2 的四块合并为一个
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 10, 10, 20, 20 }, { 10, 0, 20, 10 }, { 0, 10, 10, 20 } }) ==
+		std::vector<DirtyRect>{ { 0, 0, 20, 20 } });
+
+	// 只有角或部分边接触时合并会包含未变化的区域，不应合并
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 10, 10, 20, 20 } }) ==
+		std::vector<DirtyRect>{ { 0, 0, 10, 10 }, { 10, 10, 20, 20 } });
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 10, 5, 20, 15 } }) ==
+		std::vector<DirtyRect>{ { 0, 0, 10, 10 }, { 10, 5, 20, 15 } });
+}
+
+TEST_CASE(NormalizeRects_EmptyRects) {
+	CHECK(Normalize({ { 5, 5, 5, 10 }, { 0, 0, 10, 10 }, { 20, 20, 30, 20 } }) ==
+		std::vector<DirtyRect>{ { 0, 0, 10, 10 } });
+	CHECK(Normalize({}).empty());
+}
+
+TEST_CASE(NormalizeRects_MaxCount) {
+	// 超过上限时合并使面积增加最少的两个矩形
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 12, 0, 22, 10 }, { 100, 100, 110, 110 } }, 2) ==
+		std::vector<DirtyRect>{ { 0, 0, 22, 10 }, { 100, 100, 110, 110 } });
+	CHECK(Normalize({ { 0, 0, 10, 10 }, { 12, 0, 22, 10 }, { 100, 100, 110, 110 } }, 1) ==
+		std::vector<DirtyRect>{ { 0, 0, 110, 110 } });
+
+	// 大量矩形直接合并为外接矩形
+	std::vector<DirtyRect> rects;
+	for (uint32_t i = 0; i < 100; ++i) {
+		rects.push_back({ i * 20, i * 10, i * 20 + 10, i * 10 + 5 });
+	}
+	CHECK(Normalize(rects) == std::vector<DirtyRect>{ { 0, 0, 1990, 995 } });
+}
+
+TEST_CASE(NormalizeRects_Random) {
+	// 结果不超过上限，互不重叠，且覆盖所有输入
+	std::mt19937 rng(1);
+	for (int iteration = 0; iteration < 500; ++iteration) {
+		std::vector<DirtyRect> input(rng() % 20);
+		for (DirtyRect& rect : input) {
+			rect.left = rng() % 64;
+			rect.top = rng() % 64;
+			rect.right = rect.left + rng() % 16 + 1;
+			rect.bottom = rect.top + rng() % 16 + 1;
+		}
+
+		const uint32_t maxCount = rng() % 8 + 1;
+		const std::vector<DirtyRect> output = Normalize(input, maxCount);
+		CHECK(output.size() <= maxCount);
+
+		std::vector<uint8_t> inputMask(80 * 80, 0);
+		for (const DirtyRect& rect : input) {
+			for (uint32_t y = rect.top; y < rect.bottom; ++y) {
+				for (uint32_t x = rect.left; x < rect.right; ++x) {
+					inputMask[y * 80 + x] = 1;
+				}
+			}
+		}
+
+		std::vector<uint8_t> outputMask(80 * 80, 0);
+		bool overlapped = false;
+		for (const DirtyRect& rect : output) {
+			for (uint32_t y = rect.top; y < rect.bottom; ++y) {
+				for (uint32_t x = rect.left; x < rect.right; ++x) {
+					overlapped |= outputMask[y * 80 + x] != 0;
+					outputMask[y * 80 + x] = 1;
+				}
+			}
+		}
+		CHECK(!overlapped);
+
+		bool covered = true;
+		for (size_t i = 0; i < inputMask.size(); ++i) {
+			covered &= !inputMask[i] || outputMask[i];
+		}
+		CHECK(covered);
+	}
+}
+
+static DirtyRegion Region(std::vector<DirtyRect> rects) {
+	return { false, std::move(rects) };
+}
+
+static std::vector<DirtyDispatch> Dispatches(const DirtyRegionPlanner& planner, uint32_t passIdx) {
+	const std::span<const DirtyDispatch> dispatches = planner.PassDispatches(passIdx);
+	return std::vector<DirtyDispatch>(dispatches.begin(), dispatches.end());
+}
+
+// 第一次 Plan 总是完整渲染，之后才能按变化的区域规划
+static void PlanFirstFrame(DirtyRegionPlanner& planner) {
+	DirtyRegion outputRegion;
+	planner.Plan(DirtyRegion{}, outputRegion);
+}
+
+TEST_CASE(Plan_FirstFrameAndReset) {
+	DirtyRegionPlanner planner;
+	planner.AddTexture(100, 100, false);
+	planner.AddTexture(200, 200, false);
+	const uint32_t inputs[] = { 0 };
+	const uint32_t outputs[] = { 1 };
+	planner.AddPass(inputs, outputs, 1, 8, 8);
+
+	const DirtyRegion inputRegion = Region({ { 10, 10, 20, 20 } });
+	DirtyRegion outputRegion;
+
+	// 第一帧没有可以保留的内容
+	planner.Plan(inputRegion, outputRegion);
+	CHECK(outputRegion.isWhole);
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 25, 25 } });
+
+	// (10-1)*2=18，(20+1)*2=42
+	planner.Plan(inputRegion, outputRegion);
+	CHECK(!outputRegion.isWhole);
+	CHECK(outputRegion.rects == std::vector<DirtyRect>{ { 18, 18, 42, 42 } });
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 2, 2, 4, 4 } });
+
+	planner.Reset();
+	planner.Plan(inputRegion, outputRegion);
+	CHECK(outputRegion.isWhole);
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 25, 25 } });
+
+	// INPUT 整个变化
+	planner.Plan(DirtyRegion{}, outputRegion);
+	CHECK(outputRegion.isWhole);
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 25, 25 } });
+}
+
+TEST_CASE(Plan_ScaledRadius) {
+	// 放大 2.5 倍，半径为 2
+	DirtyRegionPlanner planner;
+	planner.AddTexture(100, 100, false);
+	planner.AddTexture(250, 250, false);
+	const uint32_t inputs[] = { 0 };
+	const uint32_t outputs[] = { 1 };
+	planner.AddPass(inputs, outputs, 2, 16, 16);
+	PlanFirstFrame(planner);
+
+	DirtyRegion outputRegion;
+	// 扩展为 { 8, 8, 23, 23 }，23*2.5=57.5 向外取整为 58
+	planner.Plan(Region({ { 10, 10, 21, 21 } }), outputRegion);
+	CHECK(!outputRegion.isWhole);
+	CHECK(outputRegion.rects == std::vector<DirtyRect>{ { 20, 20, 58, 58 } });
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 1, 1, 3, 3 } });
+
+	// 扩展时限制在纹理内，95*2.5=237.5 向外取整为 237
+	planner.Plan(Region({ { 0, 0, 3, 3 }, { 97, 98, 100, 100 } }), outputRegion);
+	CHECK(!outputRegion.isWhole);
+	CHECK(outputRegion.rects == std::vector<DirtyRect>{ { 0, 0, 13, 13 }, { 237, 240, 250, 250 } });
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 1, 1 }, { 14, 15, 2, 1 } });
+}
+
+TEST_CASE(Plan_Downscale) {
+	DirtyRegionPlanner planner;
+	planner.AddTexture(100, 100, false);
+	planner.AddTexture(30, 30, false);
+	const uint32_t inputs[] = { 0 };
+	const uint32_t outputs[] = { 1 };
+	planner.AddPass(inputs, outputs, 0, 8, 8);
+	PlanFirstFrame(planner);
+
+	// 10*0.3=3，11*0.3=3.3 向外取整为 4
+	DirtyRegion outputRegion;
+	planner.Plan(Region({ { 10, 10, 11, 11 } }), outputRegion);
+	CHECK(outputRegion.rects == std::vector<DirtyRect>{ { 3, 3, 4, 4 } });
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 1, 1 } });
+}
+
+TEST_CASE(Plan_MultipleOutputs) {
+	// 通道 0 将 INPUT 写入同尺寸的纹理 2 和半尺寸的纹理 3，通道 1 读取两者写入 OUTPUT
+	DirtyRegionPlanner planner;
+	planner.AddTexture(64, 64, false);
+	planner.AddTexture(128, 128, false);
+	planner.AddTexture(64, 64, false);
+	planner.AddTexture(32, 32, false);
+	{
+		const uint32_t inputs[] = { 0 };
+		const uint32_t outputs[] = { 2, 3 };
+		planner.AddPass(inputs, outputs, 1, 8, 8);
+	}
+	{
+		const uint32_t inputs[] = { 2, 3 };
+		const uint32_t outputs[] = { 1 };
+		planner.AddPass(inputs, outputs, 0, 16, 16);
+	}
+	PlanFirstFrame(planner);
+
+	DirtyRegion outputRegion;
+	planner.Plan(Region({ { 10, 10, 20, 20 } }), outputRegion);
+
+	// 纹理 2 变化的区域为 { 9, 9, 21, 21 }，纹理 3 为 { 4, 4, 11, 11 }
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 1, 1, 2, 2 } });
+	// 来自纹理 2 的 { 18, 18, 42, 42 } 被来自纹理 3 的 { 16, 16, 44, 44 } 包含
+	CHECK(!outputRegion.isWhole);
+	CHECK(outputRegion.rects == std::vector<DirtyRect>{ { 16, 16, 44, 44 } });
+	CHECK(Dispatches(planner, 1) == std::vector<DirtyDispatch>{ { 1, 1, 2, 2 } });
+
+	// 下一个效果以此效果的输出为输入
+	DirtyRegionPlanner nextPlanner;
+	nextPlanner.AddTexture(128, 128, false);
+	nextPlanner.AddTexture(128, 128, false);
+	const uint32_t inputs[] = { 0 };
+	const uint32_t outputs[] = { 1 };
+	nextPlanner.AddPass(inputs, outputs, 2, 8, 8);
+	PlanFirstFrame(nextPlanner);
+
+	DirtyRegion nextOutputRegion;
+	nextPlanner.Plan(outputRegion, nextOutputRegion);
+	CHECK(!nextOutputRegion.isWhole);
+	CHECK(nextOutputRegion.rects == std::vector<DirtyRect>{ { 14, 14, 46, 46 } });
+	CHECK(Dispatches(nextPlanner, 0) == std::vector<DirtyDispatch>{ { 1, 1, 5, 5 } });
+}
+
+// 添加 INPUT、OUTPUT 和两个 64x64 的中间纹理，纹理 3 为常量
+static void AddTextures(DirtyRegionPlanner& planner) {
+	planner.AddTexture(64, 64, false);
+	planner.AddTexture(64, 64, false);
+	planner.AddTexture(64, 64, false);
+	planner.AddTexture(64, 64, true);
+}
+
+// 第二帧仍完整渲染则返回 true
+static bool IsAlwaysFull(DirtyRegionPlanner& planner, uint32_t passCount) {
+	PlanFirstFrame(planner);
+
+	DirtyRegion outputRegion;
+	planner.Plan(Region({ { 0, 0, 1, 1 } }), outputRegion);
+
+	bool result = outputRegion.isWhole;
+	for (uint32_t i = 0; i < passCount; ++i) {
+		result &= Dispatches(planner, i) == std::vector<DirtyDispatch>{ { 0, 0, 8, 8 } };
+	}
+	return result;
+}
+
+TEST_CASE(Plan_TemporalDependency) {
+	// 读取常量纹理不影响规划
+	{
+		DirtyRegionPlanner planner;
+		AddTextures(planner);
+		const uint32_t inputs[] = { 0, 3 };
+		const uint32_t outputs[] = { 1 };
+		planner.AddPass(inputs, outputs, 0, 8, 8);
+		CHECK(!IsAlwaysFull(planner, 1));
+	}
+
+	// 纹理 2 在写入前被读取，读到的是上一帧的内容
+	{
+		DirtyRegionPlanner planner;
+		AddTextures(planner);
+		{
+			const uint32_t inputs[] = { 0, 2 };
+			const uint32_t outputs[] = { 1 };
+			planner.AddPass(inputs, outputs, 0, 8, 8);
+		}
+		{
+			const uint32_t inputs[] = { 1 };
+			const uint32_t outputs[] = { 2 };
+			planner.AddPass(inputs, outputs, 0, 8, 8);
+		}
+		CHECK(IsAlwaysFull(planner, 2));
+	}
+
+	// 纹理 2 被两个通道写入
+	{
+		DirtyRegionPlanner planner;
+		AddTextures(planner);
+		{
+			const uint32_t inputs[] = { 0 };
+			const uint32_t outputs[] = { 2 };
+			planner.AddPass(inputs, outputs, 0, 8, 8);
+			planner.AddPass(inputs, outputs, 0, 8, 8);
+		}
+		{
+			const uint32_t inputs[] = { 2 };
+			const uint32_t outputs[] = { 1 };
+			planner.AddPass(inputs, outputs, 0, 8, 8);
+		}
+		CHECK(IsAlwaysFull(planner, 3));
+	}
+}
+
+TEST_CASE(Plan_UnknownRadius) {
+	// 采样半径未知的通道完整渲染，之后的通道也因此完整渲染
+	DirtyRegionPlanner planner;
+	AddTextures(planner);
+	{
+		const uint32_t inputs[] = { 0 };
+		const uint32_t outputs[] = { 2 };
+		planner.AddPass(inputs, outputs, -1, 8, 8);
+	}
+	{
+		const uint32_t inputs[] = { 2 };
+		const uint32_t outputs[] = { 1 };
+		planner.AddPass(inputs, outputs, 0, 8, 8);
+	}
+	CHECK(IsAlwaysFull(planner, 2));
+}
+
+TEST_CASE(Plan_FullDispatchRatio) {
+	// 64 个线程组
+	DirtyRegionPlanner planner;
+	planner.AddTexture(64, 64, false);
+	planner.AddTexture(64, 64, false);
+	const uint32_t inputs[] = { 0 };
+	const uint32_t outputs[] = { 1 };
+	planner.AddPass(inputs, outputs, 0, 8, 8);
+	PlanFirstFrame(planner);
+
+	// 32 个线程组，恰好为 FULL_DISPATCH_RATIO
+	DirtyRegion outputRegion;
+	planner.Plan(Region({ { 0, 0, 64, 32 } }), outputRegion);
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 8, 4 } });
+
+	// 40 个线程组，超过后退回完整 Dispatch，但变化的区域不变
+	planner.Plan(Region({ { 0, 0, 64, 33 } }), outputRegion);
+	CHECK(Dispatches(planner, 0) == std::vector<DirtyDispatch>{ { 0, 0, 8, 8 } });
+	CHECK(!outputRegion.isWhole);
+	CHECK(outputRegion.rects == std::vector<DirtyRect>{ { 0, 0, 64, 33 } });
+}
+
+TEST_CASE(Plan_EmptyRegion) {
+	DirtyRegionPlanner planner;
+	AddTextures(planner);
+	{
+		const uint32_t inputs[] = { 0 };
+		const uint32_t outputs[] = { 2 };
+		planner.AddPass(inputs, outputs, 3, 8, 8);
+	}
+	{
+		const uint32_t inputs[] = { 2, 3 };
+		const uint32_t outputs[] = { 1 };
+		planner.AddPass(inputs, outputs, 0, 8, 8);
+	}
+	PlanFirstFrame(planner);
+
+	// 没有变化时所有通道都无需执行
+	DirtyRegion outputRegion;
+	planner.Plan(Region({}), outputRegion);
+	CHECK(!outputRegion.isWhole);
+	CHECK(outputRegion.rects.empty());
+	CHECK(planner.PassDispatches(0).empty());
+	CHECK(planner.PassDispatches(1).empty());
+
+	// 空矩形被忽略
+	planner.Plan(Region({ { 5, 5, 5, 10 } }), outputRegion);
+	CHECK(outputRegion.rects.empty());
+	CHECK(planner.PassDispatches(0).empty());
+}
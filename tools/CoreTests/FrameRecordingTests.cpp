@@ -0,0 +1,152 @@
+#include "TestHelper.h"
+#include "FrameRecording.h"
+#include <fstream>
+
+using namespace Magpie;
+
+static std::filesystem::path TempPath(const char* name) {
+	return std::filesystem::temp_directory_path() / name;
+}
+
+// 第 frameIdx 帧的像素，行之间的填充为 0xEE
+static std::vector<uint8_t> MakeFrame(uint32_t width, uint32_t height, uint32_t rowPitch, uint32_t frameIdx) {
+	std::vector<uint8_t> pixels(size_t(rowPitch) * height, 0xEE);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width * FrameRecording::BYTES_PER_PIXEL; ++x) {
+			pixels[size_t(y) * rowPitch + x] = uint8_t(frameIdx * 31 + y * 7 + x);
+		}
+	}
+	return pixels;
+}
+
+static bool WriteRecording(const std::filesystem::path& path, uint32_t width, uint32_t height,
+	uint32_t rowPitch, uint32_t frameCount, FrameRecordingFormat format = FrameRecordingFormat::BGRA8) {
+	FrameRecordingWriter writer;
+	if (!writer.Open(path, width, height, format)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < frameCount; ++i) {
+		const std::vector<uint8_t> pixels = MakeFrame(width, height, rowPitch, i);
+		if (!writer.WriteFrame(i * 16'666'667ull, pixels.data(), rowPitch)) {
+			return false;
+		}
+	}
+
+	return writer.FrameCount() == frameCount && writer.Close();
+}
+
+// 修改文件头中 offset 处的 4 个字节
+static void PatchHeader(const std::filesystem::path& path, uint32_t offset, uint32_t value) {
+	std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+	file.seekp(offset);
+	const uint8_t bytes[4] = { uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24) };
+	file.write((const char*)bytes, 4);
+}
+
+TEST_CASE(FrameRecording_RoundTrip) {
+	// 每行 12 字节，rowPitch 为 16，填充不应写入文件
+	const std::filesystem::path path = TempPath("CoreTests_RoundTrip.mpfr");
+	CHECK(WriteRecording(path, 3, 2, 16, 3, FrameRecordingFormat::RGBA8));
+	CHECK(std::filesystem::file_size(path) == FrameRecording::HEADER_SIZE + 3 * (8 + 3 * 2 * 4));
+
+	FrameRecordingReader reader;
+	CHECK(reader.Open(path));
+	CHECK(reader.Width() == 3 && reader.Height() == 2);
+	CHECK(reader.Format() == FrameRecordingFormat::RGBA8);
+	CHECK(reader.FrameCount() == 3);
+
+	// 倒序读取以检查随机访问
+	std::vector<uint8_t> pixels(FrameRecording::FrameDataSize(3, 2));
+	for (uint32_t i = 3; i-- > 0;) {
+		uint64_t timestamp = 0;
+		CHECK(reader.ReadFrame(i, timestamp, pixels));
+		CHECK(timestamp == i * 16'666'667ull);
+
+		const std::vector<uint8_t> expected = MakeFrame(3, 2, 16, i);
+		bool same = true;
+		for (uint32_t y = 0; y < 2; ++y) {
+			same &= std::equal(pixels.begin() + y * 12, pixels.begin() + (y + 1) * 12, expected.begin() + y * 16);
+		}
+		CHECK(same);
+	}
+
+	uint64_t timestamp = 0;
+	CHECK(reader.ReadTimestamp(1, timestamp) && timestamp == 16'666'667ull);
+	CHECK(!reader.ReadTimestamp(3, timestamp));
+
+	// 缓冲区太小
+	std::vector<uint8_t> smallPixels(pixels.size() - 1);
+	CHECK(!reader.ReadFrame(0, timestamp, smallPixels));
+
+	reader = {};
+	std::filesystem::remove(path);
+}
+
+TEST_CASE(FrameRecording_TruncatedLastFrame) {
+	const std::filesystem::path path = TempPath("CoreTests_Truncated.mpfr");
+	CHECK(WriteRecording(path, 4, 4, 16, 3));
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+
+	FrameRecordingReader reader;
+	CHECK(reader.Open(path));
+	CHECK(reader.FrameCount() == 2);
+
+	std::vector<uint8_t> pixels(FrameRecording::FrameDataSize(4, 4));
+	uint64_t timestamp = 0;
+	CHECK(reader.ReadFrame(1, timestamp, pixels));
+	CHECK(!reader.ReadFrame(2, timestamp, pixels));
+
+	// 只剩时间戳的一部分
+	reader = {};
+	std::filesystem::resize_file(path, FrameRecording::HEADER_SIZE + 3);
+	CHECK(reader.Open(path));
+	CHECK(reader.FrameCount() == 0);
+
+	reader = {};
+	std::filesystem::remove(path);
+}
+
+TEST_CASE(FrameRecording_InvalidHeader) {
+	const std::filesystem::path path = TempPath("CoreTests_InvalidHeader.mpfr");
+
+	// 魔数
+	CHECK(WriteRecording(path, 2, 2, 8, 1));
+	PatchHeader(path, 0, 0x5246504E);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	// 版本
+	CHECK(WriteRecording(path, 2, 2, 8, 1));
+	PatchHeader(path, 4, FrameRecording::VERSION + 1);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	// 宽或高为 0
+	CHECK(WriteRecording(path, 2, 2, 8, 1));
+	PatchHeader(path, 8, 0);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	CHECK(WriteRecording(path, 2, 2, 8, 1));
+	PatchHeader(path, 12, 0);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	// 未知的像素格式
+	CHECK(WriteRecording(path, 2, 2, 8, 1));
+	PatchHeader(path, 16, 2);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	// 文件头不完整
+	CHECK(WriteRecording(path, 2, 2, 8, 1));
+	std::filesystem::resize_file(path, FrameRecording::HEADER_SIZE - 1);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	// 文件不存在
+	std::filesystem::remove(path);
+	CHECK(!FrameRecordingReader().Open(path));
+
+	// 写入时也拒绝为 0 的宽或高
+	FrameRecordingWriter writer;
+	CHECK(!writer.Open(path, 0, 2, FrameRecordingFormat::BGRA8));
+	CHECK(!writer.Open(path, 2, 0, FrameRecordingFormat::BGRA8));
+	CHECK(!writer.IsOpen());
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 极简的测试框架。TEST_CASE 定义的测试在启动时注册，CHECK 失败时输出位置并继续执行。
+
+struct TestCase {
+	std::string_view name;
+	void (*func)();
+};
+
+std::vector<TestCase>& GetTestCases() noexcept;
+
+void ReportFailure(const char* file, int line, const char* expr) noexcept;
+
+struct TestRegistrar {
+	TestRegistrar(std::string_view name, void (*func)()) noexcept {
+		GetTestCases().push_back({ name, func });
+	}
+};
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static TestRegistrar name##_registrar(#name, name); \
+	static void name()
+
+// 使用可变参数宏，表达式中可以包含逗号
+#define CHECK(...) \
+	do { \
+		if (!(__VA_ARGS__)) { \
+			ReportFailure(__FILE__, __LINE__, #__VA_ARGS__); \
+		} \
+	} while (false)
+
+// 相对误差不超过 tolerance
+#define CHECK_NEAR(actual, expected, tolerance) \
+	CHECK(std::abs((double)(actual) - (double)(expected)) <= (tolerance) * std::abs((double)(expected)))
@@ -0,0 +1,145 @@
+#include "TestHelper.h"
+#include "TileChangeMap.h"
+#include <random>
+
+namespace Magpie {
+
+// 供 std::vector 比较
+static bool operator==(const DirtyRect& l, const DirtyRect& r) noexcept {
+	return l.left == r.left && l.top == r.top && l.right == r.right && l.bottom == r.bottom;
+}
+
+}
+
+using namespace Magpie;
+
+static std::vector<DirtyRect> Merge(const TileChangeMap& map) {
+	std::vector<DirtyRect> rects;
+	map.MergeDirtyRects(rects);
+	return rects;
+}
+
+TEST_CASE(TileChangeMap_Empty) {
+	TileChangeMap map;
+	map.Initialize(640, 480);
+	CHECK(map.TileCountX() == 10 && map.TileCountY() == 8);
+	CHECK(map.WordCount() == 3);
+	CHECK(map.IsEmpty());
+	CHECK(Merge(map).empty());
+}
+
+TEST_CASE(TileChangeMap_SingleTile) {
+	TileChangeMap map;
+	map.Initialize(640, 480);
+	map.SetDirty(3, 2);
+	CHECK(!map.IsEmpty());
+	CHECK(map.DirtyCount() == 1);
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 192, 128, 256, 192 } });
+
+	map.Clear();
+	CHECK(map.IsEmpty());
+}
+
+TEST_CASE(TileChangeMap_FullRow) {
+	TileChangeMap map;
+	map.Initialize(640, 480);
+	for (uint32_t x = 0; x < map.TileCountX(); ++x) {
+		map.SetDirty(x, 1);
+	}
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 0, 64, 640, 128 } });
+}
+
+TEST_CASE(TileChangeMap_LShape) {
+	// 竖线向下延伸，底部较宽的一行左右边界不同，成为新的矩形
+	TileChangeMap map;
+	map.Initialize(640, 480);
+	map.SetDirty(2, 1);
+	map.SetDirty(2, 2);
+	map.SetDirty(2, 3);
+	map.SetDirty(3, 3);
+	map.SetDirty(4, 3);
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 128, 64, 192, 192 }, { 128, 192, 320, 256 } });
+
+	// 同一行的两段分别延伸
+	map.Clear();
+	for (uint32_t y = 0; y < 3; ++y) {
+		map.SetDirty(0, y);
+		map.SetDirty(5, y);
+		map.SetDirty(6, y);
+	}
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 0, 0, 64, 192 }, { 320, 0, 448, 192 } });
+}
+
+TEST_CASE(TileChangeMap_PartialEdgeTiles) {
+	// 右边和下边的块只有部分在帧内，结果应裁剪到帧的范围
+	TileChangeMap map;
+	map.Initialize(200, 100);
+	CHECK(map.TileCountX() == 4 && map.TileCountY() == 2);
+
+	map.SetDirty(3, 1);
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 192, 64, 200, 100 } });
+
+	map.Clear();
+	map.SetDirty(3, 0);
+	map.SetDirty(3, 1);
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 192, 0, 200, 100 } });
+}
+
+TEST_CASE(TileChangeMap_AllDirty) {
+	TileChangeMap map;
+	map.Initialize(200, 100);
+	for (uint32_t y = 0; y < map.TileCountY(); ++y) {
+		for (uint32_t x = 0; x < map.TileCountX(); ++x) {
+			map.SetDirty(x, y);
+		}
+	}
+	CHECK(map.DirtyCount() == 8);
+	CHECK(Merge(map) == std::vector<DirtyRect>{ { 0, 0, 200, 100 } });
+}
+
+TEST_CASE(TileChangeMap_RandomCoverage) {
+	// 随机的位图合并后应恰好覆盖所有变化的块，矩形互不重叠且按 top 和 left 排序
+	std::mt19937 rng(1);
+	TileChangeMap map;
+	map.Initialize(1000, 700);
+	const uint32_t tileCountX = map.TileCountX();
+	const uint32_t tileCountY = map.TileCountY();
+
+	for (int iteration = 0; iteration < 200; ++iteration) {
+		map.Clear();
+		const uint32_t density = rng() % 100;
+		for (uint32_t y = 0; y < tileCountY; ++y) {
+			for (uint32_t x = 0; x < tileCountX; ++x) {
+				if (rng() % 100 < density) {
+					map.SetDirty(x, y);
+				}
+			}
+		}
+
+		std::vector<uint32_t> coverage(tileCountX * tileCountY, 0);
+		const std::vector<DirtyRect> rects = Merge(map);
+		for (size_t i = 0; i < rects.size(); ++i) {
+			const DirtyRect& rect = rects[i];
+			CHECK(rect.left < rect.right && rect.top < rect.bottom);
+			CHECK(rect.right <= 1000 && rect.bottom <= 700);
+			if (i > 0) {
+				const DirtyRect& prev = rects[i - 1];
+				CHECK(prev.top < rect.top || (prev.top == rect.top && prev.left < rect.left));
+			}
+
+			for (uint32_t y = rect.top / TileChangeMap::TILE_SIZE; y * TileChangeMap::TILE_SIZE < rect.bottom; ++y) {
+				for (uint32_t x = rect.left / TileChangeMap::TILE_SIZE; x * TileChangeMap::TILE_SIZE < rect.right; ++x) {
+					++coverage[y * tileCountX + x];
+				}
+			}
+		}
+
+		bool exact = true;
+		for (uint32_t y = 0; y < tileCountY; ++y) {
+			for (uint32_t x = 0; x < tileCountX; ++x) {
+				exact &= coverage[y * tileCountX + x] == (map.IsDirty(x, y) ? 1u : 0u);
+			}
+		}
+		CHECK(exact);
+	}
+}
@@ -0,0 +1,135 @@
+#include "TestHelper.h"
+#include "TimingStatistics.h"
+
+using namespace Magpie;
+
+// 直方图每个区间的宽度约为 2.9%，中点的误差不超过一半
+static constexpr double BIN_ERROR = 0.015;
+
+TEST_CASE(TimingStatistics_Empty) {
+	TimingStatistics statistics;
+	// 未初始化时忽略样本
+	statistics.Add(1.0f);
+	CHECK(statistics.Summarize().count == 0);
+
+	statistics.Initialize(16);
+	const TimingStatistics::Summary summary = statistics.Summarize();
+	CHECK(summary.count == 0);
+	CHECK(summary.min == 0.0f && summary.max == 0.0f && summary.mean == 0.0f);
+	CHECK(summary.p50 == 0.0f && summary.p95 == 0.0f && summary.p99 == 0.0f);
+
+	statistics.Add(2.0f);
+	statistics.Clear();
+	CHECK(statistics.Summarize().count == 0);
+	CHECK(statistics.WindowSize() == 16);
+}
+
+TEST_CASE(TimingStatistics_Percentiles) {
+	// 0.01, 0.02, ..., 10，打乱顺序添加
+	TimingStatistics statistics;
+	statistics.Initialize(1000);
+	for (uint32_t i = 0; i < 1000; ++i) {
+		statistics.Add(((i * 367) % 1000 + 1) * 0.01f);
+	}
+
+	const TimingStatistics::Summary summary = statistics.Summarize();
+	CHECK(summary.count == 1000);
+	CHECK(summary.min == 0.01f);
+	CHECK(summary.max == 10.0f);
+	CHECK_NEAR(summary.mean, 5.005, 1e-5);
+	CHECK_NEAR(summary.p50, 5.0, BIN_ERROR);
+	CHECK_NEAR(summary.p95, 9.5, BIN_ERROR);
+	CHECK_NEAR(summary.p99, 9.9, BIN_ERROR);
+}
+
+TEST_CASE(TimingStatistics_SingleValue) {
+	// 所有百分位数被限制在精确的最小值和最大值之间
+	TimingStatistics statistics;
+	statistics.Initialize(8);
+	for (int i = 0; i < 5; ++i) {
+		statistics.Add(3.7f);
+	}
+
+	const TimingStatistics::Summary summary = statistics.Summarize();
+	CHECK(summary.count == 5);
+	CHECK(summary.min == 3.7f && summary.max == 3.7f);
+	CHECK(summary.p50 == 3.7f && summary.p95 == 3.7f && summary.p99 == 3.7f);
+}
+
+TEST_CASE(TimingStatistics_OutOfRange) {
+	// 低于 1e-3 的样本计入第一个区间
+	TimingStatistics statistics;
+	statistics.Initialize(100);
+	for (int i = 0; i < 100; ++i) {
+		statistics.Add(i < 99 ? 1e-5f : 0.0f);
+	}
+
+	TimingStatistics::Summary summary = statistics.Summarize();
+	CHECK(summary.min == 0.0f);
+	CHECK(summary.max == 1e-5f);
+	CHECK(summary.p50 == 1e-5f && summary.p99 == 1e-5f);
+
+	// 不低于 1e3 的样本计入最后一个区间
+	statistics.Clear();
+	for (int i = 0; i < 100; ++i) {
+		statistics.Add(i < 90 ? 1.0f : 1e5f);
+	}
+
+	summary = statistics.Summarize();
+	CHECK(summary.max == 1e5f);
+	CHECK_NEAR(summary.p50, 1.0, BIN_ERROR);
+	// 最后一个区间的中点
+	CHECK(summary.p95 > 950.0f && summary.p95 < 1000.0f);
+	CHECK(summary.p99 == summary.p95);
+
+	// 两端都超出范围
+	statistics.Clear();
+	for (int i = 0; i < 100; ++i) {
+		statistics.Add(i % 2 == 0 ? 1e-6f : 1e6f);
+	}
+
+	summary = statistics.Summarize();
+	CHECK(summary.min == 1e-6f && summary.max == 1e6f);
+	CHECK(summary.p50 > 1e-3f && summary.p50 < 1.1e-3f);
+	CHECK(summary.p99 > 950.0f && summary.p99 < 1000.0f);
+}
+
+TEST_CASE(TimingStatistics_WindowEviction) {
+	TimingStatistics statistics;
+	statistics.Initialize(10);
+	for (int i = 0; i < 10; ++i) {
+		statistics.Add(100.0f);
+	}
+
+	// 窗口已满，每个新样本替换最旧的样本
+	for (int i = 0; i < 5; ++i) {
+		statistics.Add(1.0f);
+	}
+
+	TimingStatistics::Summary summary = statistics.Summarize();
+	CHECK(summary.count == 10);
+	CHECK(summary.min == 1.0f && summary.max == 100.0f);
+	CHECK_NEAR(summary.mean, 50.5, 1e-6);
+
+	for (int i = 0; i < 5; ++i) {
+		statistics.Add(1.0f);
+	}
+
+	// 旧样本应全部移出窗口，包括直方图
+	summary = statistics.Summarize();
+	CHECK(summary.count == 10);
+	CHECK(summary.min == 1.0f && summary.max == 1.0f);
+	CHECK_NEAR(summary.mean, 1.0, 1e-6);
+	CHECK(summary.p99 == 1.0f);
+
+	// 长时间运行后均值不应有累积误差
+	for (int i = 0; i < 100000; ++i) {
+		statistics.Add(i % 2 == 0 ? 0.3f : 7.1f);
+	}
+	for (int i = 0; i < 10; ++i) {
+		statistics.Add(2.0f);
+	}
+	summary = statistics.Summarize();
+	CHECK_NEAR(summary.mean, 2.0, 1e-6);
+	CHECK(summary.p50 == 2.0f);
+}
@@ -0,0 +1,340 @@
+// CpuEffects.cpp : 在 CPU 上运行内置效果的参考实现，用于在没有 GPU 的环境中验证效果的输出和比较性能
+// 只使用标准库，在 Linux 上可以直接编译:
+// g++ -std=c++20 -O2 -march=x86-64-v3 -pthread -I../../src/Magpie.Core CpuEffects.cpp CpuImage.cpp Scalers.cpp FidelityFX.cpp ImageDiff.cpp ../../src/Magpie.Core/FrameRecording.cpp -o CpuEffects
+//
+
+#include "Scalers.h"
+#include "FidelityFX.h"
+#include "ImageDiff.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+using namespace Magpie::CpuEffects;
+
+struct EffectInfo {
+	std::string_view name;
+	// 为 true 时输出尺寸由缩放倍数决定，否则和输入相同
+	bool isScaler;
+	// 参数名和默认值
+	std::vector<std::pair<std::string_view, float>> params;
+	std::function<void(const CpuImage&, CpuImage&, const std::map<std::string, float, std::less<>>&)> run;
+};
+
+static const std::vector<EffectInfo>& Effects() {
+	using Params = std::map<std::string, float, std::less<>>;
+	static const std::vector<EffectInfo> effects{
+		{ "Nearest", true, {}, [](const CpuImage& in, CpuImage& out, const Params&) {
+			Nearest(in, out);
+		} },
+		{ "Bilinear", true, {}, [](const CpuImage& in, CpuImage& out, const Params&) {
+			Bilinear(in, out);
+		} },
+		{ "Bicubic", true, { { "paramB", 0.33f }, { "paramC", 0.33f } }, [](const CpuImage& in, CpuImage& out, const Params& p) {
+			Bicubic(in, out, p.find("paramB")->second, p.find("paramC")->second);
+		} },
+		{ "Lanczos", true, { { "ARStrength", 0.5f } }, [](const CpuImage& in, CpuImage& out, const Params& p) {
+			Lanczos(in, out, p.find("ARStrength")->second);
+		} },
+		{ "Jinc", true, { { "windowSinc", 0.5f }, { "sinc", 0.825f }, { "ARStrength", 0.5f } }, [](const CpuImage& in, CpuImage& out, const Params& p) {
+			Jinc(in, out, p.find("windowSinc")->second, p.find("sinc")->second, p.find("ARStrength")->second);
+		} },
+		{ "SharpBilinear", true, {}, [](const CpuImage& in, CpuImage& out, const Params&) {
+			SharpBilinear(in, out);
+		} },
+		{ "FSR_EASU", true, {}, [](const CpuImage& in, CpuImage& out, const Params&) {
+			FsrEasu(in, out);
+		} },
+		{ "FSR_RCAS", false, { { "sharpness", 0.87f } }, [](const CpuImage& in, CpuImage& out, const Params& p) {
+			FsrRcas(in, out, p.find("sharpness")->second);
+		} },
+		{ "CAS", false, { { "sharpness", 0.4f } }, [](const CpuImage& in, CpuImage& out, const Params& p) {
+			Cas(in, out, p.find("sharpness")->second);
+		} },
+	};
+	return effects;
+}
+
+static const EffectInfo* FindEffect(std::string_view name) {
+	for (const EffectInfo& effect : Effects()) {
+		if (effect.name == name) {
+			return &effect;
+		}
+	}
+	return nullptr;
+}
+
+static void PrintUsage() {
+	std::cout << "用法:\n"
+		"  CpuEffects run <效果> <输入 (.ppm/.mpfr/pattern:宽x高)> <输出.ppm> [--scale 2] [--param 名称=值]...\n"
+		"  CpuEffects bench <效果> [输入] [--size 1920x1080] [--scale 2] [--threads N] [--iterations 10] [--param 名称=值]...\n"
+		"  CpuEffects check <效果> <输入> <参考输出.ppm> [--scale 2] [--param 名称=值]... [--min-psnr 40] [--max-error 255]\n"
+		"  CpuEffects diff <图像1> <图像2> [--min-psnr 40] [--max-error 255]\n"
+		"\n"
+		"效果:";
+	for (const EffectInfo& effect : Effects()) {
+		std::cout << "\n  " << effect.name;
+		for (const auto& [name, value] : effect.params) {
+			std::cout << " " << name << "=" << value;
+		}
+	}
+	std::cout << std::endl;
+}
+
+struct Options {
+	const EffectInfo* effect = nullptr;
+	std::vector<std::string_view> paths;
+	float scale = 2.0f;
+	uint32_t width = 1920;
+	uint32_t height = 1080;
+	uint32_t threadCount = 0;
+	uint32_t iterations = 10;
+	// 比较图像时 PSNR 低于此值或最大误差超过此值视为不同
+	double minPsnr = 40.0;
+	uint32_t maxError = 255;
+	std::map<std::string, float, std::less<>> params;
+};
+
+static bool ParseOptions(int argc, char* argv[], bool hasEffect, Options& options) {
+	int i = 2;
+	if (hasEffect) {
+		if (argc < 3) {
+			return false;
+		}
+
+		options.effect = FindEffect(argv[2]);
+		if (!options.effect) {
+			std::cout << "未知的效果: " << argv[2] << std::endl;
+			return false;
+		}
+
+		for (const auto& [name, value] : options.effect->params) {
+			options.params.emplace(name, value);
+		}
+
+		++i;
+	}
+
+	for (; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--scale" && i + 1 < argc) {
+			options.scale = std::stof(argv[++i]);
+		} else if (arg == "--size" && i + 1 < argc) {
+			if (std::sscanf(argv[++i], "%ux%u", &options.width, &options.height) != 2) {
+				return false;
+			}
+		} else if (arg == "--threads" && i + 1 < argc) {
+			options.threadCount = (uint32_t)std::stoul(argv[++i]);
+		} else if (arg == "--iterations" && i + 1 < argc) {
+			options.iterations = std::max((uint32_t)std::stoul(argv[++i]), 1u);
+		} else if (arg == "--min-psnr" && i + 1 < argc) {
+			options.minPsnr = std::stod(argv[++i]);
+		} else if (arg == "--max-error" && i + 1 < argc) {
+			options.maxError = (uint32_t)std::stoul(argv[++i]);
+		} else if (arg == "--param" && i + 1 < argc) {
+			std::string_view param = argv[++i];
+			const size_t pos = param.find('=');
+			if (pos == std::string_view::npos) {
+				return false;
+			}
+
+			auto it = options.params.find(param.substr(0, pos));
+			if (it == options.params.end()) {
+				std::cout << "未知的参数: " << param.substr(0, pos) << std::endl;
+				return false;
+			}
+			it->second = std::stof(std::string(param.substr(pos + 1)));
+		} else {
+			options.paths.push_back(arg);
+		}
+	}
+
+	return options.scale > 0.0f && options.width > 0 && options.height > 0;
+}
+
+// path 为 pattern:宽x高 时生成测试图案，否则读取文件
+static bool LoadInput(std::string_view path, CpuImage& image) {
+	constexpr std::string_view PATTERN_PREFIX = "pattern:";
+	if (!path.starts_with(PATTERN_PREFIX)) {
+		return image.Load(path);
+	}
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	if (std::sscanf(std::string(path.substr(PATTERN_PREFIX.size())).c_str(), "%ux%u", &width, &height) != 2 ||
+		width == 0 || height == 0) {
+		return false;
+	}
+
+	image = CpuImage::TestPattern(width, height);
+	return true;
+}
+
+static CpuImage CreateOutput(const Options& options, const CpuImage& input) {
+	if (!options.effect->isScaler) {
+		return CpuImage(input.Width(), input.Height());
+	}
+
+	return CpuImage(
+		std::max((uint32_t)std::lround(input.Width() * options.scale), 1u),
+		std::max((uint32_t)std::lround(input.Height() * options.scale), 1u)
+	);
+}
+
+static int Run(const Options& options) {
+	if (options.paths.size() != 2) {
+		PrintUsage();
+		return 2;
+	}
+
+	CpuImage input;
+	if (!LoadInput(options.paths[0], input)) {
+		std::cout << "读取 " << options.paths[0] << " 失败" << std::endl;
+		return 1;
+	}
+
+	CpuImage output = CreateOutput(options, input);
+	options.effect->run(input, output, options.params);
+
+	if (!output.Save(options.paths[1])) {
+		std::cout << "保存 " << options.paths[1] << " 失败" << std::endl;
+		return 1;
+	}
+
+	std::printf("%ux%u -> %ux%u\n", input.Width(), input.Height(), output.Width(), output.Height());
+	return 0;
+}
+
+static int Bench(const Options& options) {
+	CpuImage input;
+	if (options.paths.empty()) {
+		input = CpuImage::TestPattern(options.width, options.height);
+	} else if (!LoadInput(options.paths[0], input)) {
+		std::cout << "读取 " << options.paths[0] << " 失败" << std::endl;
+		return 1;
+	}
+
+	CpuImage output = CreateOutput(options, input);
+
+	// 预热一次，排除首次分配内存和创建线程的开销
+	options.effect->run(input, output, options.params);
+
+	std::vector<double> times;
+	times.reserve(options.iterations);
+	for (uint32_t i = 0; i < options.iterations; ++i) {
+		const auto start = std::chrono::steady_clock::now();
+		options.effect->run(input, output, options.params);
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	std::sort(times.begin(), times.end());
+	const double median = times[times.size() / 2];
+	const double pixelCount = double(output.Width()) * output.Height();
+
+	std::printf("%.*s %ux%u -> %ux%u, %s\n", (int)options.effect->name.size(), options.effect->name.data(),
+		input.Width(), input.Height(), output.Width(), output.Height(),
+		CPU_EFFECTS_FMA ? "SSE+FMA" : CPU_EFFECTS_SSE ? "SSE" : "标量");
+	std::printf("中位数 %.3f ms, 最快 %.3f ms, %.2f MPix/s\n", median, times.front(), pixelCount / median / 1000.0);
+	return 0;
+}
+
+// 返回 0 表示在允许的误差内，1 表示超出
+static int CompareImages(const CpuImage& image, const CpuImage& reference, const Options& options) {
+	if (image.Width() != reference.Width() || image.Height() != reference.Height()) {
+		std::printf("尺寸不同: %ux%u 和 %ux%u\n", image.Width(), image.Height(), reference.Width(), reference.Height());
+		return 1;
+	}
+
+	const ImageDiffResult diff = ImageDiffResult::Compute(image, reference);
+	const bool isSame = diff.psnr >= options.minPsnr && diff.maxError <= options.maxError;
+
+	std::printf("PSNR %.2f dB, 平均误差 %.4f, 最大误差 %u (%u, %u), 不同的像素 %llu/%llu, %s\n",
+		diff.psnr, diff.meanError, diff.maxError, diff.maxErrorX, diff.maxErrorY,
+		(unsigned long long)diff.differentPixels, (unsigned long long)image.Width() * image.Height(),
+		isSame ? "通过" : "失败");
+	return isSame ? 0 : 1;
+}
+
+static int Check(const Options& options) {
+	if (options.paths.size() != 2) {
+		PrintUsage();
+		return 2;
+	}
+
+	CpuImage input;
+	CpuImage reference;
+	if (!LoadInput(options.paths[0], input)) {
+		std::cout << "读取 " << options.paths[0] << " 失败" << std::endl;
+		return 2;
+	}
+	if (!reference.Load(options.paths[1])) {
+		std::cout << "读取 " << options.paths[1] << " 失败" << std::endl;
+		return 2;
+	}
+
+	CpuImage output = CreateOutput(options, input);
+	options.effect->run(input, output, options.params);
+	return CompareImages(output, reference, options);
+}
+
+static int Diff(const Options& options) {
+	if (options.paths.size() != 2) {
+		PrintUsage();
+		return 2;
+	}
+
+	CpuImage images[2];
+	for (int i = 0; i < 2; ++i) {
+		if (!images[i].Load(options.paths[i])) {
+			std::cout << "读取 " << options.paths[i] << " 失败" << std::endl;
+			return 2;
+		}
+	}
+
+	return CompareImages(images[0], images[1], options);
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	if (argc < 2) {
+		PrintUsage();
+		return 2;
+	}
+
+	const std::string_view command = argv[1];
+	Options options;
+	if (!ParseOptions(argc, argv, command != "diff", options)) {
+		PrintUsage();
+		return 2;
+	}
+
+	SetDefaultThreadCount(options.threadCount);
+
+	if (command == "run") {
+		return Run(options);
+	} else if (command == "bench") {
+		return Bench(options);
+	} else if (command == "check") {
+		return Check(options);
+	} else if (command == "diff") {
+		return Diff(options);
+	} else {
+		PrintUsage();
+		return 2;
+	}
+}
@@ -0,0 +1,199 @@
+#include "CpuImage.h"
+#include "FrameRecording.h"
+#include <cctype>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace Magpie::CpuEffects {
+
+static uint32_t defaultThreadCount = 0;
+
+Float4 CpuImage::SampleLinear(float u, float v) const noexcept {
+	const float x = u * _width - 0.5f;
+	const float y = v * _height - 0.5f;
+	const float x0 = std::floor(x);
+	const float y0 = std::floor(y);
+	const float fx = x - x0;
+	const float fy = y - y0;
+	const int ix = (int)x0;
+	const int iy = (int)y0;
+
+	const Float4 top = Lerp(Load(ix, iy), Load(ix + 1, iy), fx);
+	const Float4 bottom = Lerp(Load(ix, iy + 1), Load(ix + 1, iy + 1), fx);
+	return Lerp(top, bottom, fy);
+}
+
+// PPM 头部的字段由空白分隔，# 开始注释
+static bool ReadPpmField(std::istream& is, uint32_t& value) {
+	while (true) {
+		const int c = is.peek();
+		if (c == '#') {
+			std::string comment;
+			std::getline(is, comment);
+		} else if (std::isspace(c)) {
+			is.get();
+		} else {
+			break;
+		}
+	}
+
+	return (bool)(is >> value);
+}
+
+bool CpuImage::Load(const std::filesystem::path& path) {
+	if (path.extension() == ".mpfr") {
+		FrameRecordingReader reader;
+		if (!reader.Open(path) || reader.FrameCount() == 0) {
+			return false;
+		}
+
+		std::vector<uint8_t> data(FrameRecording::FrameDataSize(reader.Width(), reader.Height()));
+		uint64_t timestamp;
+		if (!reader.ReadFrame(0, timestamp, data)) {
+			return false;
+		}
+
+		*this = CpuImage(reader.Width(), reader.Height());
+		const bool isBGRA = reader.Format() == FrameRecordingFormat::BGRA8;
+		for (size_t i = 0; i < data.size(); i += 4) {
+			_pixels[i] = data[i + (isBGRA ? 2 : 0)] / 255.0f;
+			_pixels[i + 1] = data[i + 1] / 255.0f;
+			_pixels[i + 2] = data[i + (isBGRA ? 0 : 2)] / 255.0f;
+			_pixels[i + 3] = data[i + 3] / 255.0f;
+		}
+		return true;
+	}
+
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs) {
+		return false;
+	}
+
+	char magic[2];
+	if (!ifs.read(magic, 2) || magic[0] != 'P' || magic[1] != '6') {
+		return false;
+	}
+
+	uint32_t width, height, maxValue;
+	if (!ReadPpmField(ifs, width) || !ReadPpmField(ifs, height) || !ReadPpmField(ifs, maxValue)) {
+		return false;
+	}
+	if (width == 0 || height == 0 || maxValue != 255) {
+		return false;
+	}
+	// 头部和数据之间只有一个空白字符
+	ifs.get();
+
+	std::vector<uint8_t> data(size_t(width) * height * 3);
+	if (!ifs.read((char*)data.data(), data.size())) {
+		return false;
+	}
+
+	*this = CpuImage(width, height);
+	for (size_t i = 0, j = 0; i < data.size(); i += 3, j += 4) {
+		_pixels[j] = data[i] / 255.0f;
+		_pixels[j + 1] = data[i + 1] / 255.0f;
+		_pixels[j + 2] = data[i + 2] / 255.0f;
+		_pixels[j + 3] = 1.0f;
+	}
+	return true;
+}
+
+bool CpuImage::Save(const std::filesystem::path& path) const {
+	std::ofstream ofs(path, std::ios::binary);
+	if (!ofs) {
+		return false;
+	}
+
+	ofs << "P6\n" << _width << " " << _height << "\n255\n";
+
+	std::vector<uint8_t> data(size_t(_width) * _height * 3);
+	for (size_t i = 0, j = 0; i < data.size(); i += 3, j += 4) {
+		for (size_t k = 0; k < 3; ++k) {
+			data[i + k] = (uint8_t)std::lround(std::clamp(_pixels[j + k], 0.0f, 1.0f) * 255.0f);
+		}
+	}
+
+	ofs.write((const char*)data.data(), data.size());
+	return (bool)ofs;
+}
+
+CpuImage CpuImage::TestPattern(uint32_t width, uint32_t height) {
+	CpuImage image(width, height);
+
+	// 线性同余生成器，保证在所有平台上结果相同
+	uint32_t state = 12345;
+	auto next = [&]() {
+		state = state * 1664525u + 1013904223u;
+		return (state >> 8) / float(1 << 24);
+	};
+
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			Float4 color;
+			const uint32_t region = (x * 4 / width) + (y * 2 / height) * 4;
+			switch (region % 4) {
+			case 0:
+				// 渐变
+				color = Float4(float(x) / width, float(y) / height, 1.0f - float(x) / width, 1.0f);
+				break;
+			case 1:
+			{
+				// 8x8 的棋盘格
+				const float c = ((x / 8 + y / 8) % 2) ? 0.9f : 0.1f;
+				color = Float4(c, c, c, 1.0f);
+				break;
+			}
+			case 2:
+			{
+				// 一像素宽的细线
+				const float c = (x % 4 == 0 || y % 5 == 0) ? 1.0f : 0.0f;
+				color = Float4(c, c * 0.5f, 0.0f, 1.0f);
+				break;
+			}
+			default:
+				color = Float4(next(), next(), next(), 1.0f);
+				break;
+			}
+
+			image.Store(x, y, color);
+		}
+	}
+
+	return image;
+}
+
+void ParallelRows(uint32_t rowCount, const std::function<void(uint32_t, uint32_t)>& fn, uint32_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = defaultThreadCount;
+	}
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	threadCount = std::min(threadCount, rowCount);
+
+	if (threadCount <= 1) {
+		fn(0, rowCount);
+		return;
+	}
+
+	// 每个线程处理一个连续的行带，相邻的行共用输入的缓存行
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (uint32_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(fn, rowCount * i / threadCount, rowCount * (i + 1) / threadCount);
+	}
+
+	fn(0, rowCount / threadCount);
+
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+void SetDefaultThreadCount(uint32_t threadCount) noexcept {
+	defaultThreadCount = threadCount;
+}
+
+}
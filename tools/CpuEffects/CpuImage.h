@@ -0,0 +1,104 @@
+#pragma once
+#include "Float4.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+namespace Magpie::CpuEffects {
+
+// RGBA 浮点图像，对应效果中的纹理。8 位图像读取后映射到 [0, 1]，和 UNORM 纹理相同
+class CpuImage {
+public:
+	CpuImage() = default;
+	CpuImage(uint32_t width, uint32_t height) : _width(width), _height(height), _pixels(size_t(width) * height * 4) {}
+
+	uint32_t Width() const noexcept {
+		return _width;
+	}
+
+	uint32_t Height() const noexcept {
+		return _height;
+	}
+
+	bool IsEmpty() const noexcept {
+		return _pixels.empty();
+	}
+
+	float* Row(uint32_t y) noexcept {
+		return _pixels.data() + size_t(y) * _width * 4;
+	}
+
+	const float* Row(uint32_t y) const noexcept {
+		return _pixels.data() + size_t(y) * _width * 4;
+	}
+
+	// 和 Texture2D.Load 相同，但坐标超出范围时按 CLAMP 寻址处理
+	Float4 Load(int x, int y) const noexcept {
+		x = std::clamp(x, 0, (int)_width - 1);
+		y = std::clamp(y, 0, (int)_height - 1);
+		return Float4::Load(_pixels.data() + (size_t(y) * _width + x) * 4);
+	}
+
+	// 和 Texture2D.Load 完全相同，坐标超出范围时返回 0
+	Float4 LoadOrZero(int x, int y) const noexcept {
+		if (x < 0 || y < 0 || x >= (int)_width || y >= (int)_height) {
+			return Float4();
+		}
+		return Float4::Load(_pixels.data() + (size_t(y) * _width + x) * 4);
+	}
+
+	void Store(uint32_t x, uint32_t y, Float4 value) noexcept {
+		value.Store(_pixels.data() + (size_t(y) * _width + x) * 4);
+	}
+
+	// POINT 采样，uv 为纹理坐标
+	Float4 SamplePoint(float u, float v) const noexcept {
+		return Load((int)std::floor(u * _width), (int)std::floor(v * _height));
+	}
+
+	// LINEAR 采样，CLAMP 寻址。GPU 的插值权重精度有限，因此结果和 GPU 有微小差异
+	Float4 SampleLinear(float u, float v) const noexcept;
+
+	// 读取 PPM (P6，8 位) 或 FrameRecorder 录制的帧录像 (.mpfr，读取第一帧)
+	bool Load(const std::filesystem::path& path);
+
+	// 保存为 PPM (P6，8 位)，和写入 UNORM 纹理一样舍入，忽略 alpha 通道
+	bool Save(const std::filesystem::path& path) const;
+
+	// 生成确定的测试图案: 渐变、棋盘格、细线和伪随机噪声，覆盖平滑区域和高频细节
+	static CpuImage TestPattern(uint32_t width, uint32_t height);
+
+private:
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+	std::vector<float> _pixels;
+};
+
+// 将 [0, rowCount) 划分为连续的行带并行处理，fn 的参数为 [rowBegin, rowEnd)。
+// threadCount 为 0 时使用所有逻辑核心
+void ParallelRows(uint32_t rowCount, const std::function<void(uint32_t, uint32_t)>& fn, uint32_t threadCount = 0);
+
+// 设置 ParallelRows 默认使用的线程数，0 表示使用所有逻辑核心
+void SetDefaultThreadCount(uint32_t threadCount) noexcept;
+
+// 对输出的每个像素调用 fn(x, y, u, v)，u 和 v 是像素中心的纹理坐标，同 PS 风格的通道中的 pos
+template <typename Fn>
+void ForEachOutputPixel(CpuImage& output, const Fn& fn) {
+	const uint32_t width = output.Width();
+	const uint32_t height = output.Height();
+	const float outputPtX = 1.0f / width;
+	const float outputPtY = 1.0f / height;
+
+	ParallelRows(height, [&](uint32_t rowBegin, uint32_t rowEnd) {
+		for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+			float* row = output.Row(y);
+			const float v = (y + 0.5f) * outputPtY;
+			for (uint32_t x = 0; x < width; ++x) {
+				fn(x, y, (x + 0.5f) * outputPtX, v).Store(row + x * 4);
+			}
+		}
+	});
+}
+
+}
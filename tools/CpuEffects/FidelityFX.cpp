@@ -0,0 +1,193 @@
+#include "FidelityFX.h"
+
+namespace Magpie::CpuEffects {
+
+// 两倍亮度的近似值，同着色器
+static float Luma2(Float4 c) noexcept {
+	return c[2] * 0.5f + (c[0] * 0.5f + c[1]);
+}
+
+static float Max3(Float4 c) noexcept {
+	return std::fmax(c[0], std::fmax(c[1], c[2]));
+}
+
+// 累积方向和长度，w 为双线性插值的权重
+//    a
+//  b c d
+//    e
+static void FsrEasuSet(float& dirX, float& dirY, float& len, float w,
+	float lA, float lB, float lC, float lD, float lE) noexcept {
+	const float dc = lD - lC;
+	const float cb = lC - lB;
+	float lenX = 1.0f / std::fmax(std::abs(dc), std::abs(cb));
+	const float dX = lD - lB;
+	dirX += dX * w;
+	lenX = Saturate(std::abs(dX) * lenX);
+	len += lenX * lenX * w;
+
+	const float ec = lE - lC;
+	const float ca = lC - lA;
+	float lenY = 1.0f / std::fmax(std::abs(ec), std::abs(ca));
+	const float dY = lE - lA;
+	dirY += dY * w;
+	lenY = Saturate(std::abs(dY) * lenY);
+	len += lenY * lenY * w;
+}
+
+void FsrEasu(const CpuImage& input, CpuImage& output) {
+	const float scaleX = (float)input.Width() / output.Width();
+	const float scaleY = (float)input.Height() / output.Height();
+
+	// 12 个采样点相对于 f 的偏移
+	//    b c
+	//  e f g h
+	//  i j k l
+	//    n o
+	alignas(16) static constexpr float OFFSETS_X[12] = { 0, 1, -1, 0, 1, 2, -1, 0, 1, 2, 0, 1 };
+	alignas(16) static constexpr float OFFSETS_Y[12] = { -1, -1, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2 };
+
+	ForEachOutputPixel(output, [&](uint32_t x, uint32_t y, float, float) {
+		float ppX = x * scaleX + (0.5f * scaleX - 0.5f);
+		float ppY = y * scaleY + (0.5f * scaleY - 0.5f);
+		const float fpX = std::floor(ppX);
+		const float fpY = std::floor(ppY);
+		ppX -= fpX;
+		ppY -= fpY;
+
+		Float4 taps[12];
+		float lumas[12];
+		for (int i = 0; i < 12; ++i) {
+			taps[i] = input.Load((int)(fpX + OFFSETS_X[i]), (int)(fpY + OFFSETS_Y[i]));
+			lumas[i] = Luma2(taps[i]);
+		}
+
+		const float bL = lumas[0], cL = lumas[1], eL = lumas[2], fL = lumas[3], gL = lumas[4], hL = lumas[5];
+		const float iL = lumas[6], jL = lumas[7], kL = lumas[8], lL = lumas[9], nL = lumas[10], oL = lumas[11];
+
+		float dirX = 0.0f;
+		float dirY = 0.0f;
+		float len = 0.0f;
+		FsrEasuSet(dirX, dirY, len, (1.0f - ppX) * (1.0f - ppY), bL, eL, fL, gL, jL);
+		FsrEasuSet(dirX, dirY, len, ppX * (1.0f - ppY), cL, fL, gL, hL, kL);
+		FsrEasuSet(dirX, dirY, len, (1.0f - ppX) * ppY, fL, iL, jL, kL, nL);
+		FsrEasuSet(dirX, dirY, len, ppX * ppY, gL, jL, kL, lL, oL);
+
+		// 归一化方向，接近 0 时使用水平方向
+		float dirR = dirX * dirX + dirY * dirY;
+		const bool zro = dirR < 1.0f / 32768.0f;
+		dirR = zro ? 1.0f : 1.0f / std::sqrt(dirR);
+		dirX = zro ? 1.0f : dirX;
+		dirX *= dirR;
+		dirY *= dirR;
+
+		len = len * 0.5f;
+		len *= len;
+		const float stretch = (dirX * dirX + dirY * dirY) / std::fmax(std::abs(dirX), std::abs(dirY));
+		const float len2X = 1.0f + (stretch - 1.0f) * len;
+		const float len2Y = 1.0f - 0.5f * len;
+		const float lob = 0.5f + ((1.0f / 4.0f - 0.04f) - 0.5f) * len;
+		const float clp = 1.0f / lob;
+
+		// 每次计算四个采样点的权重
+		Float4 aC;
+		float aW = 0.0f;
+		for (int i = 0; i < 12; i += 4) {
+			const Float4 offX = Float4::Load(OFFSETS_X + i) - Float4(ppX);
+			const Float4 offY = Float4::Load(OFFSETS_Y + i) - Float4(ppY);
+			const Float4 vX = MulAdd(offX, dirX, offY * dirY) * len2X;
+			const Float4 vY = MulAdd(offX, -dirY, offY * dirX) * len2Y;
+			const Float4 d2 = Min(MulAdd(vX, vX, vY * vY), Float4(clp));
+
+			Float4 wB = MulAdd(d2, 2.0f / 5.0f, Float4(-1.0f));
+			Float4 wA = MulAdd(d2, lob, Float4(-1.0f));
+			wB *= wB;
+			wA *= wA;
+			wB = MulAdd(wB, 25.0f / 16.0f, Float4(-(25.0f / 16.0f - 1.0f)));
+			const Float4 w = wB * wA;
+
+			for (int j = 0; j < 4; ++j) {
+				aC = MulAdd(taps[i + j], w[j], aC);
+			}
+			aW += w[0] + w[1] + w[2] + w[3];
+		}
+
+		// 限制在最近的四个像素的范围内以消除振铃
+		const Float4 min4 = Min(Min(taps[3], taps[4]), Min(taps[7], taps[8]));
+		const Float4 max4 = Max(Max(taps[3], taps[4]), Max(taps[7], taps[8]));
+		return WithW(Min(max4, Max(min4, aC * (1.0f / aW))), 1.0f);
+	});
+}
+
+void FsrRcas(const CpuImage& input, CpuImage& output, float sharpness) {
+	// 超过此值锐化的结果将不自然
+	static constexpr float FSR_RCAS_LIMIT = 0.25f - (1.0f / 16.0f);
+
+	ForEachOutputPixel(output, [&](uint32_t x, uint32_t y, float, float) {
+		//    b
+		//  d e f
+		//    h
+		// 着色器使用 Load，边缘外的像素为 0
+		const Float4 b = input.LoadOrZero(x, y - 1);
+		const Float4 d = input.LoadOrZero(x - 1, y);
+		const Float4 e = input.LoadOrZero(x, y);
+		const Float4 f = input.LoadOrZero(x + 1, y);
+		const Float4 h = input.LoadOrZero(x, y + 1);
+
+		const float bL = Luma2(b);
+		const float dL = Luma2(d);
+		const float eL = Luma2(e);
+		const float fL = Luma2(f);
+		const float hL = Luma2(h);
+
+		// 噪声检测
+		float nz = 0.25f * bL + 0.25f * dL + 0.25f * fL + 0.25f * hL - eL;
+		const float maxL = std::fmax(std::fmax(std::fmax(bL, dL), std::fmax(eL, fL)), hL);
+		const float minL = std::fmin(std::fmin(std::fmin(bL, dL), std::fmin(eL, fL)), hL);
+		nz = Saturate(std::abs(nz) * (1.0f / (maxL - minL)));
+		nz = -0.5f * nz + 1.0f;
+
+		// 四周像素的最小值和最大值，RGB 三个通道同时计算
+		const Float4 mn4 = Min(Min(Min(b, d), f), h);
+		const Float4 mx4 = Max(Max(Max(b, d), f), h);
+		const Float4 hitMin = Min(mn4, e) * Rcp(mx4 * 4.0f);
+		const Float4 hitMax = (Float4(1.0f) - Max(mx4, e)) * Rcp(MulAdd(mn4, 4.0f, Float4(-4.0f)));
+		const Float4 lobeRGB = Max(Float4() - hitMin, hitMax);
+		float lobe = std::fmax(-FSR_RCAS_LIMIT, std::fmin(Max3(lobeRGB), 0.0f)) * sharpness;
+
+		// 降噪
+		lobe *= nz;
+
+		const float rcpL = 1.0f / (4.0f * lobe + 1.0f);
+		const Float4 c = MulAdd(b + d + h + f, lobe, e) * rcpL;
+		return WithW(c, 1.0f);
+	});
+}
+
+void Cas(const CpuImage& input, CpuImage& output, float sharpness) {
+	const float peak = -1.0f / (8.0f + (5.0f - 8.0f) * sharpness);
+
+	ForEachOutputPixel(output, [&](uint32_t x, uint32_t y, float, float) {
+		//    b
+		//  d e f
+		//    h
+		// 着色器使用 Gather，因此按 CLAMP 寻址
+		const Float4 b = input.Load(x, y - 1);
+		const Float4 d = input.Load(x - 1, y);
+		const Float4 e = input.Load(x, y);
+		const Float4 f = input.Load(x + 1, y);
+		const Float4 h = input.Load(x, y + 1);
+
+		// 着色器只使用 G 通道的权重
+		const Float4 mn = Min(Min(Min(d, e), f), Min(b, h));
+		const Float4 mx = Max(Max(Max(d, e), f), Max(b, h));
+		const float mnG = mn[1];
+		const float mxG = mx[1];
+		const float ampG = std::sqrt(Saturate(std::fmin(mnG, 1.0f - mxG) * (1.0f / mxG)));
+		const float wG = ampG * peak;
+
+		const float rcpWeight = 1.0f / (1.0f + 4.0f * wG);
+		return WithW(Saturate(MulAdd(b + d + f + h, wG, e) * rcpWeight), 1.0f);
+	});
+}
+
+}
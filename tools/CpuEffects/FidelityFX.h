@@ -0,0 +1,18 @@
+#pragma once
+#include "CpuImage.h"
+
+namespace Magpie::CpuEffects {
+
+// FidelityFX 中效果的 CPU 实现，移植自着色器的 FP32 路径。GPU 支持 FP16 时着色器使用半精度计算，
+// 因此和 GPU 的结果有舍入误差。output 应已设置为目标尺寸。
+
+// FSR/FSR_EASU.hlsl
+void FsrEasu(const CpuImage& input, CpuImage& output);
+
+// FSR/FSR_RCAS.hlsl，output 和 input 尺寸相同
+void FsrRcas(const CpuImage& input, CpuImage& output, float sharpness = 0.87f);
+
+// CAS/CAS.hlsl，output 和 input 尺寸相同
+void Cas(const CpuImage& input, CpuImage& output, float sharpness = 0.4f);
+
+}
@@ -0,0 +1,167 @@
+#pragma once
+// 对应 HLSL 的 float4，每个像素的 RGBA 占一个 128 位寄存器，没有使用 256 位的 AVX 向量。
+// 编译器启用 SSE4.1 (GCC/Clang 的 -msse4.1，MSVC 的 /arch:AVX 及以上) 时使用 SSE 指令，否则使用标量实现。
+// 启用 FMA 时 (如 -march=x86-64-v3 或 /arch:AVX2，MSVC 不定义 __FMA__) MulAdd 使用 FMA 指令，这是 AVX2
+// 编译选项带来的唯一区别。
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define CPU_EFFECTS_SSE 1
+#include <immintrin.h>
+#else
+#define CPU_EFFECTS_SSE 0
+#endif
+
+#if CPU_EFFECTS_SSE && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define CPU_EFFECTS_FMA 1
+#else
+#define CPU_EFFECTS_FMA 0
+#endif
+
+namespace Magpie::CpuEffects {
+
+#if CPU_EFFECTS_SSE
+
+struct Float4 {
+	Float4() noexcept : v(_mm_setzero_ps()) {}
+	Float4(__m128 value) noexcept : v(value) {}
+	explicit Float4(float s) noexcept : v(_mm_set1_ps(s)) {}
+	Float4(float x, float y, float z, float w) noexcept : v(_mm_setr_ps(x, y, z, w)) {}
+
+	static Float4 Load(const float* p) noexcept {
+		return _mm_loadu_ps(p);
+	}
+
+	void Store(float* p) const noexcept {
+		_mm_storeu_ps(p, v);
+	}
+
+	float operator[](int i) const noexcept {
+		alignas(16) float t[4];
+		_mm_store_ps(t, v);
+		return t[i];
+	}
+
+	Float4& operator+=(Float4 o) noexcept { v = _mm_add_ps(v, o.v); return *this; }
+	Float4& operator*=(Float4 o) noexcept { v = _mm_mul_ps(v, o.v); return *this; }
+
+	__m128 v;
+};
+
+inline Float4 operator+(Float4 a, Float4 b) noexcept { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) noexcept { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) noexcept { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, float s) noexcept { return _mm_mul_ps(a.v, _mm_set1_ps(s)); }
+inline Float4 operator/(Float4 a, Float4 b) noexcept { return _mm_div_ps(a.v, b.v); }
+// 和 HLSL 相同，一个操作数为 NaN 时返回另一个。minps/maxps 有 NaN 时返回第二个操作数，因此 b 为 NaN 时改为返回 a
+inline Float4 Min(Float4 a, Float4 b) noexcept { return _mm_blendv_ps(_mm_min_ps(a.v, b.v), a.v, _mm_cmpunord_ps(b.v, b.v)); }
+inline Float4 Max(Float4 a, Float4 b) noexcept { return _mm_blendv_ps(_mm_max_ps(a.v, b.v), a.v, _mm_cmpunord_ps(b.v, b.v)); }
+inline Float4 Floor(Float4 a) noexcept { return _mm_floor_ps(a.v); }
+inline Float4 Abs(Float4 a) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline Float4 Rcp(Float4 a) noexcept { return _mm_div_ps(_mm_set1_ps(1.0f), a.v); }
+
+// a * b + c
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) noexcept {
+#if CPU_EFFECTS_FMA
+	return _mm_fmadd_ps(a.v, b.v, c.v);
+#else
+	return _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v);
+#endif
+}
+
+inline Float4 MulAdd(Float4 a, float b, Float4 c) noexcept {
+	return MulAdd(a, Float4(b), c);
+}
+
+// 设置 w 分量
+inline Float4 WithW(Float4 a, float w) noexcept {
+	return _mm_insert_ps(a.v, _mm_set_ss(w), 0x30);
+}
+
+#else
+
+struct Float4 {
+	Float4() noexcept = default;
+	explicit Float4(float s) noexcept : x(s), y(s), z(s), w(s) {}
+	Float4(float x_, float y_, float z_, float w_) noexcept : x(x_), y(y_), z(z_), w(w_) {}
+
+	static Float4 Load(const float* p) noexcept {
+		return { p[0], p[1], p[2], p[3] };
+	}
+
+	void Store(float* p) const noexcept {
+		p[0] = x;
+		p[1] = y;
+		p[2] = z;
+		p[3] = w;
+	}
+
+	float operator[](int i) const noexcept {
+		return (&x)[i];
+	}
+
+	Float4& operator+=(Float4 o) noexcept { x += o.x; y += o.y; z += o.z; w += o.w; return *this; }
+	Float4& operator*=(Float4 o) noexcept { x *= o.x; y *= o.y; z *= o.z; w *= o.w; return *this; }
+
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 0.0f;
+};
+
+template <typename Fn>
+inline Float4 Map(Float4 a, Float4 b, Fn fn) noexcept {
+	return { fn(a.x, b.x), fn(a.y, b.y), fn(a.z, b.z), fn(a.w, b.w) };
+}
+
+inline Float4 operator+(Float4 a, Float4 b) noexcept { return Map(a, b, [](float l, float r) { return l + r; }); }
+inline Float4 operator-(Float4 a, Float4 b) noexcept { return Map(a, b, [](float l, float r) { return l - r; }); }
+inline Float4 operator*(Float4 a, Float4 b) noexcept { return Map(a, b, [](float l, float r) { return l * r; }); }
+inline Float4 operator*(Float4 a, float s) noexcept { return a * Float4(s); }
+inline Float4 operator/(Float4 a, Float4 b) noexcept { return Map(a, b, [](float l, float r) { return l / r; }); }
+inline Float4 Min(Float4 a, Float4 b) noexcept { return Map(a, b, [](float l, float r) { return std::fmin(l, r); }); }
+inline Float4 Max(Float4 a, Float4 b) noexcept { return Map(a, b, [](float l, float r) { return std::fmax(l, r); }); }
+inline Float4 Floor(Float4 a) noexcept { return { std::floor(a.x), std::floor(a.y), std::floor(a.z), std::floor(a.w) }; }
+inline Float4 Abs(Float4 a) noexcept { return { std::abs(a.x), std::abs(a.y), std::abs(a.z), std::abs(a.w) }; }
+inline Float4 Rcp(Float4 a) noexcept { return Float4(1.0f) / a; }
+
+inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) noexcept {
+	return a * b + c;
+}
+
+inline Float4 MulAdd(Float4 a, float b, Float4 c) noexcept {
+	return a * b + c;
+}
+
+inline Float4 WithW(Float4 a, float w) noexcept {
+	a.w = w;
+	return a;
+}
+
+#endif
+
+inline Float4 Clamp(Float4 a, Float4 lo, Float4 hi) noexcept {
+	return Min(Max(a, lo), hi);
+}
+
+// 和 HLSL 的 lerp 相同
+inline Float4 Lerp(Float4 a, Float4 b, float t) noexcept {
+	return MulAdd(b - a, t, a);
+}
+
+// 和 HLSL 相同，NaN 返回 0
+inline Float4 Saturate(Float4 a) noexcept {
+	return Clamp(a, Float4(0.0f), Float4(1.0f));
+}
+
+inline float Saturate(float a) noexcept {
+	return std::fmin(std::fmax(a, 0.0f), 1.0f);
+}
+
+inline float Sum3(Float4 a) noexcept {
+	return a[0] + a[1] + a[2];
+}
+
+}
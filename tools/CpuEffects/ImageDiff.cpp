@@ -0,0 +1,51 @@
+#include "ImageDiff.h"
+#include <limits>
+
+namespace Magpie::CpuEffects {
+
+ImageDiffResult ImageDiffResult::Compute(const CpuImage& a, const CpuImage& b) {
+	ImageDiffResult result;
+
+	// 先量化为 8 位，和保存为 PPM 或写入 UNORM 纹理的结果一致
+	auto quantize = [](float value) {
+		return (int)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+	};
+
+	uint64_t squaredErrorSum = 0;
+	uint64_t errorSum = 0;
+	for (uint32_t y = 0; y < a.Height(); ++y) {
+		const float* rowA = a.Row(y);
+		const float* rowB = b.Row(y);
+		for (uint32_t x = 0; x < a.Width(); ++x) {
+			bool isDifferent = false;
+			for (uint32_t c = 0; c < 3; ++c) {
+				const uint32_t error = (uint32_t)std::abs(quantize(rowA[x * 4 + c]) - quantize(rowB[x * 4 + c]));
+				if (error == 0) {
+					continue;
+				}
+
+				isDifferent = true;
+				errorSum += error;
+				squaredErrorSum += error * error;
+				if (error > result.maxError) {
+					result.maxError = error;
+					result.maxErrorX = x;
+					result.maxErrorY = y;
+				}
+			}
+
+			if (isDifferent) {
+				++result.differentPixels;
+			}
+		}
+	}
+
+	const double sampleCount = double(a.Width()) * a.Height() * 3;
+	result.meanError = errorSum / sampleCount;
+
+	const double mse = squaredErrorSum / sampleCount;
+	result.psnr = mse == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(255.0 * 255.0 / mse);
+	return result;
+}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "CpuImage.h"
+
+namespace Magpie::CpuEffects {
+
+// 比较两张尺寸相同的图像的 RGB 通道，误差以 8 位颜色值为单位
+struct ImageDiffResult {
+	// 峰值信噪比 (dB)，图像完全相同时为无穷大
+	double psnr = 0.0;
+	double meanError = 0.0;
+	uint32_t maxError = 0;
+	// 误差最大的像素
+	uint32_t maxErrorX = 0;
+	uint32_t maxErrorY = 0;
+	// 至少一个通道不同的像素数
+	uint64_t differentPixels = 0;
+
+	static ImageDiffResult Compute(const CpuImage& a, const CpuImage& b);
+};
+
+}
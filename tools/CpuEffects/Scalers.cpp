@@ -0,0 +1,250 @@
+#include "Scalers.h"
+#include <array>
+#include <numbers>
+
+namespace Magpie::CpuEffects {
+
+static constexpr float PI = std::numbers::pi_v<float>;
+
+void Nearest(const CpuImage& input, CpuImage& output) {
+	ForEachOutputPixel(output, [&](uint32_t, uint32_t, float u, float v) {
+		return input.SamplePoint(u, v);
+	});
+}
+
+void Bilinear(const CpuImage& input, CpuImage& output) {
+	ForEachOutputPixel(output, [&](uint32_t, uint32_t, float u, float v) {
+		return input.SampleLinear(u, v);
+	});
+}
+
+static float BicubicWeight(float x, float b, float c) noexcept {
+	const float ax = std::abs(x);
+
+	if (ax < 1.0f) {
+		return (x * x * ((12.0f - 9.0f * b - 6.0f * c) * ax + (-18.0f + 12.0f * b + 6.0f * c)) + (6.0f - 2.0f * b)) / 6.0f;
+	} else if (ax < 2.0f) {
+		return (x * x * ((-b - 6.0f * c) * ax + (6.0f * b + 30.0f * c)) + (-12.0f * b - 48.0f * c) * ax + (8.0f * b + 24.0f * c)) / 6.0f;
+	} else {
+		return 0.0f;
+	}
+}
+
+// 返回归一化的四个权重
+static void BicubicWeight4(float x, float b, float c, float (&taps)[4]) noexcept {
+	taps[0] = BicubicWeight(x - 2.0f, b, c);
+	taps[1] = BicubicWeight(x - 1.0f, b, c);
+	taps[2] = BicubicWeight(x, b, c);
+	taps[3] = BicubicWeight(x + 1.0f, b, c);
+
+	const float sum = taps[0] + taps[1] + taps[2] + taps[3];
+	for (float& tap : taps) {
+		tap /= sum;
+	}
+}
+
+void Bicubic(const CpuImage& input, CpuImage& output, float paramB, float paramC) {
+	const float inputWidth = (float)input.Width();
+	const float inputHeight = (float)input.Height();
+	const float inputPtX = 1.0f / inputWidth;
+	const float inputPtY = 1.0f / inputHeight;
+
+	// 和着色器相同，中间两个采样点合并为一次双线性采样，四角使用 Load
+	ForEachOutputPixel(output, [&](uint32_t, uint32_t, float u, float v) {
+		const float posX = u * inputWidth;
+		const float posY = v * inputHeight;
+		const float pos1X = std::floor(posX - 0.5f) + 0.5f;
+		const float pos1Y = std::floor(posY - 0.5f) + 0.5f;
+
+		float rowTaps[4];
+		float colTaps[4];
+		BicubicWeight4(1.0f - (posX - pos1X), paramB, paramC, rowTaps);
+		BicubicWeight4(1.0f - (posY - pos1Y), paramB, paramC, colTaps);
+
+		const float uv1X = pos1X * inputPtX;
+		const float uv1Y = pos1Y * inputPtY;
+		const float uv0X = uv1X - inputPtX;
+		const float uv0Y = uv1Y - inputPtY;
+		const float uv3X = uv1X + 2 * inputPtX;
+		const float uv3Y = uv1Y + 2 * inputPtY;
+
+		const float uWeightSum = rowTaps[1] + rowTaps[2];
+		const float uMiddle = uv1X + rowTaps[2] * inputPtX / uWeightSum;
+		const float vWeightSum = colTaps[1] + colTaps[2];
+		const float vMiddle = uv1Y + colTaps[2] * inputPtY / vWeightSum;
+
+		const int left = (int)std::max(uv0X * inputWidth, 0.5f);
+		const int top = (int)std::max(uv0Y * inputHeight, 0.5f);
+		const int right = (int)std::min(uv3X * inputWidth, inputWidth - 0.5f);
+		const int bottom = (int)std::min(uv3Y * inputHeight, inputHeight - 0.5f);
+
+		Float4 topRow = input.Load(left, top) * rowTaps[0];
+		topRow = MulAdd(input.SampleLinear(uMiddle, uv0Y), uWeightSum, topRow);
+		topRow = MulAdd(input.Load(right, top), rowTaps[3], topRow);
+		Float4 total = topRow * colTaps[0];
+
+		Float4 middleRow = input.SampleLinear(uv0X, vMiddle) * rowTaps[0];
+		middleRow = MulAdd(input.SampleLinear(uMiddle, vMiddle), uWeightSum, middleRow);
+		middleRow = MulAdd(input.SampleLinear(uv3X, vMiddle), rowTaps[3], middleRow);
+		total = MulAdd(middleRow, vWeightSum, total);
+
+		Float4 bottomRow = input.Load(left, bottom) * rowTaps[0];
+		bottomRow = MulAdd(input.SampleLinear(uMiddle, uv3Y), uWeightSum, bottomRow);
+		bottomRow = MulAdd(input.Load(right, bottom), rowTaps[3], bottomRow);
+		total = MulAdd(bottomRow, colTaps[3], total);
+
+		return WithW(total, 1.0f);
+	});
+}
+
+// Lanczos3，返回 x-1.5、x-0.5、x+0.5 处的权重
+static void LanczosWeight3(float x, float (&taps)[3]) noexcept {
+	const float offsets[3] = { -1.5f, -0.5f, 0.5f };
+	for (int i = 0; i < 3; ++i) {
+		const float s = std::max(std::abs(2.0f * PI * (x + offsets[i])), 1e-5f);
+		taps[i] = std::sin(s) * std::sin(s * (1.0f / 3.0f)) / (s * s);
+	}
+}
+
+// 6 个采样点的权重，归一化后按采样点的顺序排列
+static void LanczosWeight6(float f, std::array<float, 6>& taps) noexcept {
+	float taps1[3];
+	float taps2[3];
+	LanczosWeight3(0.5f - f * 0.5f, taps1);
+	LanczosWeight3(1.0f - f * 0.5f, taps2);
+
+	float sum = 0.0f;
+	for (int i = 0; i < 3; ++i) {
+		taps[i * 2] = taps1[i];
+		taps[i * 2 + 1] = taps2[i];
+		sum += taps1[i] + taps2[i];
+	}
+
+	for (float& tap : taps) {
+		tap /= sum;
+	}
+}
+
+// 权重是可分离的，只和输出像素的列或行有关，因此预先为每列和每行计算一次，返回每个像素的采样窗口起点
+static std::vector<int> LanczosTaps(uint32_t inputSize, uint32_t outputSize, std::vector<std::array<float, 6>>& taps) {
+	std::vector<int> starts(outputSize);
+	taps.resize(outputSize);
+
+	for (uint32_t i = 0; i < outputSize; ++i) {
+		const float pos = (i + 0.5f) * (1.0f / outputSize) * inputSize;
+		const float f = pos + 0.5f - std::floor(pos + 0.5f);
+		LanczosWeight6(f, taps[i]);
+		// 6x6 的采样窗口，起点 +2 处是离采样点最近的 2x2 纹素中左上角的那个
+		starts[i] = (int)std::floor(pos + 0.5f) - 3;
+	}
+
+	return starts;
+}
+
+void Lanczos(const CpuImage& input, CpuImage& output, float arStrength) {
+	std::vector<std::array<float, 6>> lineTaps;
+	std::vector<std::array<float, 6>> columnTaps;
+	const std::vector<int> lefts = LanczosTaps(input.Width(), output.Width(), lineTaps);
+	const std::vector<int> tops = LanczosTaps(input.Height(), output.Height(), columnTaps);
+
+	ForEachOutputPixel(output, [&](uint32_t x, uint32_t y, float, float) {
+		const int left = lefts[x];
+		const int top = tops[y];
+
+		Float4 color;
+		for (int j = 0; j < 6; ++j) {
+			Float4 line;
+			for (int i = 0; i < 6; ++i) {
+				line = MulAdd(input.Load(left + i, top + j), lineTaps[x][i], line);
+			}
+			color = MulAdd(line, columnTaps[y][j], color);
+		}
+
+		// 抗振铃
+		const Float4 s22 = input.Load(left + 2, top + 2);
+		const Float4 s32 = input.Load(left + 3, top + 2);
+		const Float4 s23 = input.Load(left + 2, top + 3);
+		const Float4 s33 = input.Load(left + 3, top + 3);
+		const Float4 minSample = Min(Min(s22, s32), Min(s23, s33));
+		const Float4 maxSample = Max(Max(s22, s32), Max(s23, s33));
+		color = Lerp(color, Clamp(color, minSample, maxSample), arStrength);
+
+		return WithW(color, 1.0f);
+	});
+}
+
+void Jinc(const CpuImage& input, CpuImage& output, float windowSinc, float sinc, float arStrength) {
+	const float scaleX = (float)input.Width() / output.Width();
+	const float scaleY = (float)input.Height() / output.Height();
+	const float wa = windowSinc * PI;
+	const float wb = sinc * PI;
+
+	auto resampler = [&](float x) {
+		return x == 0.0f ? wa * wb : std::sin(x * wa) * std::sin(x * wb) / (x * x);
+	};
+
+	ForEachOutputPixel(output, [&](uint32_t x, uint32_t y, float, float) {
+		const float pcX = (x + 0.5f) * scaleX;
+		const float pcY = (y + 0.5f) * scaleY;
+		const float left = std::floor(pcX - 0.5f) - 1.0f;
+		const float top = std::floor(pcY - 0.5f) - 1.0f;
+
+		// 4x4 的采样窗口，src[i][j] 中 i 为列，j 为行
+		Float4 src[4][4];
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				src[i][j] = input.Load((int)left + i, (int)top + j);
+			}
+		}
+
+		Float4 color;
+		float weightSum = 0.0f;
+		for (int r = 0; r < 4; ++r) {
+			for (int k = 0; k < 4; ++k) {
+				const float dx = left + k + 0.5f - pcX;
+				const float dy = top + r + 0.5f - pcY;
+				const float weight = resampler(std::sqrt(dx * dx + dy * dy));
+				weightSum += weight;
+
+				// 着色器中最后一行的第二个采样点误用了 src[2][3]，这里保持一致以便和 GPU 的结果比较
+				const int col = (r == 3 && k == 1) ? 2 : k;
+				color = MulAdd(src[col][r], weight, color);
+			}
+		}
+		color = color * (1.0f / weightSum);
+
+		// 抗振铃
+		const Float4 minSample = Min(Min(src[1][1], src[2][1]), Min(src[1][2], src[2][2]));
+		const Float4 maxSample = Max(Max(src[1][1], src[2][1]), Max(src[1][2], src[2][2]));
+		color = Lerp(color, Clamp(color, minSample, maxSample), arStrength);
+
+		return WithW(color, 1.0f);
+	});
+}
+
+void SharpBilinear(const CpuImage& input, CpuImage& output) {
+	const float inputWidth = (float)input.Width();
+	const float inputHeight = (float)input.Height();
+	const float scaleX = output.Width() / inputWidth;
+	const float scaleY = output.Height() / inputHeight;
+	const float regionRangeX = 0.5f - 0.5f / scaleX;
+	const float regionRangeY = 0.5f - 0.5f / scaleY;
+
+	// 在纹素中心附近区域内采样点固定在中心，只在边缘处插值，相当于先整数倍放大再双线性缩放
+	auto modTexel = [](float texel, float regionRange, float scale) {
+		const float texelFloored = std::floor(texel);
+		const float centerDist = texel - texelFloored - 0.5f;
+		// 缩小时 regionRange 为负，不能使用 std::clamp
+		const float f = (centerDist - std::min(std::max(centerDist, -regionRange), regionRange)) * scale + 0.5f;
+		return texelFloored + f;
+	};
+
+	ForEachOutputPixel(output, [&](uint32_t, uint32_t, float u, float v) {
+		return input.SampleLinear(
+			modTexel(u * inputWidth, regionRangeX, scaleX) / inputWidth,
+			modTexel(v * inputHeight, regionRangeY, scaleY) / inputHeight
+		);
+	});
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "CpuImage.h"
+
+namespace Magpie::CpuEffects {
+
+// src/Effects 中插值算法的 CPU 实现，逐像素重现着色器中的计算，用于在没有 GPU 时验证效果的输出。
+// output 应已设置为目标尺寸。参数的含义和默认值同对应的效果。
+
+// Nearest.hlsl
+void Nearest(const CpuImage& input, CpuImage& output);
+
+// Bilinear.hlsl
+void Bilinear(const CpuImage& input, CpuImage& output);
+
+// Bicubic.hlsl
+void Bicubic(const CpuImage& input, CpuImage& output, float paramB = 0.33f, float paramC = 0.33f);
+
+// Lanczos.hlsl
+void Lanczos(const CpuImage& input, CpuImage& output, float arStrength = 0.5f);
+
+// Jinc.hlsl
+void Jinc(const CpuImage& input, CpuImage& output,
+	float windowSinc = 0.5f, float sinc = 0.825f, float arStrength = 0.5f);
+
+// Pixel Art/SharpBilinear.hlsl
+void SharpBilinear(const CpuImage& input, CpuImage& output);
+
+}
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+# 使用 references 中的参考输出检查所有效果，有效果超出允许的误差时返回 1。
+# 用法: ./run_checks.sh [CpuEffects 可执行文件，默认为 ./CpuEffects] [--update]
+# --update 使用当前的实现重新生成参考输出，只应在确认输出无误后使用。
+#
+# 输入为 64x32 的测试图案，缩放倍数为 2，FSR_RCAS 和 CAS 的输出和输入尺寸相同。参考输出由
+# -march=x86-64-v3 的版本生成，标量版本和 MSVC 的舍入方式不同，因此默认允许每个通道有不超过 2 的误差。
+
+set -u
+
+cd "$(dirname "$0")"
+
+exe=./CpuEffects
+update=0
+for arg in "$@"; do
+	if [ "$arg" = "--update" ]; then
+		update=1
+	else
+		exe=$arg
+	fi
+done
+
+if [ ! -x "$exe" ]; then
+	echo "找不到 $exe"
+	exit 2
+fi
+
+input=pattern:64x32
+thresholds=(--min-psnr 50 --max-error 2)
+
+# 每行为效果名和额外的参数，参考输出为 references/<效果名>.ppm。额外的参数在默认阈值之后，可以覆盖它们。
+# 锐化强度的微小变化只使输出改变 2 左右，而这几个效果在各种编译选项下的输出都相同，因此使用更严格的阈值
+checks=(
+	"Nearest"
+	"Bilinear"
+	"Bicubic"
+	"Lanczos"
+	"Jinc"
+	"SharpBilinear"
+	"FSR_EASU --max-error 1"
+	"FSR_RCAS --max-error 1"
+	"CAS --max-error 1"
+)
+
+failed=0
+for check in "${checks[@]}"; do
+	read -r -a args <<< "$check"
+	effect=${args[0]}
+	reference=references/$effect.ppm
+
+	if [ $update -eq 1 ]; then
+		"$exe" run "$effect" "$input" "$reference" --scale 2 "${args[@]:1}" > /dev/null || failed=1
+		echo "已更新 $reference"
+		continue
+	fi
+
+	echo -n "$effect: "
+	if ! "$exe" check "$effect" "$input" "$reference" --scale 2 "${thresholds[@]}" "${args[@]:1}"; then
+		failed=1
+	fi
+done
+
+exit $failed
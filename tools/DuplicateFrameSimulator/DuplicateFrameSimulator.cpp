@@ -0,0 +1,195 @@
+// DuplicateFrameSimulator.cpp : 重放记录的重复帧序列，比较动态检测重复帧的各个策略
+// 只使用标准库，在 Linux 上可以直接编译:
+// g++ -std=c++20 -O2 -I../../src/Magpie.Core DuplicateFrameSimulator.cpp ../../src/Magpie.Core/DuplicateFramePredictor.cpp -o DuplicateFrameSimulator
+//
+
+#include "DuplicateFramePredictor.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+using namespace Magpie;
+
+struct SimulationResult {
+	// 检查的帧数
+	size_t checkCount = 0;
+	// 检查后发现不是重复帧，白白检查
+	size_t wastedCheckCount = 0;
+	// 跳过检查的重复帧，白白渲染
+	size_t wastedRenderCount = 0;
+};
+
+static SimulationResult Simulate(DuplicateFramePredictor& predictor, const std::vector<bool>& sequence) {
+	SimulationResult result;
+
+	for (bool isDuplicate : sequence) {
+		if (predictor.ShouldCheck()) {
+			++result.checkCount;
+			if (!isDuplicate) {
+				++result.wastedCheckCount;
+			}
+			predictor.OnChecked(isDuplicate);
+		} else {
+			if (isDuplicate) {
+				++result.wastedRenderCount;
+			}
+			predictor.OnSkipped();
+		}
+	}
+
+	return result;
+}
+
+// 总是检查和从不检查作为基准
+class AlwaysCheckPredictor : public DuplicateFramePredictor {
+public:
+	bool ShouldCheck() const noexcept override { return true; }
+	void OnChecked(bool) noexcept override {}
+	void OnSkipped() noexcept override {}
+};
+
+class NeverCheckPredictor : public DuplicateFramePredictor {
+public:
+	bool ShouldCheck() const noexcept override { return false; }
+	void OnChecked(bool) noexcept override {}
+	void OnSkipped() noexcept override {}
+};
+
+static std::vector<std::string> SplitCsvLine(std::string_view line) {
+	std::vector<std::string> result;
+	std::string cur;
+	bool inQuotes = false;
+
+	for (char c : line) {
+		if (c == '"') {
+			inQuotes = !inQuotes;
+		} else if (c == ',' && !inQuotes) {
+			result.push_back(std::move(cur));
+			cur.clear();
+		} else if (c != '\r') {
+			cur.push_back(c);
+		}
+	}
+	result.push_back(std::move(cur));
+
+	return result;
+}
+
+// 支持两种格式:
+// 1. FrameTraceRecorder 记录的 frame_trace.csv，应将重复帧检测设为“总是”，否则跳过检查的帧将被忽略
+// 2. 由 0 和 1 组成的文本，1 表示重复帧，忽略其他字符
+static bool ReadSequence(const char* path, std::vector<bool>& sequence) {
+	std::ifstream ifs(path);
+	if (!ifs) {
+		return false;
+	}
+
+	std::string line;
+	if (!std::getline(ifs, line)) {
+		return true;
+	}
+
+	if (line.starts_with("frame,")) {
+		const std::vector<std::string> header = SplitCsvLine(line);
+		if (header.size() < 4 || header[3] != "duplicate") {
+			return false;
+		}
+
+		while (std::getline(ifs, line)) {
+			const std::vector<std::string> fields = SplitCsvLine(line);
+			if (fields.size() < 4) {
+				continue;
+			}
+
+			if (fields[3] == "duplicate") {
+				sequence.push_back(true);
+			} else if (fields[3] == "unique") {
+				sequence.push_back(false);
+			}
+		}
+	} else {
+		do {
+			for (char c : line) {
+				if (c == '0' || c == '1') {
+					sequence.push_back(c == '1');
+				}
+			}
+		} while (std::getline(ifs, line));
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	// 检查一帧的开销和渲染一帧的开销之比
+	float checkCost = 0.05f;
+	const char* path = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--check-cost" && i + 1 < argc) {
+			checkCost = std::stof(argv[++i]);
+		} else {
+			path = argv[i];
+		}
+	}
+
+	if (!path) {
+		std::cout << "用法: DuplicateFrameSimulator [--check-cost <检查和渲染的开销之比>] <序列文件>" << std::endl;
+		return 1;
+	}
+
+	std::vector<bool> sequence;
+	if (!ReadSequence(path, sequence)) {
+		std::cout << "读取 " << path << " 失败" << std::endl;
+		return 1;
+	}
+
+	if (sequence.empty()) {
+		std::cout << "没有记录" << std::endl;
+		return 1;
+	}
+
+	size_t duplicateCount = 0;
+	for (bool isDuplicate : sequence) {
+		duplicateCount += isDuplicate;
+	}
+	std::printf("帧数: %zu, 重复帧: %zu (%.2f%%), 检查开销: %.3f\n\n",
+		sequence.size(), duplicateCount, duplicateCount * 100.0 / sequence.size(), checkCost);
+
+	struct Policy {
+		const char* name;
+		std::unique_ptr<DuplicateFramePredictor> predictor;
+	};
+	Policy policies[] = {
+		{ "Always", std::make_unique<AlwaysCheckPredictor>() },
+		{ "Never", std::make_unique<NeverCheckPredictor>() },
+		{ "Heuristic", std::make_unique<HeuristicDuplicateFramePredictor>() },
+		{ "ExponentialBackoff", std::make_unique<ExponentialBackoffDuplicateFramePredictor>() },
+		{ "Learned", std::make_unique<LearnedDuplicateFramePredictor>() },
+	};
+
+	std::printf("%-20s %10s %12s %14s %10s\n", "策略", "检查", "无用的检查", "渲染的重复帧", "总开销");
+	for (Policy& policy : policies) {
+		const SimulationResult result = Simulate(*policy.predictor, sequence);
+		// 以渲染一帧的开销为单位
+		const double cost = result.checkCount * checkCost + result.wastedRenderCount;
+		std::printf("%-20s %10zu %12zu %14zu %10.2f\n", policy.name,
+			result.checkCount, result.wastedCheckCount, result.wastedRenderCount, cost);
+	}
+
+	return 0;
+}
@@ -0,0 +1,879 @@
+// EffectBatchCompiler.cpp : 离线编译效果文件夹中的所有效果，输出每个通道的 HLSL 和元数据，可以预先生成效果缓存
+// 只依赖标准库和 fmt，在 Linux 上可以直接编译:
+// g++ -std=c++20 -O2 -pthread -I../../src/Magpie.Core -I../../src/Magpie.Core/include EffectBatchCompiler.cpp ../../src/Magpie.Core/EffectParser.cpp ../../src/Magpie.Core/SmallVector.cpp -lfmt -o EffectBatchCompiler
+// 生成缓存和内置效果包需要 yas 和 rapidhash，此时应定义 ENABLE_EFFECT_CACHE 并编译
+// ../../src/Magpie.Core/EffectCacheSerializer.cpp 和 ../../src/Magpie.Core/EffectBundle.cpp
+//
+
+#include "EffectParser.h"
+#include "EffectShaderCompiler.h"
+#include "EffectHelper.h"
+#ifdef ENABLE_EFFECT_CACHE
+#include "EffectCacheSerializer.h"
+#include "EffectBundle.h"
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <d3dcompiler.h>
+#endif
+
+using namespace Magpie;
+
+// 后端可能在多个线程中输出编译错误
+static std::mutex consoleMutex;
+
+// Content 为 std::string 或 std::vector<uint8_t>
+template <typename Content>
+static bool ReadFile(const std::filesystem::path& path, Content& content) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+// 和 Win32Helper::ReadTextFile 相同，以文本模式读取，否则 CRLF 换行的源码得到的缓存键和 Magpie 不同
+static bool ReadTextFile(const std::filesystem::path& path, std::string& content) {
+	if (!ReadFile(path, content)) {
+		return false;
+	}
+
+	size_t j = 0;
+	for (size_t i = 0; i < content.size(); ++i) {
+		if (content[i] == '\r' && i + 1 < content.size() && content[i + 1] == '\n') {
+			continue;
+		}
+		content[j++] = content[i];
+	}
+	content.resize(j);
+	return true;
+}
+
+static bool WriteFile(const std::filesystem::path& path, const void* data, size_t size) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	file.write((const char*)data, size);
+	return (bool)file;
+}
+
+enum class Backend {
+	// 只生成 HLSL
+	None,
+	// 调用 fxc.exe，和 D3DCompile 使用相同的编译器，输出的字节码相同
+	Fxc,
+	// 直接调用 D3DCompile，仅限 Windows
+	D3DCompile
+};
+
+// 编译选项和 DirectXHelper::CompileComputeShader 的 Release 配置相同，编译出的字节码可以用于缓存
+class FxcShaderCompiler : public EffectShaderCompiler {
+public:
+	FxcShaderCompiler(std::string_view fxcCommand, const std::filesystem::path& effectDir,
+		const std::filesystem::path& tempDir, bool warningsAreErrors)
+		: _fxcCommand(fxcCommand), _effectDir(effectDir), _tempDir(tempDir), _warningsAreErrors(warningsAreErrors) {}
+
+	bool CompilePass(
+		std::string_view hlsl,
+		std::string_view sourceName,
+		const std::vector<std::pair<std::string, std::string>>& macros,
+		std::vector<uint8_t>& bytecode
+	) noexcept override {
+		// 临时文件名在所有实例间唯一
+		static std::atomic<uint32_t> fileId = 0;
+		const std::filesystem::path basePath = _tempDir / std::to_string(fileId++);
+		std::filesystem::path hlslPath = basePath;
+		hlslPath += ".hlsl";
+		std::filesystem::path csoPath = basePath;
+		csoPath += ".cso";
+		std::filesystem::path errorPath = basePath;
+		errorPath += ".txt";
+
+		if (!WriteFile(hlslPath, hlsl.data(), hlsl.size())) {
+			return false;
+		}
+
+		std::string command = fmt::format(
+			"{} /nologo /T cs_5_0 /E __M /O3 /Ges /all_resources_bound{} /I \"{}\" /Fo \"{}\" /Fe \"{}\"",
+			_fxcCommand, _warningsAreErrors ? " /WX" : "", _effectDir.string(), csoPath.string(), errorPath.string());
+		for (const auto& [name, value] : macros) {
+			command += fmt::format(" /D \"{}={}\"", name, value);
+		}
+		command += fmt::format(" \"{}\"", hlslPath.string());
+#ifdef _WIN32
+		// cmd 会去掉首尾的引号
+		command = "\"" + command + "\"";
+#endif
+
+		const bool success = std::system(command.c_str()) == 0 && ReadFile(csoPath, bytecode) && !bytecode.empty();
+
+		std::string messages;
+		if (ReadFile(errorPath, messages) && !messages.empty()) {
+			std::scoped_lock lk(consoleMutex);
+			std::cout << sourceName << (success ? ": 警告:\n" : ": 错误:\n") << messages << std::endl;
+		}
+
+		std::error_code ec;
+		std::filesystem::remove(hlslPath, ec);
+		std::filesystem::remove(csoPath, ec);
+		std::filesystem::remove(errorPath, ec);
+		return success;
+	}
+
+private:
+	std::string _fxcCommand;
+	std::filesystem::path _effectDir;
+	std::filesystem::path _tempDir;
+	bool _warningsAreErrors;
+};
+
+#ifdef _WIN32
+// 和 EffectCompiler 中的 D3DEffectShaderCompiler 相同，但在效果文件夹中查找 #include 的文件
+class D3DShaderCompiler : public EffectShaderCompiler, private ID3DInclude {
+public:
+	D3DShaderCompiler(const std::filesystem::path& effectDir, bool warningsAreErrors)
+		: _effectDir(effectDir), _warningsAreErrors(warningsAreErrors) {}
+
+	bool CompilePass(
+		std::string_view hlsl,
+		std::string_view sourceName,
+		const std::vector<std::pair<std::string, std::string>>& macros,
+		std::vector<uint8_t>& bytecode
+	) noexcept override {
+		std::vector<D3D_SHADER_MACRO> d3dMacros;
+		d3dMacros.reserve(macros.size() + 1);
+		for (const auto& [name, value] : macros) {
+			d3dMacros.push_back({ name.c_str(), value.c_str() });
+		}
+		d3dMacros.push_back({ nullptr, nullptr });
+
+		UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_ALL_RESOURCES_BOUND | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+		if (_warningsAreErrors) {
+			flags |= D3DCOMPILE_WARNINGS_ARE_ERRORS;
+		}
+
+		ID3DBlob* blob = nullptr;
+		ID3DBlob* errorMsgs = nullptr;
+		const HRESULT hr = D3DCompile(hlsl.data(), hlsl.size(), std::string(sourceName).c_str(),
+			d3dMacros.data(), this, "__M", "cs_5_0", flags, 0, &blob, &errorMsgs);
+
+		if (errorMsgs) {
+			std::scoped_lock lk(consoleMutex);
+			std::cout << sourceName << (SUCCEEDED(hr) ? ": 警告:\n" : ": 错误:\n")
+				<< (const char*)errorMsgs->GetBufferPointer() << std::endl;
+			errorMsgs->Release();
+		}
+
+		if (FAILED(hr)) {
+			return false;
+		}
+
+		const uint8_t* data = (const uint8_t*)blob->GetBufferPointer();
+		bytecode.assign(data, data + blob->GetBufferSize());
+		blob->Release();
+		return true;
+	}
+
+private:
+	HRESULT CALLBACK Open(D3D_INCLUDE_TYPE, LPCSTR pFileName, LPCVOID, LPCVOID* ppData, UINT* pBytes) noexcept override {
+		std::string file;
+		if (!ReadTextFile(_effectDir / std::filesystem::u8path(pFileName), file)) {
+			return E_FAIL;
+		}
+
+		char* result = new char[file.size()];
+		std::memcpy(result, file.data(), file.size());
+
+		*ppData = result;
+		*pBytes = (UINT)file.size();
+		return S_OK;
+	}
+
+	HRESULT CALLBACK Close(LPCVOID pData) noexcept override {
+		delete[](char*)pData;
+		return S_OK;
+	}
+
+	std::filesystem::path _effectDir;
+	bool _warningsAreErrors;
+};
+#endif
+
+struct EffectSource {
+	// 相对于效果文件夹的路径，不含扩展名，分隔符为反斜杠，同 EffectDesc::name
+	std::string name;
+	// 效果所在的文件夹，用于解析 #include
+	std::filesystem::path dir;
+	// 已移除注释
+	std::string source;
+};
+
+struct Options {
+	std::filesystem::path effectsDir;
+	std::filesystem::path outDir;
+	std::filesystem::path cacheDir;
+	std::filesystem::path bundlePath;
+	std::string filter;
+	std::vector<uint32_t> flagCombinations;
+	std::vector<std::pair<std::string, float>> params;
+	Backend backend =
+#ifdef _WIN32
+		Backend::D3DCompile;
+#else
+		Backend::None;
+#endif
+	std::string fxcCommand = "fxc";
+	uint32_t threadCount = 0;
+	bool warningsAreErrors = false;
+};
+
+// 一个效果在一种标志组合下的编译结果
+struct CompileJob {
+	const EffectSource* effect = nullptr;
+	uint32_t flags = 0;
+	EffectDesc desc;
+	EffectSourceBlocks blocks;
+	// 只包含效果中存在的参数
+	std::vector<std::pair<std::string, float>> inlineParams;
+	std::vector<std::string> passSources;
+	std::vector<std::vector<std::pair<std::string, std::string>>> passMacros;
+	EffectParserLog log;
+	std::unique_ptr<EffectShaderCompiler> shaderCompiler;
+	// 解析或编译失败
+	bool failed = false;
+};
+
+static constexpr uint32_t DEFAULT_FLAG_COMBINATIONS[] = {
+	0,
+	EffectCompilerFlags::NoFP16,
+	EffectCompilerFlags::InlineParams,
+	EffectCompilerFlags::InlineParams | EffectCompilerFlags::NoFP16
+};
+
+// 用于输出文件夹的名称
+static std::string FlagsToString(uint32_t flags) {
+	std::string result = (flags & EffectCompilerFlags::InlineParams) ? "InlineParams" : "";
+	if (flags & EffectCompilerFlags::NoFP16) {
+		result += result.empty() ? "NoFP16" : "+NoFP16";
+	}
+	return result.empty() ? "Default" : result;
+}
+
+static bool ParseFlags(std::string_view str, std::vector<uint32_t>& flagCombinations) {
+	while (!str.empty()) {
+		const size_t commaPos = str.find(',');
+		std::string_view combination = str.substr(0, commaPos);
+		str = commaPos == std::string_view::npos ? std::string_view() : str.substr(commaPos + 1);
+
+		uint32_t flags = 0;
+		while (!combination.empty()) {
+			const size_t plusPos = combination.find('+');
+			const std::string_view flag = combination.substr(0, plusPos);
+			combination = plusPos == std::string_view::npos ? std::string_view() : combination.substr(plusPos + 1);
+
+			if (flag == "InlineParams") {
+				flags |= EffectCompilerFlags::InlineParams;
+			} else if (flag == "NoFP16") {
+				flags |= EffectCompilerFlags::NoFP16;
+			} else if (flag != "Default") {
+				std::cout << "未知的标志: " << flag << std::endl;
+				return false;
+			}
+		}
+
+		if (std::find(flagCombinations.begin(), flagCombinations.end(), flags) == flagCombinations.end()) {
+			flagCombinations.push_back(flags);
+		}
+	}
+
+	return !flagCombinations.empty();
+}
+
+static void PrintUsage() {
+	std::cout << "用法:\n"
+		"  EffectBatchCompiler <效果文件夹> [--out 输出文件夹] [--cache-dir 缓存文件夹] [--bundle 内置效果包] [--filter 名称]\n"
+		"      [--flags Default,NoFP16,InlineParams,InlineParams+NoFP16] [--param 名称=值]...\n"
+		"      [--backend none|fxc|d3dcompile] [--fxc fxc.exe] [--threads N] [--warnings-are-errors]\n";
+	std::cout.flush();
+}
+
+static bool ParseOptions(int argc, char* argv[], Options& options) {
+	if (argc < 2) {
+		return false;
+	}
+
+	options.effectsDir = argv[1];
+
+	for (int i = 2; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--out" && i + 1 < argc) {
+			options.outDir = argv[++i];
+		} else if (arg == "--cache-dir" && i + 1 < argc) {
+			options.cacheDir = argv[++i];
+		} else if (arg == "--bundle" && i + 1 < argc) {
+			options.bundlePath = argv[++i];
+		} else if (arg == "--filter" && i + 1 < argc) {
+			options.filter = argv[++i];
+		} else if (arg == "--flags" && i + 1 < argc) {
+			if (!ParseFlags(argv[++i], options.flagCombinations)) {
+				return false;
+			}
+		} else if (arg == "--param" && i + 1 < argc) {
+			std::string_view param = argv[++i];
+			const size_t pos = param.find('=');
+			if (pos == std::string_view::npos) {
+				return false;
+			}
+			options.params.emplace_back(param.substr(0, pos), std::stof(std::string(param.substr(pos + 1))));
+		} else if (arg == "--backend" && i + 1 < argc) {
+			std::string_view backend = argv[++i];
+			if (backend == "none") {
+				options.backend = Backend::None;
+			} else if (backend == "fxc") {
+				options.backend = Backend::Fxc;
+			} else if (backend == "d3dcompile") {
+#ifdef _WIN32
+				options.backend = Backend::D3DCompile;
+#else
+				std::cout << "d3dcompile 后端仅支持 Windows" << std::endl;
+				return false;
+#endif
+			} else {
+				return false;
+			}
+		} else if (arg == "--fxc" && i + 1 < argc) {
+			options.fxcCommand = argv[++i];
+		} else if (arg == "--threads" && i + 1 < argc) {
+			options.threadCount = (uint32_t)std::stoul(argv[++i]);
+		} else if (arg == "--warnings-are-errors") {
+			options.warningsAreErrors = true;
+		} else {
+			return false;
+		}
+	}
+
+	if (options.flagCombinations.empty()) {
+		options.flagCombinations.assign(std::begin(DEFAULT_FLAG_COMBINATIONS), std::end(DEFAULT_FLAG_COMBINATIONS));
+	}
+
+#ifndef ENABLE_EFFECT_CACHE
+	if (!options.cacheDir.empty() || !options.bundlePath.empty()) {
+		std::cout << "编译时未定义 ENABLE_EFFECT_CACHE，不支持生成缓存" << std::endl;
+		return false;
+	}
+#endif
+	if ((!options.cacheDir.empty() || !options.bundlePath.empty()) && options.backend == Backend::None) {
+		std::cout << "生成缓存需要编译着色器，请指定后端" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool LoadEffects(const Options& options, std::vector<EffectSource>& effects) {
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(options.effectsDir, ec)) {
+		if (!entry.is_regular_file() || entry.path().extension() != ".hlsl") {
+			continue;
+		}
+
+		std::string name = entry.path().lexically_relative(options.effectsDir).replace_extension().generic_string();
+		std::replace(name.begin(), name.end(), '/', '\\');
+		if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+			continue;
+		}
+
+		EffectSource& effect = effects.emplace_back();
+		effect.name = std::move(name);
+		effect.dir = entry.path().parent_path();
+		if (!ReadTextFile(entry.path(), effect.source)) {
+			std::cout << "读取 " << entry.path().string() << " 失败" << std::endl;
+			return false;
+		}
+	}
+
+	if (ec) {
+		std::cout << "遍历 " << options.effectsDir.string() << " 失败: " << ec.message() << std::endl;
+		return false;
+	}
+
+	std::sort(effects.begin(), effects.end(),
+		[](const EffectSource& l, const EffectSource& r) { return l.name < r.name; });
+	return true;
+}
+
+static void RunParallel(const std::function<void(uint32_t)>& func, uint32_t count, uint32_t threadCount) {
+	threadCount = std::min(threadCount, count);
+	if (threadCount <= 1) {
+		for (uint32_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::atomic<uint32_t> next = 0;
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back([&]() {
+			for (uint32_t id = next++; id < count; id = next++) {
+				func(id);
+			}
+		});
+	}
+
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+// 和 EffectCompiler::Compile 中编译着色器之前的步骤相同
+static void GeneratePasses(CompileJob& job, const Options& options) {
+	job.desc.name = job.effect->name;
+	if (job.flags & EffectCompilerFlags::InlineParams) {
+		job.desc.flags |= EffectFlags::InlineParams;
+	}
+
+	if (EffectParser::Parse(job.effect->source, job.flags, job.desc, job.blocks, job.log)) {
+		job.failed = true;
+		return;
+	}
+
+	if (job.flags & EffectCompilerFlags::InlineParams) {
+		// --param 对所有效果生效，只保留效果中存在的参数
+		for (const auto& param : options.params) {
+			if (std::any_of(job.desc.params.begin(), job.desc.params.end(),
+				[&](const EffectParameterDesc& paramDesc) { return paramDesc.name == param.first; })) {
+				job.inlineParams.push_back(param);
+			}
+		}
+	}
+
+	std::string cbHlsl;
+	if (EffectParser::GenerateConstantBuffer(job.desc, &job.inlineParams, cbHlsl, job.log)) {
+		job.failed = true;
+		return;
+	}
+
+	const uint32_t passCount = (uint32_t)job.desc.passes.size();
+	job.passSources.resize(passCount);
+	job.passMacros.resize(passCount);
+	for (uint32_t i = 0; i < passCount; ++i) {
+		EffectParser::GeneratePassSource(job.desc, i + 1, cbHlsl, job.blocks, job.passSources[i], job.passMacros[i]);
+	}
+}
+
+static std::string EscapeJson(std::string_view str) {
+	std::string result;
+	result.reserve(str.size() + 2);
+	result.push_back('"');
+	for (char c : str) {
+		switch (c) {
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		case '\n':
+			result += "\\n";
+			break;
+		case '\t':
+			result += "\\t";
+			break;
+		default:
+			if ((unsigned char)c < 0x20) {
+				result += fmt::format("\\u{:04x}", (unsigned char)c);
+			} else {
+				result.push_back(c);
+			}
+			break;
+		}
+	}
+	result.push_back('"');
+	return result;
+}
+
+template <typename T>
+static std::string JoinJson(const T& items) {
+	std::string result = "[";
+	for (const auto& item : items) {
+		if (result.size() > 1) {
+			result += ", ";
+		}
+		result += fmt::format("{}", item);
+	}
+	result += "]";
+	return result;
+}
+
+// 元数据包含 EffectDesc 中除字节码以外的所有字段以及每个通道的宏
+static std::string GenerateMetadata(const CompileJob& job, std::string_view passFileName) {
+	const EffectDesc& desc = job.desc;
+	std::string json = fmt::format("{{\n\t\"name\": {},\n\t\"flags\": {},\n\t\"inlineParams\": {},\n",
+		EscapeJson(desc.name), EscapeJson(FlagsToString(job.flags)), (desc.flags & EffectFlags::InlineParams) ? "true" : "false");
+
+	json += "\t\"params\": [";
+	for (size_t i = 0; i < desc.params.size(); ++i) {
+		const EffectParameterDesc& param = desc.params[i];
+		json += fmt::format("{}\n\t\t{{ \"name\": {}, \"label\": {}, ", i == 0 ? "" : ",",
+			EscapeJson(param.name), EscapeJson(param.label));
+		std::visit([&](const auto& constant) {
+			using T = std::decay_t<decltype(constant.defaultValue)>;
+			json += fmt::format("\"type\": \"{}\", \"default\": {}, \"min\": {}, \"max\": {}, \"step\": {} }}",
+				std::is_same_v<T, float> ? "float" : "int",
+				constant.defaultValue, constant.minValue, constant.maxValue, constant.step);
+		}, param.constant);
+	}
+	json += desc.params.empty() ? "],\n" : "\n\t],\n";
+
+	json += "\t\"textures\": [";
+	for (size_t i = 0; i < desc.textures.size(); ++i) {
+		const EffectIntermediateTextureDesc& texture = desc.textures[i];
+		const char* format = texture.format == EffectIntermediateTextureFormat::UNKNOWN
+			? "UNKNOWN" : EffectHelper::FORMAT_DESCS[(size_t)texture.format].name;
+		json += fmt::format("{}\n\t\t{{ \"name\": {}, \"format\": \"{}\", \"width\": {}, \"height\": {}, \"source\": {} }}",
+			i == 0 ? "" : ",", EscapeJson(texture.name), format, EscapeJson(texture.sizeExpr.first),
+			EscapeJson(texture.sizeExpr.second), EscapeJson(texture.source));
+	}
+	json += desc.textures.empty() ? "],\n" : "\n\t],\n";
+
+	json += "\t\"samplers\": [";
+	for (size_t i = 0; i < desc.samplers.size(); ++i) {
+		const EffectSamplerDesc& sampler = desc.samplers[i];
+		json += fmt::format("{}\n\t\t{{ \"name\": {}, \"filter\": \"{}\", \"address\": \"{}\" }}",
+			i == 0 ? "" : ",", EscapeJson(sampler.name),
+			sampler.filterType == EffectSamplerFilterType::Linear ? "Linear" : "Point",
+			sampler.addressType == EffectSamplerAddressType::Clamp ? "Clamp" : "Wrap");
+	}
+	json += desc.samplers.empty() ? "],\n" : "\n\t],\n";
+
+	json += "\t\"passes\": [";
+	for (size_t i = 0; i < desc.passes.size(); ++i) {
+		const EffectPassDesc& pass = desc.passes[i];
+
+		std::string macros = "{";
+		for (const auto& [name, value] : job.passMacros[i]) {
+			macros += fmt::format("{}{}: {}", macros.size() > 1 ? ", " : " ", EscapeJson(name), EscapeJson(value));
+		}
+		macros += macros.size() > 1 ? " }" : "}";
+
+		json += fmt::format("{}\n\t\t{{\n\t\t\t\"desc\": {},\n\t\t\t\"source\": {},\n\t\t\t\"inputs\": {},\n"
+			"\t\t\t\"outputs\": {},\n\t\t\t\"numThreads\": {},\n\t\t\t\"blockSize\": [{}, {}],\n"
+			"\t\t\t\"psStyle\": {},\n\t\t\t\"fp16\": {},\n\t\t\t\"mulAdd\": {},\n\t\t\t\"dynamic\": {},\n"
+			"\t\t\t\"sampleRadius\": {},\n\t\t\t\"csoSize\": {},\n\t\t\t\"macros\": {}\n\t\t}}",
+			i == 0 ? "" : ",", EscapeJson(pass.desc),
+			EscapeJson(desc.passes.size() == 1 ? fmt::format("{}.hlsl", passFileName) : fmt::format("{}_Pass{}.hlsl", passFileName, i + 1)),
+			JoinJson(pass.inputs), JoinJson(pass.outputs), JoinJson(pass.numThreads),
+			pass.blockSize.first, pass.blockSize.second,
+			(pass.flags & EffectPassFlags::PSStyle) ? "true" : "false",
+			(pass.flags & EffectPassFlags::UseFP16) ? "true" : "false",
+			(pass.flags & EffectPassFlags::UseMulAdd) ? "true" : "false",
+			(pass.flags & EffectPassFlags::UseDynamic) ? "true" : "false",
+			pass.sampleRadius, pass.cso.size(), macros);
+	}
+	json += desc.passes.empty() ? "]\n}\n" : "\n\t]\n}\n";
+
+	return json;
+}
+
+// 输出到 {输出文件夹}/{标志}/{效果名}，通道的命名和 SaveSources 相同
+static bool WriteOutputs(const CompileJob& job, const Options& options) {
+	const std::string& name = job.effect->name;
+	const size_t delimPos = name.find_last_of('\\');
+	const std::string fileName = delimPos == std::string::npos ? name : name.substr(delimPos + 1);
+
+	std::filesystem::path dir = options.outDir / FlagsToString(job.flags);
+	if (delimPos != std::string::npos) {
+		std::string subDir = name.substr(0, delimPos);
+		std::replace(subDir.begin(), subDir.end(), '\\', '/');
+		dir /= std::filesystem::u8path(subDir);
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+	if (ec) {
+		return false;
+	}
+
+	const uint32_t passCount = (uint32_t)job.passSources.size();
+	for (uint32_t i = 0; i < passCount; ++i) {
+		const std::string passName = passCount == 1 ? fileName : fmt::format("{}_Pass{}", fileName, i + 1);
+		std::filesystem::path passPath = dir / std::filesystem::u8path(passName + ".hlsl");
+		if (!WriteFile(passPath, job.passSources[i].data(), job.passSources[i].size())) {
+			return false;
+		}
+
+		const std::vector<uint8_t>& cso = job.desc.passes[i].cso;
+		if (!cso.empty()) {
+			passPath.replace_extension(".cso");
+			if (!WriteFile(passPath, cso.data(), cso.size())) {
+				return false;
+			}
+		}
+	}
+
+	const std::string metadata = GenerateMetadata(job, fileName);
+	return WriteFile(dir / std::filesystem::u8path(fileName + ".json"), metadata.data(), metadata.size());
+}
+
+#ifdef ENABLE_EFFECT_CACHE
+// 和 EffectCompiler::Compile 使用相同的缓存键
+static std::string GetCacheKey(const CompileJob& job) {
+	return EffectCacheSerializer::GetKey(job.effect->source,
+		(job.flags & EffectCompilerFlags::InlineParams) ? &job.inlineParams : nullptr);
+}
+
+// 和 EffectCacheManager 使用相同的文件名和格式，并删除同一效果和标志的旧缓存
+static bool WriteCache(const CompileJob& job, const Options& options) {
+	std::string linearName = job.effect->name;
+	std::replace(linearName.begin(), linearName.end(), '\\', '#');
+
+	// 只有低 16 位的标志会影响编译出的字节码
+	const uint32_t cacheFlags = job.flags & 0xFFFF;
+	const std::string key = GetCacheKey(job);
+	const std::string prefix = fmt::format("{}_{:04x}_", linearName, cacheFlags);
+	const std::string cacheFileName = fmt::format("{}{:016x}", prefix, EffectCacheSerializer::GetHash(key));
+
+	std::vector<uint8_t> buf;
+	if (!EffectCacheSerializer::Save(key, job.desc, buf)) {
+		return false;
+	}
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(options.cacheDir, ec)) {
+		const std::u8string u8Name = entry.path().filename().u8string();
+		const std::string_view name((const char*)u8Name.data(), u8Name.size());
+		if (name.size() == prefix.size() + 16 && name.starts_with(prefix) && name != cacheFileName &&
+			std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return c >= '0' && c <= '9' || c >= 'a' && c <= 'f'; })) {
+			std::filesystem::remove(entry.path(), ec);
+		}
+	}
+
+	return WriteFile(options.cacheDir / std::filesystem::u8path(cacheFileName), buf.data(), buf.size());
+}
+
+// 将所有编译成功的效果打包，由 EffectCacheManager 作为只读缓存加载
+static bool WriteBundle(const std::vector<CompileJob>& jobs, const Options& options) {
+	std::vector<EffectBundleEntry> entries;
+	entries.reserve(jobs.size());
+	for (const CompileJob& job : jobs) {
+		if (job.failed) {
+			continue;
+		}
+
+		EffectBundleEntry& entry = entries.emplace_back();
+		entry.name = job.effect->name;
+		entry.flags = job.flags & 0xFFFF;
+
+		entry.hash = EffectCacheSerializer::GetHash(GetCacheKey(job));
+		if (!EffectCacheSerializer::Save({}, job.desc, entry.data)) {
+			return false;
+		}
+	}
+
+	std::vector<uint8_t> buf;
+	if (!EffectBundle::Write(entries, EffectCacheSerializer::VERSION, buf)) {
+		return false;
+	}
+
+	std::error_code ec;
+	if (options.bundlePath.has_parent_path()) {
+		std::filesystem::create_directories(options.bundlePath.parent_path(), ec);
+	}
+
+	std::printf("内置效果包包含 %zu 项，共 %.1f MB\n", entries.size(), buf.size() / 1048576.0);
+	return WriteFile(options.bundlePath, buf.data(), buf.size());
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		PrintUsage();
+		return 2;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<EffectSource> effects;
+	if (!LoadEffects(options, effects)) {
+		return 2;
+	}
+	if (effects.empty()) {
+		std::cout << "未找到效果" << std::endl;
+		return 2;
+	}
+
+	uint32_t threadCount = options.threadCount;
+	if (threadCount == 0) {
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	// 移除注释和标志无关，每个效果只需执行一次
+	std::vector<uint8_t> commentsRemoved(effects.size());
+	RunParallel([&](uint32_t id) {
+		commentsRemoved[id] = !effects[id].source.empty() && !EffectParser::RemoveComments(effects[id].source);
+	}, (uint32_t)effects.size(), threadCount);
+
+	std::vector<CompileJob> jobs(effects.size() * options.flagCombinations.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		CompileJob& job = jobs[i];
+		job.effect = &effects[i / options.flagCombinations.size()];
+		job.flags = options.flagCombinations[i % options.flagCombinations.size()];
+		if (!commentsRemoved[i / options.flagCombinations.size()]) {
+			job.failed = true;
+			job.log.error = "移除注释失败";
+		}
+	}
+
+	// 第一步: 解析所有效果并生成所有通道的源码
+	RunParallel([&](uint32_t id) {
+		if (!jobs[id].failed) {
+			GeneratePasses(jobs[id], options);
+		}
+	}, (uint32_t)jobs.size(), threadCount);
+
+	// 第二步: 编译所有通道。通道数差异很大，因此以通道为单位并行
+	std::vector<std::pair<uint32_t, uint32_t>> passes;
+	if (options.backend != Backend::None) {
+		std::filesystem::path tempDir;
+		if (options.backend == Backend::Fxc) {
+			tempDir = std::filesystem::temp_directory_path() / fmt::format("EffectBatchCompiler_{}",
+				std::chrono::steady_clock::now().time_since_epoch().count());
+			std::filesystem::create_directories(tempDir);
+		}
+
+		for (uint32_t i = 0; i < jobs.size(); ++i) {
+			CompileJob& job = jobs[i];
+			if (job.failed) {
+				continue;
+			}
+
+			if (options.backend == Backend::Fxc) {
+				job.shaderCompiler = std::make_unique<FxcShaderCompiler>(
+					options.fxcCommand, job.effect->dir, tempDir, options.warningsAreErrors);
+			} else {
+#ifdef _WIN32
+				job.shaderCompiler = std::make_unique<D3DShaderCompiler>(job.effect->dir, options.warningsAreErrors);
+#endif
+			}
+
+			for (uint32_t j = 0; j < job.passSources.size(); ++j) {
+				passes.emplace_back(i, j);
+			}
+		}
+
+		RunParallel([&](uint32_t id) {
+			const auto [jobIdx, passIdx] = passes[id];
+			CompileJob& job = jobs[jobIdx];
+			job.shaderCompiler->CompilePass(job.passSources[passIdx],
+				fmt::format("{}_Pass{}.hlsl", job.desc.name, passIdx + 1),
+				job.passMacros[passIdx], job.desc.passes[passIdx].cso);
+		}, (uint32_t)passes.size(), threadCount);
+
+		for (CompileJob& job : jobs) {
+			if (!job.failed && std::any_of(job.desc.passes.begin(), job.desc.passes.end(),
+				[](const EffectPassDesc& pass) { return pass.cso.empty(); })) {
+				job.failed = true;
+				job.log.error = "编译着色器失败";
+			}
+		}
+
+		if (!tempDir.empty()) {
+			std::error_code ec;
+			std::filesystem::remove_all(tempDir, ec);
+		}
+	}
+
+	// 第三步: 输出源码、元数据和缓存
+	if (!options.cacheDir.empty()) {
+		std::error_code ec;
+		std::filesystem::create_directories(options.cacheDir, ec);
+	}
+
+	std::atomic<uint32_t> cacheCount = 0;
+	RunParallel([&](uint32_t id) {
+		CompileJob& job = jobs[id];
+		if (job.failed) {
+			return;
+		}
+
+		if (!options.outDir.empty() && !WriteOutputs(job, options)) {
+			job.log.error = "保存输出失败";
+		}
+
+#ifdef ENABLE_EFFECT_CACHE
+		if (!options.cacheDir.empty()) {
+			if (WriteCache(job, options)) {
+				++cacheCount;
+			} else {
+				job.log.error = "保存缓存失败";
+			}
+		}
+#endif
+	}, (uint32_t)jobs.size(), threadCount);
+
+#ifdef ENABLE_EFFECT_CACHE
+	// 即使有效果失败也生成，失败的效果将在运行时编译
+	bool bundleFailed = false;
+	if (!options.bundlePath.empty() && !WriteBundle(jobs, options)) {
+		std::cout << "保存内置效果包失败" << std::endl;
+		bundleFailed = true;
+	}
+#else
+	constexpr bool bundleFailed = false;
+#endif
+
+	// 按效果名和标志的顺序输出消息
+	uint32_t failedCount = 0;
+	for (const CompileJob& job : jobs) {
+		for (const std::string& warning : job.log.warnings) {
+			std::cout << job.effect->name << " (" << FlagsToString(job.flags) << "): 警告: " << warning << std::endl;
+		}
+
+		if (!job.log.error.empty() || job.failed) {
+			std::cout << job.effect->name << " (" << FlagsToString(job.flags) << "): "
+				<< (job.log.error.empty() ? "失败" : job.log.error) << std::endl;
+			++failedCount;
+		}
+	}
+
+	size_t generatedCount = 0;
+	for (const CompileJob& job : jobs) {
+		generatedCount += job.passSources.size();
+	}
+
+	std::printf("%zu 个效果，%zu 种标志组合，生成 %zu 个通道，编译 %zu 个，保存 %u 个缓存，%u 个失败，用时 %.2f 秒\n",
+		effects.size(), options.flagCombinations.size(), generatedCount, passes.size(), cacheCount.load(), failedCount,
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+	return failedCount == 0 && !bundleFailed ? 0 : 1;
+}
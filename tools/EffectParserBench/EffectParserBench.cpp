@@ -0,0 +1,514 @@
+// EffectParserBench.cpp : 测量 MagpieFX 前端（解析和生成 HLSL）的性能，并用变异的源码检查解析器的健壮性
+// 只依赖标准库和 fmt，在 Linux 上可以直接编译:
+// g++ -std=c++20 -O2 -I../../src/Magpie.Core -I../../src/Magpie.Core/include EffectParserBench.cpp ../../src/Magpie.Core/EffectParser.cpp ../../src/Magpie.Core/SmallVector.cpp -lfmt -o EffectParserBench
+//
+
+#include "EffectParser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+using namespace Magpie;
+
+struct EffectSource {
+	// 相对于效果文件夹的路径，不含扩展名，分隔符为反斜杠，同 EffectDesc::name
+	std::string name;
+	std::string source;
+};
+
+// 和 EffectCompiler 相同的标志组合，最后一个是用户界面读取参数时使用的
+static constexpr uint32_t FLAG_COMBINATIONS[] = {
+	0,
+	EffectCompilerFlags::NoFP16,
+	EffectCompilerFlags::InlineParams,
+	EffectCompilerFlags::InlineParams | EffectCompilerFlags::NoFP16,
+	EffectCompilerFlags::NoCompile
+};
+
+static std::string FlagsToString(uint32_t flags) {
+	if (flags & EffectCompilerFlags::NoCompile) {
+		return "NoCompile";
+	}
+
+	std::string result = (flags & EffectCompilerFlags::InlineParams) ? "InlineParams" : "";
+	if (flags & EffectCompilerFlags::NoFP16) {
+		result += result.empty() ? "NoFP16" : "|NoFP16";
+	}
+	return result.empty() ? "默认" : result;
+}
+
+static bool ReadFile(const std::filesystem::path& path, std::string& content) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	// 去掉 UTF-8 BOM
+	if (content.starts_with("\xEF\xBB\xBF")) {
+		content.erase(0, 3);
+	}
+	return true;
+}
+
+static bool LoadEffects(const std::filesystem::path& effectsDir, std::string_view filter, std::vector<EffectSource>& effects) {
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(effectsDir, ec)) {
+		if (!entry.is_regular_file() || entry.path().extension() != ".hlsl") {
+			continue;
+		}
+
+		std::string name = entry.path().lexically_relative(effectsDir).replace_extension().generic_string();
+		std::replace(name.begin(), name.end(), '/', '\\');
+		if (!filter.empty() && name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		EffectSource& effect = effects.emplace_back();
+		effect.name = std::move(name);
+		if (!ReadFile(entry.path(), effect.source)) {
+			std::cout << "读取 " << entry.path().string() << " 失败" << std::endl;
+			return false;
+		}
+	}
+
+	if (ec) {
+		std::cout << "遍历 " << effectsDir.string() << " 失败: " << ec.message() << std::endl;
+		return false;
+	}
+
+	std::sort(effects.begin(), effects.end(),
+		[](const EffectSource& l, const EffectSource& r) { return l.name < r.name; });
+	return true;
+}
+
+struct FrontendResult {
+	// 0: 成功，1: 移除注释失败，2: 解析失败，3: 生成常量缓冲区失败
+	uint32_t stage = 0;
+	EffectDesc desc;
+	EffectParserLog log;
+	size_t generatedSize = 0;
+	// 为 true 时保存生成的源码
+	bool keepSources = false;
+	std::vector<std::string> passSources;
+};
+
+// 和 EffectCompiler::Compile 中编译着色器之前的步骤相同。source 会被修改
+static void RunFrontend(std::string& source, std::string_view name, uint32_t flags, FrontendResult& result) {
+	result.desc = {};
+	result.desc.name = name;
+	if (flags & EffectCompilerFlags::InlineParams) {
+		result.desc.flags |= EffectFlags::InlineParams;
+	}
+
+	if (source.empty() || EffectParser::RemoveComments(source)) {
+		result.stage = 1;
+		return;
+	}
+
+	EffectSourceBlocks blocks;
+	if (EffectParser::Parse(source, flags, result.desc, blocks, result.log)) {
+		result.stage = 2;
+		return;
+	}
+
+	if (flags & EffectCompilerFlags::NoCompile) {
+		result.stage = 0;
+		return;
+	}
+
+	std::string cbHlsl;
+	if (EffectParser::GenerateConstantBuffer(result.desc, nullptr, cbHlsl, result.log)) {
+		result.stage = 3;
+		return;
+	}
+
+	for (uint32_t i = 1; i <= result.desc.passes.size(); ++i) {
+		std::string passSource;
+		std::vector<std::pair<std::string, std::string>> macros;
+		EffectParser::GeneratePassSource(result.desc, i, cbHlsl, blocks, passSource, macros);
+		result.generatedSize += passSource.size();
+
+		if (result.keepSources) {
+			result.passSources.push_back(std::move(passSource));
+		}
+	}
+
+	result.stage = 0;
+}
+
+// 检查解析成功时 EffectDesc 是否自洽，返回违反的条件，全部满足时返回空
+static std::string_view CheckInvariants(const FrontendResult& result, uint32_t flags) {
+	const EffectDesc& desc = result.desc;
+
+	if (desc.textures.size() < 2 || desc.textures[0].name != "INPUT" || desc.textures[1].name != "OUTPUT") {
+		return "前两个纹理不是 INPUT 和 OUTPUT";
+	}
+
+	if (flags & EffectCompilerFlags::NoCompile) {
+		return {};
+	}
+
+	if (desc.passes.empty()) {
+		return "没有通道";
+	}
+
+	for (const EffectPassDesc& passDesc : desc.passes) {
+		if (passDesc.outputs.empty()) {
+			return "通道没有输出";
+		}
+
+		for (uint32_t idx : passDesc.inputs) {
+			if (idx >= desc.textures.size()) {
+				return "输入纹理越界";
+			}
+		}
+		for (uint32_t idx : passDesc.outputs) {
+			if (idx >= desc.textures.size() || idx == 0) {
+				return "输出纹理越界";
+			}
+		}
+
+		if ((passDesc.flags & EffectPassFlags::UseFP16) && (flags & EffectCompilerFlags::NoFP16)) {
+			return "NoFP16 时通道仍使用 FP16";
+		}
+	}
+
+	if (desc.passes.back().outputs.size() != 1 || desc.passes.back().outputs[0] != 1) {
+		return "最后一个通道的输出不是 OUTPUT";
+	}
+
+	for (const std::string& passSource : result.passSources) {
+		if (passSource.find("void __M(") == std::string::npos) {
+			return "生成的源码没有入口点";
+		}
+	}
+
+	return {};
+}
+
+static void PrintUsage() {
+	std::cout << "用法:\n"
+		"  EffectParserBench check <效果文件夹> [--filter 名称]\n"
+		"  EffectParserBench bench <效果文件夹> [--filter 名称] [--iterations 20]\n"
+		"  EffectParserBench fuzz <效果文件夹> [--filter 名称] [--iterations 200] [--seed 1]\n";
+	std::cout.flush();
+}
+
+struct Options {
+	std::filesystem::path effectsDir;
+	std::string filter;
+	uint32_t iterations = 0;
+	uint64_t seed = 1;
+};
+
+static bool ParseOptions(int argc, char* argv[], Options& options) {
+	if (argc < 3) {
+		return false;
+	}
+
+	options.effectsDir = argv[2];
+
+	for (int i = 3; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) {
+			options.filter = argv[++i];
+		} else if (arg == "--iterations" && i + 1 < argc) {
+			options.iterations = std::max((uint32_t)std::stoul(argv[++i]), 1u);
+		} else if (arg == "--seed" && i + 1 < argc) {
+			options.seed = std::stoull(argv[++i]);
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// 所有内置效果在每种标志组合下都应解析成功且没有警告
+static int Check(const std::vector<EffectSource>& effects) {
+	uint32_t failedCount = 0;
+	FrontendResult result;
+	result.keepSources = true;
+
+	for (const EffectSource& effect : effects) {
+		for (uint32_t flags : FLAG_COMBINATIONS) {
+			std::string source = effect.source;
+			result.log = {};
+			result.passSources.clear();
+			RunFrontend(source, effect.name, flags, result);
+
+			std::string_view error;
+			if (result.stage != 0) {
+				error = result.log.error.empty() ? "移除注释失败" : result.log.error;
+			} else {
+				error = CheckInvariants(result, flags);
+			}
+
+			if (!error.empty()) {
+				std::cout << effect.name << " (" << FlagsToString(flags) << "): " << error << std::endl;
+				++failedCount;
+			}
+			for (const std::string& warning : result.log.warnings) {
+				std::cout << effect.name << " (" << FlagsToString(flags) << "): 警告: " << warning << std::endl;
+			}
+		}
+	}
+
+	std::printf("%zu 个效果，%u 个失败\n", effects.size(), failedCount);
+	return failedCount == 0 ? 0 : 1;
+}
+
+static double Median(std::vector<double>& times) {
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+static int Bench(const std::vector<EffectSource>& effects, uint32_t iterations) {
+	using Clock = std::chrono::steady_clock;
+
+	size_t totalSourceSize = 0;
+	size_t totalGeneratedSize = 0;
+	double totalParseTime = 0;
+	double totalGenerateTime = 0;
+
+	std::printf("%-40s %10s %12s %12s %12s\n", "效果", "源码 (KB)", "解析 (us)", "生成 (us)", "输出 (KB)");
+
+	FrontendResult result;
+	std::vector<double> parseTimes;
+	std::vector<double> generateTimes;
+
+	for (const EffectSource& effect : effects) {
+		parseTimes.clear();
+		generateTimes.clear();
+
+		// 第一次运行用于预热
+		for (uint32_t i = 0; i <= iterations; ++i) {
+			std::string source = effect.source;
+
+			// 解析，包括移除注释
+			const auto start = Clock::now();
+			result.desc = {};
+			result.desc.name = effect.name;
+			result.log = {};
+			EffectSourceBlocks blocks;
+			if (EffectParser::RemoveComments(source) || EffectParser::Parse(source, 0, result.desc, blocks, result.log)) {
+				std::cout << effect.name << ": 解析失败 " << result.log.error << std::endl;
+				return 1;
+			}
+			const auto parsed = Clock::now();
+
+			// 生成所有通道的源码
+			std::string cbHlsl;
+			EffectParser::GenerateConstantBuffer(result.desc, nullptr, cbHlsl, result.log);
+			size_t generatedSize = 0;
+			for (uint32_t j = 1; j <= result.desc.passes.size(); ++j) {
+				std::string passSource;
+				std::vector<std::pair<std::string, std::string>> macros;
+				EffectParser::GeneratePassSource(result.desc, j, cbHlsl, blocks, passSource, macros);
+				generatedSize += passSource.size();
+			}
+			const auto generated = Clock::now();
+
+			if (i == 0) {
+				result.generatedSize = generatedSize;
+				continue;
+			}
+
+			parseTimes.push_back(std::chrono::duration<double, std::micro>(parsed - start).count());
+			generateTimes.push_back(std::chrono::duration<double, std::micro>(generated - parsed).count());
+		}
+
+		const double parseTime = Median(parseTimes);
+		const double generateTime = Median(generateTimes);
+		std::printf("%-40s %10.1f %12.1f %12.1f %12.1f\n", effect.name.c_str(), effect.source.size() / 1024.0,
+			parseTime, generateTime, result.generatedSize / 1024.0);
+
+		totalSourceSize += effect.source.size();
+		totalGeneratedSize += result.generatedSize;
+		totalParseTime += parseTime;
+		totalGenerateTime += generateTime;
+	}
+
+	std::printf("\n%zu 个效果，解析共 %.2f ms (%.1f MB/s)，生成共 %.2f ms (%.1f MB/s)\n", effects.size(),
+		totalParseTime / 1000, totalSourceSize / totalParseTime,
+		totalGenerateTime / 1000, totalGeneratedSize / totalGenerateTime);
+	return 0;
+}
+
+// 对源码随机做一到四处修改。插入的片段偏向 MagpieFX 的语法，以便变异后的源码能进入解析的深处
+static void Mutate(std::string& source, std::mt19937_64& rng) {
+	static constexpr std::string_view FRAGMENTS[] = {
+		"//!", "//! ", "/*", "*/", "//", "\n", " ", ",", ";", "0", "1", "-1", "4294967296", "1e40",
+		"INPUT", "OUTPUT", "PASS", "COMMON", "TEXTURE", "SAMPLER", "PARAMETER",
+		"//! PASS 1\n", "//! PASS 2\n", "//! IN INPUT\n", "//! OUT OUTPUT\n", "//! IN ", "//! OUT ",
+		"//! STYLE PS\n", "//! STYLE CS\n", "//! BLOCK_SIZE 0\n", "//! BLOCK_SIZE 8, \n", "//! NUM_THREADS 64,1,1,1\n",
+		"//! RADIUS 2147483648\n", "//! USE FP16, MulAdd, Dynamic\n", "//! FORMAT R8G8B8A8_UNORM\n",
+		"//! WIDTH OUTPUT_WIDTH\n", "//! HEIGHT\n", "//! SOURCE a.dds\n", "//! DEFAULT 1\n", "//! MIN 2\n",
+		"//! MAX 0\n", "//! STEP 0\n", "Texture2D ", "SamplerState ", "float ", "int ", "#include \"a.hlsli\"\n",
+	};
+
+	auto randomPos = [&](size_t size) {
+		return size == 0 ? 0 : size_t(rng() % (size + 1));
+	};
+
+	auto lineRange = [&](size_t pos, size_t& begin, size_t& end) {
+		begin = source.rfind('\n', pos == 0 ? 0 : pos - 1);
+		begin = begin == std::string::npos ? 0 : begin + 1;
+		end = source.find('\n', pos);
+		end = end == std::string::npos ? source.size() : end + 1;
+	};
+
+	const uint32_t count = 1 + uint32_t(rng() % 4);
+	for (uint32_t i = 0; i < count; ++i) {
+		const size_t pos = randomPos(source.size());
+
+		switch (rng() % 7) {
+		case 0:
+		{
+			// 替换一个字节
+			if (pos < source.size()) {
+				source[pos] = (char)(rng() % 128);
+			}
+			break;
+		}
+		case 1:
+		{
+			// 删除一段
+			source.erase(pos, size_t(1 + rng() % 64));
+			break;
+		}
+		case 2:
+		{
+			// 插入片段
+			source.insert(pos, FRAGMENTS[rng() % std::size(FRAGMENTS)]);
+			break;
+		}
+		case 3:
+		{
+			// 删除一行
+			size_t begin, end;
+			lineRange(pos, begin, end);
+			source.erase(begin, end - begin);
+			break;
+		}
+		case 4:
+		{
+			// 复制一行
+			size_t begin, end;
+			lineRange(pos, begin, end);
+			source.insert(begin, source.substr(begin, end - begin));
+			break;
+		}
+		case 5:
+		{
+			// 截断
+			source.resize(pos);
+			break;
+		}
+		case 6:
+		{
+			// 把一行移动到其他位置
+			size_t begin, end;
+			lineRange(pos, begin, end);
+			std::string line = source.substr(begin, end - begin);
+			source.erase(begin, end - begin);
+			source.insert(randomPos(source.size()), line);
+			break;
+		}
+		}
+	}
+}
+
+static int Fuzz(const std::vector<EffectSource>& effects, uint32_t iterations, uint64_t seed) {
+	uint64_t rejectedCount = 0;
+	uint64_t acceptedCount = 0;
+	uint32_t failureCount = 0;
+
+	FrontendResult result;
+	result.keepSources = true;
+
+	for (const EffectSource& effect : effects) {
+		// 每个效果使用独立的随机数序列，筛选效果不影响重现
+		std::mt19937_64 rng(seed ^ std::hash<std::string>()(effect.name));
+
+		for (uint32_t i = 0; i < iterations; ++i) {
+			std::string mutated = effect.source;
+			Mutate(mutated, rng);
+
+			for (uint32_t flags : FLAG_COMBINATIONS) {
+				std::string source = mutated;
+				result.log = {};
+				result.passSources.clear();
+				RunFrontend(source, effect.name, flags, result);
+
+				if (result.stage != 0) {
+					++rejectedCount;
+					continue;
+				}
+
+				++acceptedCount;
+
+				std::string_view error = CheckInvariants(result, flags);
+				if (error.empty()) {
+					continue;
+				}
+
+				// 保存导致失败的源码以便重现
+				std::string fileName = "fuzz_failure_" + std::to_string(failureCount++) + ".hlsl";
+				std::ofstream(fileName, std::ios::binary) << mutated;
+				std::cout << effect.name << " #" << i << " (" << FlagsToString(flags) << "): "
+					<< error << "，已保存到 " << fileName << std::endl;
+			}
+		}
+	}
+
+	std::printf("%zu 个效果，每个 %u 次变异: 拒绝 %llu 次，接受 %llu 次，%u 次违反约束\n",
+		effects.size(), iterations, (unsigned long long)rejectedCount, (unsigned long long)acceptedCount, failureCount);
+	return failureCount == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	Options options;
+	if (argc < 2 || !ParseOptions(argc, argv, options)) {
+		PrintUsage();
+		return 2;
+	}
+
+	std::vector<EffectSource> effects;
+	if (!LoadEffects(options.effectsDir, options.filter, effects)) {
+		return 2;
+	}
+	if (effects.empty()) {
+		std::cout << "未找到效果" << std::endl;
+		return 2;
+	}
+
+	const std::string_view command = argv[1];
+	if (command == "check") {
+		return Check(effects);
+	} else if (command == "bench") {
+		return Bench(effects, options.iterations == 0 ? 20 : options.iterations);
+	} else if (command == "fuzz") {
+		return Fuzz(effects, options.iterations == 0 ? 200 : options.iterations, options.seed);
+	} else {
+		PrintUsage();
+		return 2;
+	}
+}
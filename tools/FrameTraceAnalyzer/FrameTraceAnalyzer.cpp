@@ -0,0 +1,267 @@
+// FrameTraceAnalyzer.cpp : 分析 Magpie 记录的帧时间线 (logs\frame_trace.csv)
+// 只使用标准库，在 Linux 上可以直接编译: g++ -std=c++20 -O2 FrameTraceAnalyzer.cpp -o FrameTraceAnalyzer
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+// 帧间隔超过中位数的此倍数视为卡顿
+static constexpr double STUTTER_FACTOR = 2.0;
+
+struct FrameRecord {
+	uint64_t frame = 0;
+	std::string stepTimer;
+	std::string source;
+	std::string duplicate;
+	std::optional<double> frameBegin;
+	std::optional<double> capture;
+	std::optional<double> renderStart;
+	std::optional<double> renderEnd;
+	std::optional<double> present;
+	std::vector<std::optional<double>> effectTimings;
+};
+
+static std::vector<std::string> SplitCsvLine(std::string_view line) {
+	std::vector<std::string> result;
+	std::string cur;
+	bool inQuotes = false;
+
+	for (char c : line) {
+		if (c == '"') {
+			inQuotes = !inQuotes;
+		} else if (c == ',' && !inQuotes) {
+			result.push_back(std::move(cur));
+			cur.clear();
+		} else if (c != '\r') {
+			cur.push_back(c);
+		}
+	}
+	result.push_back(std::move(cur));
+
+	return result;
+}
+
+static std::optional<double> ParseTime(const std::string& str) {
+	if (str.empty()) {
+		return std::nullopt;
+	}
+
+	try {
+		return std::stod(str);
+	} catch (...) {
+		return std::nullopt;
+	}
+}
+
+// 最近秩法，values 必须已排序
+static double Percentile(const std::vector<double>& values, double p) {
+	if (values.empty()) {
+		return 0.0;
+	}
+
+	size_t rank = (size_t)std::max(1.0, std::ceil(p * values.size()));
+	return values[std::min(rank, values.size()) - 1];
+}
+
+static double Mean(const std::vector<double>& values) {
+	if (values.empty()) {
+		return 0.0;
+	}
+
+	double total = 0.0;
+	for (double v : values) {
+		total += v;
+	}
+	return total / values.size();
+}
+
+static void PrintDistribution(const char* name, std::vector<double> values) {
+	if (values.empty()) {
+		std::printf("  %-24s 无数据\n", name);
+		return;
+	}
+
+	std::sort(values.begin(), values.end());
+	std::printf("  %-24s mean %8.3f  p50 %8.3f  p90 %8.3f  p95 %8.3f  p99 %8.3f  max %8.3f  (%zu)\n",
+		name, Mean(values), Percentile(values, 0.5), Percentile(values, 0.9),
+		Percentile(values, 0.95), Percentile(values, 0.99), values.back(), values.size());
+}
+
+static void PrintCounts(const char* title, const std::map<std::string, size_t>& counts) {
+	std::printf("%s:\n", title);
+	for (const auto& [name, count] : counts) {
+		std::printf("  %-24s %zu\n", name.empty() ? "-" : name.c_str(), count);
+	}
+}
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
+	if (argc != 2) {
+		std::cout << "用法: FrameTraceAnalyzer <frame_trace.csv>" << std::endl;
+		return 1;
+	}
+
+	std::ifstream ifs(argv[1]);
+	if (!ifs) {
+		std::cout << "打开 " << argv[1] << " 失败" << std::endl;
+		return 1;
+	}
+
+	std::string line;
+	if (!std::getline(ifs, line)) {
+		std::cout << "非法的文件格式" << std::endl;
+		return 1;
+	}
+
+	// 前 9 列是固定的，之后每列是一个效果的 GPU 用时
+	static constexpr size_t FIXED_COLUMNS = 9;
+	const std::vector<std::string> header = SplitCsvLine(line);
+	if (header.size() < FIXED_COLUMNS || header[0] != "frame" || header[8] != "present") {
+		std::cout << "非法的文件格式" << std::endl;
+		return 1;
+	}
+	const std::vector<std::string> effectNames(header.begin() + FIXED_COLUMNS, header.end());
+
+	std::vector<FrameRecord> records;
+	while (std::getline(ifs, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		const std::vector<std::string> fields = SplitCsvLine(line);
+		if (fields.size() != header.size()) {
+			// 最后一行可能不完整
+			continue;
+		}
+
+		FrameRecord& record = records.emplace_back();
+		record.frame = std::stoull(fields[0]);
+		record.stepTimer = fields[1];
+		record.source = fields[2];
+		record.duplicate = fields[3];
+		record.frameBegin = ParseTime(fields[4]);
+		record.capture = ParseTime(fields[5]);
+		record.renderStart = ParseTime(fields[6]);
+		record.renderEnd = ParseTime(fields[7]);
+		record.present = ParseTime(fields[8]);
+		for (size_t i = FIXED_COLUMNS; i < fields.size(); ++i) {
+			record.effectTimings.push_back(ParseTime(fields[i]));
+		}
+	}
+
+	if (records.empty()) {
+		std::cout << "没有记录" << std::endl;
+		return 1;
+	}
+
+	size_t renderedCount = 0;
+	size_t presentedCount = 0;
+	std::map<std::string, size_t> stepTimerCounts;
+	std::map<std::string, size_t> sourceCounts;
+	std::map<std::string, size_t> duplicateCounts;
+	std::vector<double> presentTimes;
+	std::vector<double> renderTimes;
+	std::vector<double> captureToPresent;
+	std::vector<std::vector<double>> effectTimings(effectNames.size());
+
+	for (const FrameRecord& record : records) {
+		++stepTimerCounts[record.stepTimer];
+		++sourceCounts[record.source];
+		++duplicateCounts[record.duplicate];
+
+		if (!record.renderEnd) {
+			continue;
+		}
+		++renderedCount;
+
+		if (record.renderStart) {
+			renderTimes.push_back(*record.renderEnd - *record.renderStart);
+		}
+
+		for (size_t i = 0; i < record.effectTimings.size(); ++i) {
+			if (record.effectTimings[i]) {
+				effectTimings[i].push_back(*record.effectTimings[i]);
+			}
+		}
+
+		if (record.present) {
+			++presentedCount;
+			presentTimes.push_back(*record.present);
+			if (record.capture) {
+				captureToPresent.push_back(*record.present - *record.capture);
+			}
+		}
+	}
+
+	std::sort(presentTimes.begin(), presentTimes.end());
+	std::vector<double> frameTimes;
+	for (size_t i = 1; i < presentTimes.size(); ++i) {
+		frameTimes.push_back(presentTimes[i] - presentTimes[i - 1]);
+	}
+
+	std::printf("记录: %zu, 渲染: %zu, 呈现: %zu, 丢弃: %zu\n",
+		records.size(), renderedCount, presentedCount, renderedCount - presentedCount);
+
+	if (presentTimes.size() > 1) {
+		const double duration = presentTimes.back() - presentTimes.front();
+		std::printf("时长: %.3f s, 平均帧率: %.2f FPS\n", duration / 1000, frameTimes.size() * 1000 / duration);
+	}
+
+	std::printf("\n时间分布 (ms):\n");
+	PrintDistribution("帧间隔", frameTimes);
+	PrintDistribution("渲染 (CPU 等待 GPU)", renderTimes);
+	PrintDistribution("捕获到呈现", captureToPresent);
+
+	if (!frameTimes.empty()) {
+		std::vector<double> sorted = frameTimes;
+		std::sort(sorted.begin(), sorted.end());
+		const double threshold = Percentile(sorted, 0.5) * STUTTER_FACTOR;
+
+		size_t stutterCount = 0;
+		double worst = 0.0;
+		for (double t : frameTimes) {
+			if (t > threshold) {
+				++stutterCount;
+				worst = std::max(worst, t);
+			}
+		}
+
+		std::printf("\n卡顿 (帧间隔 > %.3f ms): %zu 次 (%.2f%%)",
+			threshold, stutterCount, stutterCount * 100.0 / frameTimes.size());
+		if (stutterCount > 0) {
+			std::printf(", 最长 %.3f ms", worst);
+		}
+		std::printf("\n");
+	}
+
+	if (!effectNames.empty()) {
+		std::printf("\n效果 GPU 用时 (ms):\n");
+		for (size_t i = 0; i < effectNames.size(); ++i) {
+			PrintDistribution(effectNames[i].c_str(), effectTimings[i]);
+		}
+	}
+
+	std::printf("\n");
+	PrintCounts("StepTimer 状态", stepTimerCounts);
+	PrintCounts("捕获状态", sourceCounts);
+	PrintCounts("重复帧检测", duplicateCounts);
+
+	return 0;
+}